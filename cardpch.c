@@ -293,7 +293,8 @@ BYTE            c;                      /* Output character          */
         {
             c = iobuf[i];
 
-            if (dev->ascii)
+            /* (UTF-8 is converted a whole card at a time) */
+            if (dev->ascii && !codepage_utf8())
             {
                 c = guest_to_host(c);
             }
@@ -306,7 +307,33 @@ BYTE            c;                      /* Output character          */
         /* Perform end of record processing if not data-chaining */
         if ((flags & CCW_FLAGS_CD) == 0)
         {
-            if (dev->ascii)
+            if (dev->ascii && codepage_utf8())
+            {
+                BYTE     card[ CARD_LENGTH * 3 + 3 ];
+                CPSTATE  cps = {0};
+                BYTE     blank = host_to_guest( SPACE );
+
+                /* Truncate trailing blanks from card buffer */
+                for (i = dev->cardpos; i > 0; i--)
+                    if (dev->buf[i-1] != blank) break;
+
+                /* Convert card image, leaving room for CRLF */
+                i = (U32) cp_guest_to_host( &cps, dev->buf, i,
+                                            card, sizeof(card) - 2, 0 );
+
+                /* Append carriage return and line feed */
+                if (dev->crlf) card[i++] = '\r';
+                card[i++] = '\n';
+
+                /* Write card image */
+                write_buffer (dev, card, i, unitstat);
+                if (*unitstat != 0) break;
+
+                /* Return normal status */
+                *unitstat = CSW_CE | CSW_DE;
+                break;
+            }
+            else if (dev->ascii)
             {
                 /* Truncate trailing blanks from card buffer */
                 for (i = dev->cardpos; i > 0; i--)
@@ -237,6 +237,10 @@ char         buf[32];                   /* Work buffer                      */
     }
     cckd->cckd_maxsize = CCKD_MAXSIZE;
 
+    /* The base file is never updated if a new shadow file is forced */
+    if (dev->ckdsfnew && dev->dasdsfn && cckd->open[0] == CCKD_OPEN_RW)
+        cckd_open (dev, 0, O_RDONLY|O_BINARY, 0);
+
     /* call the chkdsk function */
     if (cckd_chkdsk (dev, 0) < 0)
         return -1;
@@ -3854,7 +3858,7 @@ char *cckd_sf_name (DEVBLK *dev, int sfx)
 /*-------------------------------------------------------------------*/
 /* Parse the shadow file name option                                 */
 /*-------------------------------------------------------------------*/
-void cckd_sf_parse_sfn( DEVBLK* dev, char* sfn )
+DLL_EXPORT void cckd_sf_parse_sfn( DEVBLK* dev, char* sfn )
 {
     char pathname[MAX_PATH];
     if ('\"' == sfn[0]) sfn++;
@@ -3940,7 +3944,8 @@ char            pathname[MAX_PATH];     /* file path in host format  */
             break;
 
         /* Try to open the shadow file read-write then read-only */
-        if (    cckd_open( dev, cckd->sfn, O_RDWR   | O_BINARY, 1 ) < 0)
+        if (dev->ckdsfnew
+         || cckd_open( dev, cckd->sfn, O_RDWR   | O_BINARY, 1 ) < 0)
             if (cckd_open( dev, cckd->sfn, O_RDONLY | O_BINARY, 0 ) < 0)
                 break;
 
@@ -3965,8 +3970,9 @@ char            pathname[MAX_PATH];     /* file path in host format  */
     /* Backup to the last opened file number */
     cckd->sfn--;
 
-    /* If the last file was opened read-only then create a new one */
-    if (cckd->open[cckd->sfn] == CCKD_OPEN_RO)
+    /* If the last file was opened read-only (or the existing files
+       must not be updated) then create a new one */
+    if (cckd->open[cckd->sfn] == CCKD_OPEN_RO || dev->ckdsfnew)
     {
         /* but ONLY IF not explicit batch utility READ-ONLY open */
         if (!(1
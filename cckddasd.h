@@ -129,7 +129,6 @@ int     cckd_null_trk(DEVBLK *dev, BYTE *buf, int trk, int nullfmt);
 int     cckd_check_null_trk (DEVBLK *dev, BYTE *buf, int trk, int len);
 int     cckd_cchh(DEVBLK *dev, BYTE *buf, int trk);
 int     cckd_validate(DEVBLK *dev, BYTE *buf, int trk, int len);
-void    cckd_sf_parse_sfn( DEVBLK* dev, char* sfn );
 char   *cckd_sf_name(DEVBLK *dev, int sfx);
 int     cckd_sf_init(DEVBLK *dev);
 int     cckd_sf_new(DEVBLK *dev);
@@ -226,6 +225,7 @@ CCKD_DLL_IMPORT   bool    cckd_dtax(); // Dump Table At Exit
 //                void    cckd64_trace(DEVBLK *dev, char *msg, ...);
 //KD64_DLL_IMPORT void    cckd64_print_itrace();
 /*-------------------------------------------------------------------*/
+CCKD_DLL_IMPORT   void    cckd_sf_parse_sfn( DEVBLK* dev, char* sfn );
 CCKD_DLL_IMPORT   void   *cckd_sf_add(void *data);
 CCKD_DLL_IMPORT   void   *cckd_sf_remove(void *data);
 CCKD_DLL_IMPORT   void   *cckd_sf_comp(void *data);
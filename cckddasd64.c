@@ -76,6 +76,10 @@ char         buf[32];                   /* Work buffer                      */
     }
     cckd->cckd_maxsize = CCKD64_MAXSIZE;
 
+    /* The base file is never updated if a new shadow file is forced */
+    if (dev->ckdsfnew && dev->dasdsfn && cckd->open[0] == CCKD_OPEN_RW)
+        cckd64_open (dev, 0, O_RDONLY|O_BINARY, 0);
+
     /* call the chkdsk function */
     if (cckd64_chkdsk (dev, 0) < 0)
         return -1;
@@ -3182,7 +3186,8 @@ char            pathname[MAX_PATH];     /* file path in host format  */
             break;
 
         /* Try to open the shadow file read-write then read-only */
-        if (    cckd64_open( dev, cckd->sfn, O_RDWR   | O_BINARY, 1 ) < 0)
+        if (dev->ckdsfnew
+         || cckd64_open( dev, cckd->sfn, O_RDWR   | O_BINARY, 1 ) < 0)
             if (cckd64_open( dev, cckd->sfn, O_RDONLY | O_BINARY, 0 ) < 0)
                 break;
 
@@ -3207,8 +3212,9 @@ char            pathname[MAX_PATH];     /* file path in host format  */
     /* Backup to the last opened file number */
     cckd->sfn--;
 
-    /* If the last file was opened read-only then create a new one */
-    if (cckd->open[cckd->sfn] == CCKD_OPEN_RO)
+    /* If the last file was opened read-only (or the existing files
+       must not be updated) then create a new one */
+    if (cckd->open[cckd->sfn] == CCKD_OPEN_RO || dev->ckdsfnew)
     {
         /* but ONLY IF not explicit batch utility READ-ONLY open */
         if (!(1
@@ -1556,13 +1556,20 @@ test_subchan_locked (REGS* regs, DEVBLK* dev,
 
             /* Copy the extended control word to the IRB */
             memcpy (irb->ecw, dev->ecw, sizeof(irb->ecw));
+
+            /* Copy the extended measurement word to the IRB */
+            if (dev->pmcw.flag27 & PMCW27_X)
+                irb->emw = dev->emw;
+            else
+                memset (&irb->emw, 0, sizeof(EMW));
             break;
 
         default:
-            /* Clear the ESW and ECW in the IRB */
+            /* Clear the ESW, ECW and EMW in the IRB */
             memset (&irb->esw, 0, sizeof(ESW));
             irb->esw.lpum = 0x80;
             memset (irb->ecw, 0, sizeof(irb->ecw));
+            memset (&irb->emw, 0, sizeof(EMW));
             break;
     }
 
@@ -2607,6 +2614,9 @@ ScheduleIORequest ( DEVBLK *dev )
             else
                 sysblk.ioq = dev;
 
+            /* Note for measurement if other requests are ahead */
+            dev->mbqueued = (previoq != NULL);
+
             /* Update device thread unavailable count. It will be
              * decremented once a thread grabs this request.
              */
@@ -2752,6 +2762,7 @@ int cc;                                 /* Return code               */
 
         /* Set the resume pending flag and signal the subchannel */
         dev->scsw.flag2 |= SCSW2_AC_RESUM;
+        dev->mbstart = host_tod();
         cc = schedule_ioq(NULL, dev);
     }
 
@@ -2782,6 +2793,411 @@ void shared_iowait (DEVBLK *dev)
     }
 }
 #endif // defined( OPTION_SHARED_DEVICES )
+
+/*-------------------------------------------------------------------*/
+/*                DEVICE SERVICE TIME MODEL                          */
+/*-------------------------------------------------------------------*/
+/* When the svctime command has set a model for a device, each of    */
+/* its channel programs is held until the modelled service time has  */
+/* elapsed: a fixed overhead, then either the cache hit access time  */
+/* or (on a miss) seek and rotational latency, plus data transfer at */
+/* the device rate. Devices with the same control unit number queue  */
+/* for its paths, and devices whose first CHPID has a bandwidth set  */
+/* share that channel's data rate.                                   */
+/*-------------------------------------------------------------------*/
+static LOCK  svc_lock;                  /* Protects the tables below */
+static COND  svc_cond;                  /* Used only for timed waits */
+static bool  svc_inited = false;
+static TOD   svc_cufree[256][SVC_MAXPATHS]; /* CU path busy until    */
+static TOD   svc_chpfree[256];          /* CHPID busy until          */
+static U32   svc_chpbw[256];            /* CHPID bandwidth (KB/sec)  */
+
+static void svc_init()
+{
+    if (!svc_inited)
+    {
+        initialize_lock( &svc_lock );
+        initialize_condition( &svc_cond );
+        svc_inited = true;
+    }
+}
+
+/* Per-device pseudo random number in the range 0 to range-1 */
+static U32 svc_random( DEVBLK* dev, U32 range )
+{
+    U32 x = dev->svcseed ? dev->svcseed : (0x9E3779B9 ^ dev->devnum);
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    dev->svcseed = x;
+
+    return range ? x % range : 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Set or remove (model == NULL) the service time model of a device  */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT void svc_set_model( DEVBLK* dev, const SVCMODEL* model )
+{
+    svc_init();
+
+    obtain_lock( &dev->lock );
+    if (model)
+    {
+        dev->svc = *model;
+        dev->svc.paths = MAX( 1, MIN( SVC_MAXPATHS, dev->svc.paths ));
+        dev->svccyl    = dev->ckdcurcyl;
+        dev->svccount  = dev->svcmodel = dev->svcactual = dev->svccuq = 0;
+        dev->svcon     = 1;
+    }
+    else
+        dev->svcon     = 0;
+    release_lock( &dev->lock );
+}
+
+/*-------------------------------------------------------------------*/
+/* Set or query the bandwidth of a channel path (0 = unlimited)      */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT void svc_set_chpid( BYTE chpid, U32 kbps )
+{
+    svc_init();
+
+    obtain_lock( &svc_lock );
+    svc_chpbw[chpid]   = kbps;
+    svc_chpfree[chpid] = 0;
+    release_lock( &svc_lock );
+}
+
+DLL_EXPORT U32 svc_get_chpid( BYTE chpid )
+{
+    return svc_chpbw[chpid];
+}
+
+/*-------------------------------------------------------------------*/
+/* Add the modelled service time of one executed CCW                 */
+/*-------------------------------------------------------------------*/
+void svc_ccw( DEVBLK* dev, U32 bytes )
+{
+    SVCMODEL*  m      = &dev->svc;
+    U64        usecs  = 0;
+    bool       rotate = false;
+
+    /* Cache hit or miss is decided once per channel program */
+    if (!dev->svchit)
+    {
+        dev->svchit = svc_random( dev, 100 ) < m->hitpct ? 1 : 2;
+        usecs += m->overhead;
+
+        if (dev->svchit == 1)
+            usecs += m->hittime;
+        else
+            rotate = true;
+    }
+
+    /* A miss pays for every arm movement on a CKD device */
+    if (dev->svchit == 2 && dev->ckdcyls
+     && dev->ckdcurcyl != (int)dev->svccyl)
+    {
+        U32 dist = abs( dev->ckdcurcyl - (int)dev->svccyl );
+
+        usecs += m->seekmin;
+        if (m->seekmax > m->seekmin)
+            usecs += (U64)((m->seekmax - m->seekmin)
+                   * sqrt( (double)dist / dev->ckdcyls ));
+        rotate = true;
+    }
+    dev->svccyl = dev->ckdcurcyl;
+
+    /* Then for the rotational latency to reach the record */
+    if (rotate && m->rpm)
+        usecs += svc_random( dev, 60000000 / m->rpm );
+
+    /* Data transfer at the device rate */
+    if (m->xfer)
+        usecs += ((U64)bytes * 1000000) / ((U64)m->xfer << 10);
+
+    dev->svcbytes += bytes;
+    dev->svcusecs += usecs;
+}
+
+/*-------------------------------------------------------------------*/
+/* Wait until the modelled end of the current channel program.       */
+/* Returns the time spent queued for a control unit path.            */
+/*-------------------------------------------------------------------*/
+TOD svc_delay( DEVBLK* dev )
+{
+    SVCMODEL*  m     = &dev->svc;
+    BYTE       chpid = dev->pmcw.chpid[0];
+    TOD       *path;
+    TOD        begin, end, now, cuq;
+    int        i;
+
+    if (!dev->svchit)
+        return 0;
+
+    obtain_lock( &svc_lock );
+
+    /* Queue for the earliest free path of the control unit */
+    path = &svc_cufree[ m->cu ][0];
+    for (i=1; i < m->paths; i++)
+        if (svc_cufree[ m->cu ][i] < *path)
+            path = &svc_cufree[ m->cu ][i];
+
+    begin = MAX( dev->mbconnect, *path );
+    cuq   = begin - dev->mbconnect;
+    end   = begin + dev->svcusecs * ETOD_USEC;
+
+    /* The data transfer also occupies the channel path */
+    if (svc_chpbw[ chpid ])
+    {
+        TOD chpend = MAX( begin, svc_chpfree[ chpid ] )
+                   + (dev->svcbytes * 1000000 * ETOD_USEC)
+                   / ((U64)svc_chpbw[ chpid ] << 10);
+        svc_chpfree[ chpid ] = chpend;
+        end = MAX( end, chpend );
+    }
+    *path = end;
+
+    /* Remain busy until the modelled service time has elapsed */
+    while ((now = host_tod()) < end
+        && !sysblk.shutdown
+        && !(dev->scsw.flag2 & (SCSW2_AC_HALT | SCSW2_AC_CLEAR)))
+    {
+        timed_wait_condition_relative_usecs( &svc_cond, &svc_lock,
+            (U32) MAX( 1, MIN( 10000, (end - now) / ETOD_USEC )), NULL );
+    }
+    release_lock( &svc_lock );
+
+    dev->svccount++;
+    dev->svcmodel  += (end - dev->mbconnect) / ETOD_USEC;
+    dev->svcactual += (host_tod() - dev->mbconnect) / ETOD_USEC;
+    dev->svccuq    += cuq / ETOD_USEC;
+
+    dev->svchit   = 0;
+    dev->svcbytes = dev->svcusecs = 0;
+
+    return cuq;
+}
+
+/*-------------------------------------------------------------------*/
+/*                DEVICE FAULT INJECTION                             */
+/*-------------------------------------------------------------------*/
+/* Rules set by the fault command select CCWs about to be passed to  */
+/* a device handler by device, opcode, track or block position and   */
+/* occurrence, and replace their execution with a unit check, busy   */
+/* status, a delay or a dropped ending interrupt. The decision uses  */
+/* only the rule's own counters and seed, so the same guest workload */
+/* gets the same injections, and each one is logged with a sequence  */
+/* number so that a run can be replayed.                             */
+/*-------------------------------------------------------------------*/
+static LOCK     fault_lock;             /* Protects the rule chain   */
+static bool     fault_inited = false;
+static FLTRULE* fault_rules  = NULL;    /* Chain of rules            */
+static int      fault_count  = 0;       /* Number of rules           */
+static int      fault_nextid = 1;       /* Next rule number          */
+static U64      fault_seq    = 0;       /* Injection sequence number */
+
+static const char* fault_names[] =
+{
+    "", "unit check", "busy", "delay", "dropped interrupt"
+};
+
+/*-------------------------------------------------------------------*/
+/* Add a fault rule; returns the rule number                         */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT int fault_add( const FLTRULE* rule )
+{
+    FLTRULE  *new, **pp;
+    int       id;
+
+    if (!fault_inited)
+    {
+        initialize_lock( &fault_lock );
+        fault_inited = true;
+    }
+
+    if (!(new = malloc( sizeof( FLTRULE ))))
+        return -1;
+
+    *new = *rule;
+    new->next     = NULL;
+    new->matches  = 0;
+    new->injected = 0;
+    if (!new->seed)
+        new->seed = 1;
+
+    obtain_lock( &fault_lock );
+    {
+        id = new->id = fault_nextid++;
+        for (pp = &fault_rules; *pp; pp = &(*pp)->next);
+        *pp = new;
+        fault_count++;
+    }
+    release_lock( &fault_lock );
+
+    return id;
+}
+
+/*-------------------------------------------------------------------*/
+/* Delete a fault rule (id 0 = all); returns the number deleted      */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT int fault_del( int id )
+{
+    FLTRULE  *rule, **pp;
+    int       n = 0;
+
+    if (!fault_inited)
+        return 0;
+
+    obtain_lock( &fault_lock );
+    {
+        for (pp = &fault_rules; (rule = *pp); )
+        {
+            if (!id || rule->id == id)
+            {
+                *pp = rule->next;
+                free( rule );
+                fault_count--;
+                n++;
+            }
+            else
+                pp = &rule->next;
+        }
+    }
+    release_lock( &fault_lock );
+
+    return n;
+}
+
+/*-------------------------------------------------------------------*/
+/* Copy the nth (from zero) fault rule; false if there is none       */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT bool fault_query( int n, FLTRULE* copy )
+{
+    FLTRULE  *rule = NULL;
+
+    if (!fault_inited)
+        return false;
+
+    obtain_lock( &fault_lock );
+    {
+        for (rule = fault_rules; rule && n > 0; rule = rule->next, n--);
+        if (rule)
+            *copy = *rule;
+    }
+    release_lock( &fault_lock );
+
+    return rule != NULL;
+}
+
+/* Current track (CKD), block (FBA) or block id (tape) of a device */
+static U32 fault_position( DEVBLK* dev )
+{
+    if (dev->ckdcyls)
+        return (U32) MAX( 0, dev->ckdcurcyl * dev->ckdheads
+                           + dev->ckdcurhead );
+    if (dev->fbablksiz)
+        return (U32)(dev->fbarba / dev->fbablksiz);
+    return dev->blockid;
+}
+
+/*-------------------------------------------------------------------*/
+/* Apply any fault rule matching a CCW about to be executed.         */
+/* Returns true if the fault replaces execution of the CCW, in which */
+/* case the unit status and residual count have been set.            */
+/*-------------------------------------------------------------------*/
+bool fault_inject( DEVBLK* dev, BYTE code, U32 count,
+                   BYTE* unitstat, U32* residual )
+{
+    FLTRULE  *rule;
+    FLTRULE   hit;
+    U32       pos;
+    U64       seq = 0;
+    bool      inject = false;
+
+    if (!fault_inited || !fault_count)
+        return false;
+
+    pos = fault_position( dev );
+
+    obtain_lock( &fault_lock );
+    for (rule = fault_rules; rule && !inject; rule = rule->next)
+    {
+        if (0
+            || rule->devnum != dev->devnum
+            || rule->lcss   != SSID_TO_LCSS( dev->ssid )
+            || (rule->ccw >= 0 && rule->ccw != code)
+            || pos < rule->lo
+            || pos > rule->hi
+        )
+            continue;
+
+        rule->matches++;
+
+        if (rule->nth)
+            inject = (rule->matches == rule->nth);
+        else if (rule->every)
+            inject = (rule->matches % rule->every) == 0;
+        else
+            inject = true;
+
+        /* The random number is only drawn for a candidate match so
+           the sequence depends on nothing but the rule and workload */
+        if (inject && rule->prob)
+        {
+            rule->seed ^= rule->seed << 13;
+            rule->seed ^= rule->seed >> 17;
+            rule->seed ^= rule->seed << 5;
+            inject = (rule->seed % 100) < rule->prob;
+        }
+
+        if (inject && rule->limit && rule->injected >= rule->limit)
+            inject = false;
+
+        if (inject)
+        {
+            rule->injected++;
+            seq = ++fault_seq;
+            hit = *rule;
+        }
+    }
+    release_lock( &fault_lock );
+
+    if (!inject)
+        return false;
+
+    // "%1d:%04X fault %d injected %s: sequence %"PRIu64", ccw %02X, ..."
+    WRMSG( HHC02354, "I", LCSS_DEVNUM, hit.id, fault_names[ hit.action ],
+        seq, code, pos, hit.matches );
+
+    switch (hit.action)
+    {
+    case FLT_UC:
+        obtain_lock( &dev->lock );
+        memset( dev->sense, 0, sizeof( dev->sense ));
+        memcpy( dev->sense, hit.sense, hit.senselen );
+        dev->sns_pending = 1;
+        release_lock( &dev->lock );
+        *unitstat = CSW_CE | CSW_DE | CSW_UC;
+        *residual = count;
+        return true;
+
+    case FLT_BUSY:
+        *unitstat = CSW_BUSY;
+        *residual = count;
+        return true;
+
+    case FLT_DELAY:
+        usleep( hit.delay );
+        break;
+
+    case FLT_NOINTR:
+        dev->fltdrop = 1;
+        break;
+    }
+    return false;
+}
 #endif /*!defined(_CHANNEL_C)*/
 
 
@@ -3952,6 +4368,125 @@ ARCH_DEP( device_attention )( DEVBLK* dev, BYTE unitstat )
 } /* end function device_attention */
 
 
+#if defined(_FEATURE_IO_ASSIST)
+ #define _IOA_MBO sysblk.zpb[dev->pmcw.zone].mbo
+ #define _IOA_MBM sysblk.zpb[dev->pmcw.zone].mbm
+ #define _IOA_MBK sysblk.zpb[dev->pmcw.zone].mbk
+#else /*defined(_FEATURE_IO_ASSIST)*/
+ #define _IOA_MBO sysblk.mbo
+ #define _IOA_MBM sysblk.mbm
+ #define _IOA_MBK sysblk.mbk
+#endif /*defined(_FEATURE_IO_ASSIST)*/
+
+#ifdef FEATURE_CHANNEL_SUBSYSTEM
+/*-------------------------------------------------------------------*/
+/* UPDATE THE MEASUREMENT BLOCK AND EXTENDED MEASUREMENT WORD        */
+/*-------------------------------------------------------------------*/
+/* Input                                                             */
+/*      dev     -> Device control block                              */
+/*      start   1=count a start or resume function                   */
+/* Note                                                              */
+/*      The interval times accumulated in dev->mbtime since the last */
+/*      call are converted to 128 microsecond units and added to the */
+/*      extended measurement word and, if measurement block update   */
+/*      mode is enabled, to the format-0 or format-1 measurement     */
+/*      block. Any remainder is carried forward to the next call.    */
+/*      dev->lock must be held by the caller.                        */
+/*-------------------------------------------------------------------*/
+static void
+ARCH_DEP(update_measurement_block) (DEVBLK *dev, int start)
+{
+U32     units[7];                       /* Interval times (128us)    */
+RADR    mbaddr;                         /* Measure block address     */
+BYTE   *mb;                             /* Measure block             */
+int     mblen;                          /* Measure block length      */
+int     i;
+
+    /* Convert the accumulated interval times */
+    for (i = 0; i < 7; i++)
+    {
+        units[i] = (U32)(dev->mbtime[i] / MB_UNIT);
+        dev->mbtime[i] -= (U64)units[i] * MB_UNIT;
+    }
+
+    /* Accumulate the extended measurement word */
+    STORE_FW( dev->emw.dct,  fetch_fw( dev->emw.dct  ) + units[MB_DCT]  );
+    STORE_FW( dev->emw.fpt,  fetch_fw( dev->emw.fpt  ) + units[MB_FPT]  );
+    STORE_FW( dev->emw.ddt,  fetch_fw( dev->emw.ddt  ) + units[MB_DDT]  );
+    STORE_FW( dev->emw.cuqt, fetch_fw( dev->emw.cuqt ) + units[MB_CUQT] );
+    STORE_FW( dev->emw.daot, fetch_fw( dev->emw.daot ) + units[MB_DAOT] );
+    STORE_FW( dev->emw.dbt,  fetch_fw( dev->emw.dbt  ) + units[MB_DBT]  );
+    STORE_FW( dev->emw.icrt, fetch_fw( dev->emw.icrt ) + units[MB_ICRT] );
+
+    /* Exit if measurement block update is not enabled */
+    if (!_IOA_MBM || !(dev->pmcw.flag5 & PMCW5_MM_MBU)
+     || (dev->scsw.flag2 & (SCSW2_AC_CLEAR | SCSW2_AC_HALT)))
+        return;
+
+#if defined(FEATURE_001_ZARCH_INSTALLED_FACILITY)
+    /* Format-1 block is addressed by the subchannel itself */
+    if (dev->pmcw.flag27 & PMCW27_F)
+    {
+        mbaddr = dev->mba;
+        mblen  = sizeof(MBK1);
+    }
+    else
+#endif /*defined(FEATURE_001_ZARCH_INSTALLED_FACILITY)*/
+    {
+        mbaddr = _IOA_MBO;
+        mbaddr += (dev->pmcw.mbi[0] << 8 | dev->pmcw.mbi[1]) << 5;
+        mblen  = sizeof(MBK);
+    }
+
+    if ( CHADDRCHK(mbaddr + mblen - 1, dev)
+        || (((ARCH_DEP( get_dev_storage_key )( dev, mbaddr ) & STORKEY_KEY) != _IOA_MBK)
+            && (_IOA_MBK != 0)))
+    {
+        /* Generate subchannel logout indicating program
+           check or protection check, and set the subchannel
+           measurement-block-update-enable to zero */
+        dev->pmcw.flag5 &= ~PMCW5_MM_MBU;
+        dev->esw.scl0 |= CHADDRCHK(mbaddr + mblen - 1, dev) ?
+                             SCL0_ESF_MBPGK : SCL0_ESF_MBPTK;
+        return;
+    }
+
+    ARCH_DEP( or_dev_storage_key )( dev, mbaddr, (STORKEY_REF | STORKEY_CHANGE) );
+    mb = &dev->mainstor[mbaddr];
+
+    if (mblen == sizeof(MBK1))
+    {
+        MBK1 *mbk1 = (MBK1*)mb;
+
+        STORE_FW( mbk1->srcount,   fetch_fw( mbk1->srcount   ) + (start ? 1 : 0));
+        STORE_FW( mbk1->samplecnt, fetch_fw( mbk1->samplecnt ) + (start ? 0 : 1));
+        STORE_FW( mbk1->dct,       fetch_fw( mbk1->dct       ) + units[MB_DCT]  );
+        STORE_FW( mbk1->fpt,       fetch_fw( mbk1->fpt       ) + units[MB_FPT]  );
+        STORE_FW( mbk1->ddt,       fetch_fw( mbk1->ddt       ) + units[MB_DDT]  );
+        STORE_FW( mbk1->cuqt,      fetch_fw( mbk1->cuqt      ) + units[MB_CUQT] );
+        STORE_FW( mbk1->daot,      fetch_fw( mbk1->daot      ) + units[MB_DAOT] );
+        STORE_FW( mbk1->dbt,       fetch_fw( mbk1->dbt       ) + units[MB_DBT]  );
+        STORE_FW( mbk1->icrt,      fetch_fw( mbk1->icrt      ) + units[MB_ICRT] );
+    }
+    else
+    {
+        MBK *mbk = (MBK*)mb;
+
+        STORE_HW( mbk->srcount,   fetch_hw( mbk->srcount   ) + (start ? 1 : 0));
+        STORE_HW( mbk->samplecnt, fetch_hw( mbk->samplecnt ) + (start ? 0 : 1));
+        STORE_FW( mbk->dct,       fetch_fw( mbk->dct       ) + units[MB_DCT]  );
+        STORE_FW( mbk->fpt,       fetch_fw( mbk->fpt       ) + units[MB_FPT]  );
+        STORE_FW( mbk->ddt,       fetch_fw( mbk->ddt       ) + units[MB_DDT]  );
+        STORE_FW( mbk->cuqt,      fetch_fw( mbk->cuqt      ) + units[MB_CUQT] );
+        STORE_FW( mbk->daot,      fetch_fw( mbk->daot      ) + units[MB_DAOT] );
+        STORE_FW( mbk->dbt,       fetch_fw( mbk->dbt       ) + units[MB_DBT]  );
+        STORE_FW( mbk->icrt,      fetch_fw( mbk->icrt      ) + units[MB_ICRT] );
+    }
+
+} /* end function update_measurement_block */
+#endif /*FEATURE_CHANNEL_SUBSYSTEM*/
+
+
 /*-------------------------------------------------------------------*/
 /* START A CHANNEL PROGRAM                                           */
 /* This function is called by the SIO and SSCH instructions          */
@@ -4051,6 +4586,16 @@ int     rc;                             /* Return code               */
     dev->scsw.flag2 |= SCSW2_FC_START | SCSW2_AC_START;
     dev->startpending = 1;
 
+    /* Start measuring the function pending time */
+    dev->mbstart = host_tod();
+    dev->mbqueued = 0;
+    memset (dev->mbtime, 0, sizeof(dev->mbtime));
+    memset (&dev->emw,   0, sizeof(EMW));
+
+    /* Start modelling a new channel program */
+    dev->svchit   = 0;
+    dev->svcbytes = dev->svcusecs = 0;
+
     /* Copy the I/O parameter to the path management control word */
     memcpy (dev->pmcw.intparm, orb->intparm,
                         sizeof(dev->pmcw.intparm));
@@ -4156,11 +4701,7 @@ BYTE    ccwkey = 0;                     /* Bits 0-3=key, 4-7=zero    */
 BYTE    opcode;                         /* CCW operation code        */
 BYTE    flags;                          /* CCW flags                 */
 U32     addr;                           /* CCW data address          */
-#ifdef FEATURE_CHANNEL_SUBSYSTEM
-U32     mbaddr;                         /* Measure block address     */
-MBK    *mbk;                            /* Measure block             */
-U16     mbcount;                        /* Measure block count       */
-#endif /*FEATURE_CHANNEL_SUBSYSTEM*/
+TOD     mbentry;                        /* Channel program entry time*/
 U32     count;                          /* CCW byte count            */
 BYTE   *ccw;                            /* CCW pointer               */
 BYTE    unitstat;                       /* Unit status               */
@@ -4195,11 +4736,16 @@ IOBUF iobuf_initial;                    /* Channel I/O buffer        */
 
     obtain_lock (&dev->lock);
 
+    mbentry = host_tod();
+
 #if defined( OPTION_SHARED_DEVICES )
     /* Wait for the device to become available */
     if (dev->shareable)
     {
         shared_iowait( dev );
+
+        /* Waiting for another system is device busy time */
+        dev->mbtime[MB_DBT] += host_tod() - mbentry;
     }
     dev->shioactive = DEV_SYS_LOCAL;
 #endif // defined( OPTION_SHARED_DEVICES )
@@ -4329,42 +4875,21 @@ resume_suspend:
     dev->chained = dev->prev_chained =
     dev->code    = dev->prevcode     = dev->ccwseq = 0;
 
-#if defined(_FEATURE_IO_ASSIST)
- #define _IOA_MBO sysblk.zpb[dev->pmcw.zone].mbo
- #define _IOA_MBM sysblk.zpb[dev->pmcw.zone].mbm
- #define _IOA_MBK sysblk.zpb[dev->pmcw.zone].mbk
-#else /*defined(_FEATURE_IO_ASSIST)*/
- #define _IOA_MBO sysblk.mbo
- #define _IOA_MBM sysblk.mbm
- #define _IOA_MBK sysblk.mbk
-#endif /*defined(_FEATURE_IO_ASSIST)*/
+    /* Function pending ends as the device becomes connected */
+    dev->mbconnect = host_tod();
+    dev->mbtime[MB_FPT] += dev->mbconnect - dev->mbstart;
 
-#ifdef FEATURE_CHANNEL_SUBSYSTEM
-    /* Update the measurement block if applicable */
-    if (_IOA_MBM && (dev->pmcw.flag5 & PMCW5_MM_MBU) &&
-        !(dev->scsw.flag2 & (SCSW2_AC_CLEAR | SCSW2_AC_HALT)))
+    /* Time spent queued behind other requests for a device thread
+       is reported as control unit queuing time */
+    if (dev->mbqueued)
     {
-        mbaddr = _IOA_MBO;
-        mbaddr += (dev->pmcw.mbi[0] << 8 | dev->pmcw.mbi[1]) << 5;
-        if ( !CHADDRCHK(mbaddr, dev)
-            && (((ARCH_DEP( get_dev_storage_key )( dev, mbaddr ) & STORKEY_KEY) == _IOA_MBK)
-                || (_IOA_MBK == 0)))
-        {
-            ARCH_DEP( or_dev_storage_key )( dev, mbaddr, (STORKEY_REF | STORKEY_CHANGE) );
-            mbk = (MBK*)&dev->mainstor[mbaddr];
-            FETCH_HW(mbcount,mbk->srcount);
-            mbcount++;
-            STORE_HW(mbk->srcount,mbcount);
-        } else {
-            /* Generate subchannel logout indicating program
-               check or protection check, and set the subchannel
-               measurement-block-update-enable to zero */
-            dev->pmcw.flag5 &= ~PMCW5_MM_MBU;
-            dev->esw.scl0 |= !CHADDRCHK(mbaddr, dev) ?
-                                 SCL0_ESF_MBPTK : SCL0_ESF_MBPGK;
-            /*INCOMPLETE*/
-        }
+        dev->mbtime[MB_CUQT] += mbentry - dev->mbstart;
+        dev->mbqueued = 0;
     }
+
+#ifdef FEATURE_CHANNEL_SUBSYSTEM
+    /* Update the measurement block if applicable */
+    ARCH_DEP(update_measurement_block) (dev, 1);
 #endif /*FEATURE_CHANNEL_SUBSYSTEM*/
 
     release_lock (&dev->lock);
@@ -4771,6 +5296,12 @@ execute_halt:
 
                 STORE_HW(dev->scsw.count,count);
 
+#ifdef FEATURE_CHANNEL_SUBSYSTEM
+                /* Device disconnects while the subchannel is suspended */
+                dev->mbtime[MB_DCT] += host_tod() - dev->mbconnect;
+                ARCH_DEP(update_measurement_block) (dev, 0);
+#endif /*FEATURE_CHANNEL_SUBSYSTEM*/
+
                 /* Update local copy of ORB */
                 STORE_FW(dev->orb.ccwaddr, (ccwaddr-8));
 
@@ -4928,6 +5459,9 @@ execute_halt:
             /* subchannel                                            */
             firstccw = 0;
 
+            /* The first command is now being sent to the device     */
+            dev->mbtime[MB_ICRT] += host_tod() - dev->mbconnect;
+
             /* Subchannel and device are now active, set bits in     */
             /* SCSW                                                  */
             /* SA22-7201-05:                                         */
@@ -5112,15 +5646,24 @@ prefetch:
             residual = count;
             more = bufpos = unitstat = chanstat = 0;
 
-            /* Pass the CCW to the device handler for execution */
-            dev->iobuf.length = iobuf->size;
-            dev->iobuf.data = iobuf->data;
-            (dev->hnd->exec) (dev, dev->code, flags, dev->chained,
-                              count, dev->prevcode, dev->ccwseq,
-                              iobuf->data,
-                              &more, &unitstat, &residual);
-            dev->iobuf.length = 0;
-            dev->iobuf.data   = 0;
+            /* Pass the CCW to the device handler for execution
+               unless an injected fault takes its place */
+            if (!fault_inject (dev, dev->code, count,
+                               &unitstat, &residual))
+            {
+                dev->iobuf.length = iobuf->size;
+                dev->iobuf.data = iobuf->data;
+                (dev->hnd->exec) (dev, dev->code, flags, dev->chained,
+                                  count, dev->prevcode, dev->ccwseq,
+                                  iobuf->data,
+                                  &more, &unitstat, &residual);
+                dev->iobuf.length = 0;
+                dev->iobuf.data   = 0;
+            }
+
+            /* Account for the modelled service time */
+            if (dev->svcon)
+                svc_ccw (dev, count - residual);
 
             /* Check for Command Retry (suggested by Jim Pierson) */
             if ( --cmdretry && unitstat == ( CSW_CE | CSW_DE | CSW_UC | CSW_SM ) )
@@ -5501,8 +6044,22 @@ breakchain:
 
     } /* end while(chain) */
 
+    /* Data transfer is complete; any I/O delay or modelled service
+       time is disconnected time, except for control unit queuing */
+    mbentry = host_tod();
+    dev->mbtime[MB_DCT] += mbentry - dev->mbconnect;
+
     IODELAY(dev);
 
+    if (dev->svcon)
+    {
+        TOD cuq = MIN( svc_delay (dev), host_tod() - mbentry );
+        dev->mbtime[MB_CUQT] += cuq;
+        mbentry += cuq;
+    }
+
+    dev->mbtime[MB_DDT] += host_tod() - mbentry;
+
     /* Call the i/o end exit */
     if (dev->hnd->end) (dev->hnd->end) (dev);
 
@@ -5517,6 +6074,20 @@ breakchain:
     OBTAIN_INTLOCK(NULL);
     obtain_lock(&dev->lock);
 
+    /* An injected fault may drop the ending interrupt, leaving the
+       subchannel and device active until the program halts or clears
+       the subchannel (as a missing interrupt handler would) */
+    if (dev->fltdrop)
+    {
+        dev->fltdrop = 0;
+        if (!(dev->scsw.flag2 & (SCSW2_AC_HALT | SCSW2_AC_CLEAR)))
+        {
+            release_lock( &dev->lock );
+            RELEASE_INTLOCK( NULL );
+            return execute_ccw_chain_fast_return( iobuf, &iobuf_initial, NULL );
+        }
+    }
+
     /* Complete the subchannel status word */
     dev->scsw.flag3 &= ~(SCSW3_AC_SCHAC | SCSW3_AC_DEVAC | SCSW3_SC_INTER);
     dev->scsw.flag3 |= (SCSW3_SC_PRI | SCSW3_SC_SEC | SCSW3_SC_PEND);
@@ -5564,6 +6135,11 @@ breakchain:
     /* Clear the extended control word */
     memset (dev->ecw, 0, sizeof(dev->ecw));
 
+#ifdef FEATURE_CHANNEL_SUBSYSTEM
+    /* Update the measurement block and extended measurement word */
+    ARCH_DEP(update_measurement_block) (dev, 0);
+#endif /*FEATURE_CHANNEL_SUBSYSTEM*/
+
     /* Return sense information if PMCW allows concurrent sense */
     if ((unitstat & CSW_UC) && (dev->pmcw.flag27 & PMCW27_S))
     {
@@ -306,6 +306,9 @@ U16 req_len, rsp_len;
 
     CHSC_SB(chsc_rsp10->general_char,7);         /* Concurrent Sense */
     CHSC_SB(chsc_rsp10->general_char,12);              /* Dynamic IO */
+#if defined(FEATURE_001_ZARCH_INSTALLED_FACILITY)
+    CHSC_SB(chsc_rsp10->general_char,48);        /* Ext Measure Blk */
+#endif
 
     if (sysblk.lparmode)
     {
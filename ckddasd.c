@@ -313,6 +313,11 @@ BYTE            serial[12+1] = {0};     /* Dasd serial number        */
             cckd_sf_parse_sfn( dev, argv[i]+3 );
             continue;
         }
+        if (strcasecmp ("sfnew", argv[i]) == 0)
+        {
+            dev->ckdsfnew = 1;
+            continue;
+        }
         if (strlen (argv[i]) > 3
          && memcmp("cu=", argv[i], 3) == 0)
         {
@@ -225,6 +225,24 @@
 
 #define cfall_cmd_desc          "Configure all CPU's online or offline"
 #define clocks_cmd_desc         "Display tod clkc and cpu timer"
+#define clone_cmd_desc          "Snapshot the guest or resume it as a clone"
+#define clone_cmd_help          \
+                                \
+  "Format: \"clone  dir\"  or  \"clone  RESUME  dir  n\"\n"                       \
+  "\n"                                                                          \
+  "'clone dir' briefly stops the processors and writes a snapshot of the\n"    \
+  "machine to directory 'dir': main storage to file storage.img and the\n"      \
+  "processor and device state to file state.srf. Every compressed disk\n"     \
+  "first gets a new shadow file so that the files the disk consisted of\n"    \
+  "until then are never written again. The guest then continues.\n"           \
+  "\n"                                                                          \
+  "'clone resume dir n' resumes the snapshot in another instance that has\n"  \
+  "all processors stopped and at least as much main storage. Main storage\n"  \
+  "is mapped copy-on-write from the image, so any number of clones share\n"   \
+  "the pages they have not written (put 'dir' on tmpfs to share them in\n"   \
+  "host memory too). Each compressed disk gets a private shadow file in\n"    \
+  "'dir/clone<n>'. Clone 'n' (1 to 255) adds n to the processor serial\n"     \
+  "number and to the last byte of each MAC address in device arguments.\n"
 #define cmdlvl_cmd_desc         "Display/Set current command group"
 #define cmdlvl_cmd_help         \
                                 \
@@ -240,6 +258,19 @@
   "        c       a single character used to separate commands.\n"             \
   "        OFF     disables command separation.\n"
 
+#define cmma_cmd_desc           "Enable/display collaborative memory management"
+#define cmma_cmd_help           \
+                                \
+  "Format: CMMA  [ON | OFF]\n"                                                  \
+  "\n"                                                                          \
+  "CMMA ON makes the ESSA instruction available to z/Architecture guests\n"    \
+  "that do not run under z/VM, such as Linux. Hercules then tracks the\n"      \
+  "usage state of every frame and returns the frames the guest marks as\n"     \
+  "unused to the host. DIAG X'010' (release pages) always does the same.\n"    \
+  "Without an argument the command displays the setting, the number of\n"     \
+  "unused frames, the storage returned to the host so far and the host's\n"    \
+  "resident set size (RSS) of this Hercules process.\n"
+
 #define cnslport_cmd_desc       "Set console port"
 
 #if defined(_FEATURE_047_CMPSC_ENH_FACILITY)
@@ -256,12 +287,21 @@
 #define codepage_cmd_desc       "Set/display code page conversion table"
 #define codepage_cmd_help       \
                                 \
-  "Format: 'codepage [cp]'\n"                                                   \
+  "Format: 'codepage [cp] [UTF8|SBCS]'\n"                                       \
+  "        'codepage UTF8|SBCS'\n"                                              \
+  "        'codepage load file.ucm [cp]'\n"                                     \
   "        'codepage maint cmd [operands]' - see cp_updt command for\n"         \
   "                                          help\n"                            \
   "If no operand is specified, the current codepage is displayed.\n"            \
   "If 'cp' is specified, then code page is set to the specified page\n"         \
-  "if the page is valid.\n"
+  "if the page is valid.\n"                                                     \
+  "UTF8 selects UTF-8 as the host encoding for consoles, printers,\n"           \
+  "punches and the HTTP server; SBCS selects the host side of the\n"            \
+  "code page (the default).\n"                                                  \
+  "'load' reads an ICU-style UCM mapping table (SBCS or EBCDIC_STATEFUL\n"      \
+  "DBCS, e.g. CCSID 930, 939, 1390 or 1399) and defines it as code page\n"      \
+  "'cp', or by its <code_set_name> if 'cp' is omitted. Loaded code\n"          \
+  "pages always use UTF-8 as the host encoding.\n"
 
 #define conkpalv_cmd_desc       "Display/alter console TCP keepalive settings"
 #define conkpalv_cmd_help       \
@@ -557,6 +597,28 @@
   "only facilities which are enabled. DISABLED shows only disabled failities.\n" \
   "LONG sorts the display by Long Description. SHORT is the default.\n"
 
+#define fault_cmd_desc          "Define, delete or list device fault injections"
+#define fault_cmd_help          \
+                                \
+  "Format:\n\n"                                                                  \
+  "  fault\n"                                                                    \
+  "  fault  DELete  n|ALL\n"                                                     \
+  "  fault  devnum  action  [CCW=xx] [RANGE=lo[-hi]] [NTH=n] [EVERY=n]\n"        \
+  "                 [PROB=pct [SEED=n]] [LIMIT=n]\n\n"                            \
+  "Makes the device fail on demand to exercise guest error recovery. The\n"     \
+  "action is one of:\n\n"                                                        \
+  "  UC[=xxxx...]   unit check, with the given hexadecimal sense bytes\n"       \
+  "  BUSY           device busy status\n"                                      \
+  "  DELAY=us       delay before the CCW is executed\n"                        \
+  "  NOINTR         drop the ending interrupt of the channel program\n\n"      \
+  "UC and BUSY replace execution of the selected CCW. A rule selects CCWs\n"   \
+  "with opcode xx at a track (CKD), block (FBA) or block id (tape) within\n"  \
+  "RANGE. Of those, NTH injects only the nth, EVERY every nth, PROB the\n"    \
+  "given percentage chosen by a generator started from SEED, and LIMIT\n"     \
+  "stops after that many injections. Each injection is logged with a\n"      \
+  "sequence number; the same rules and workload give the same faults.\n"    \
+  "With no operands the rules and their counts are listed.\n"
+
 #define fcb_cmd_desc            "Display a printer's current FCB"
 #define fcb_cmd_help            "Format: \"fcb <devnum>\""
 #define fpc_cmd_desc            "Display or alter floating point control register"
@@ -832,6 +894,21 @@
   "\n"                                                                          \
   " Note: Multipliers 'T', 'P', and 'E' are not available on 32bit machines\n"
 
+#define mainshare_cmd_desc      "Enable/display main storage page sharing"
+#define mainshare_cmd_help      \
+                                \
+  "Format: mainshare  [ ON [nnn] | OFF | SCAN ]\n"                              \
+  "\n"                                                                          \
+  "MAINSHARE ON lets the host merge identical main storage pages (KSM on\n"     \
+  "Linux) and gives all-zero frames back to the host, scanning for them\n"      \
+  "every 'nnn' seconds (default 300, 0 to scan only on request). A frame\n"     \
+  "is only given back when two scans in a row found it zero, and after\n"       \
+  "checking it once more with the CPUs briefly stopped. A system reset\n"       \
+  "clear also gives the cleared storage back to the host. SCAN scans for\n"     \
+  "zero frames now. Without an argument the command displays the setting,\n"   \
+  "the zero frames given back so far, the storage merged by the host and\n"     \
+  "the host's resident set size (RSS) of this Hercules process.\n"
+
 #define manuf_cmd_desc          "Set STSI manufacturer code"
 #define maxcpu_cmd_desc         "Set maxcpu parameter"
 #define maxrates_cmd_desc       "Display highest MIPS/SIOS rate or set interval"
@@ -845,6 +922,47 @@
   "Entering \"maxrates\" by itself displays the current highest\n"              \
   "rates observed during the defined intervals.\n"
 
+#define mck_cmd_desc            "Inject machine checks or define injection frames"
+#define mck_cmd_help            \
+                                \
+  "Format:\n\n"                                                                  \
+  "  mck\n"                                                                      \
+  "  mck  DELete  n|ALL\n"                                                       \
+  "  mck  [CPU=nn|ANY]  cond[,cond...]|MCIC=xxxxxxxxxxxxxxxx  [XDMG=xxxxxxxx]\n" \
+  "       [ADDR=addr | FRAME=addr [LIMIT=n]]  [INValid=reg[,reg...]]\n\n"       \
+  "Raises a machine check on a CPU to exercise guest recovery code. The\n"     \
+  "conditions are SD (system damage), P (instruction processing damage),\n"   \
+  "SR, TD (timing facility damage), ED, DG, W, SP, CK, B and the storage\n"   \
+  "conditions SE, SC, KE, DS, IE and DA. Named conditions get the validity\n" \
+  "bits of the current architecture, less those of the INValid registers\n"  \
+  "(PSW, GR, FP, XF, CR, AR, ST, PR, CT, CC), plus the failing storage\n"    \
+  "address and external damage code validity bits when ADDR and XDMG are\n"  \
+  "given. MCIC gives the complete interruption code instead. One of SD, P,\n" \
+  "SR, TD, ED, DG, W, SP or CK is required.\n\n"                                \
+  "Without FRAME the machine check is made pending at once on CPU nn (the\n"  \
+  "target CPU by default). FRAME marks the main storage frame containing\n"  \
+  "addr unusable instead: the next reference to it through address\n"       \
+  "translation by the CPU (any CPU by default) raises the machine check\n"   \
+  "with the referenced address as failing storage address, at most LIMIT\n" \
+  "times. An exigent condition (SD or P) on a CPU disabled for machine\n"   \
+  "checks check-stops it. With no operands the rules are listed.\n"
+
+#define migrate_cmd_desc        "Migrate the running guest to another instance"
+#define migrate_cmd_help        \
+                                \
+  "Format: \"migrate  host:port\"  or  \"migrate  INCOMING  [host:]port\"\n"  \
+  "\n"                                                                          \
+  "Live migration of the guest to another Hercules instance. The target\n"     \
+  "instance, which must have all processors stopped and at least as much\n"    \
+  "main storage, is prepared with 'migrate incoming' which waits up to one\n"  \
+  "minute for the connection. The source instance then sends main storage\n"   \
+  "while the guest keeps running, resending the pages that changed until\n"    \
+  "few are left. It then stops its processors, sends the remaining pages\n"    \
+  "and the processor and device state, and detaches its devices so that\n"     \
+  "the target can reattach them using the same image files. The guest\n"       \
+  "resumes on the target and the source is left stopped. If the target\n"      \
+  "rejects the state the source reattaches its devices and continues.\n"
+
 #define message_cmd_desc        "Display message on console a la VM"
 #define message_cmd_help        \
                                 \
@@ -1567,7 +1685,44 @@
   "issuing the stop command to choose which processor you wish to stop.\n"
 
 #define store_cmd_desc          "Store CPU status at absolute zero"
+#define storshm_cmd_desc        "Set/display main storage shared memory object"
+#define storshm_cmd_help        \
+                                \
+  "Format: storshm  [ name | OFF ]\n"                                           \
+  "\n"                                                                          \
+  "Allocates main storage and the storage keys in the shared memory object\n"  \
+  "'name' (the file /dev/shm/name, or the given path if 'name' contains a\n"   \
+  "'/') so that tools such as storview can map it read-only and inspect\n"     \
+  "guest storage while the guest runs. The object starts with a header\n"      \
+  "describing the storage, the prefix of each CPU and the architecture\n"      \
+  "mode (see storshm.h). OFF allocates storage from the heap again. The\n"     \
+  "CPUs must be stopped: storage is reallocated and thus cleared. Without\n"   \
+  "an argument the command displays the path of the object in use.\n"
 #define suspend_cmd_desc        "Suspend hercules"
+#define svctime_cmd_desc        "Display or set device service time models"
+#define svctime_cmd_help        \
+                                \
+  "Format:\n\n"                                                                  \
+  "  svctime  [devnum]\n"                                                        \
+  "  svctime  devnum  OFF\n"                                                     \
+  "  svctime  devnum  [OVERHEAD=us] [SEEK=min[,max]] [RPM=n] [XFER=KB/s]\n"       \
+  "                   [HIT=pct[,us]] [CU=xx[,paths]]\n"                          \
+  "  svctime  CHPID xx [KB/s]\n\n"                                               \
+  "Sets a model of the service time of a device so that each channel\n"         \
+  "program it executes takes about as long as it would on real hardware.\n"     \
+  "Every program is charged the fixed OVERHEAD, then either the cache hit\n"    \
+  "access time (HIT percent of programs) or, on a cache miss, the seek\n"       \
+  "time for each change of cylinder (CKD devices: SEEK min for one\n"           \
+  "cylinder rising to max for a full stroke) and rotational latency at\n"       \
+  "RPM, plus the data transferred at the XFER rate. All times are in\n"         \
+  "microseconds. Devices given the same CU number share its paths and\n"        \
+  "queue for them when all are busy. 'svctime CHPID xx n' limits the\n"         \
+  "total data rate of channel path xx to n KB/s (0 removes the limit).\n\n"     \
+  "With no operands the models and the observed average service times\n"       \
+  "are displayed. Control unit queuing is reported as such in the\n"           \
+  "channel measurement block; the rest of the modelled time is reported\n"     \
+  "as disconnect time.\n"
+
 #define symptom_cmd_desc        "Alias for traceopt"
 #define sysclear_cmd_desc       "System Clear Reset manual operation"
 #define sysclear_cmd_help       \
@@ -1865,6 +2020,9 @@ COMMAND( "b+",                      trace_cmd,              SYSCMDNOPER,
 
 COMMAND( "cachestats",              EXTCMD(cachestats_cmd), SYSCMDNOPER,        cachestats_cmd_desc,    NULL                )
 COMMAND( "clocks",                  clocks_cmd,             SYSCMDNOPER,        clocks_cmd_desc,        NULL                )
+#if !defined( _MSVC_ )
+COMMAND( "clone",                   clone_cmd,              SYSCMDNOPER,        clone_cmd_desc,         clone_cmd_help      )
+#endif
 COMMAND( "codepage",                codepage_cmd,           SYSCMDNOPER,        codepage_cmd_desc,      codepage_cmd_help   )
 COMMAND( "conkpalv",                conkpalv_cmd,           SYSCMDNOPER,        conkpalv_cmd_desc,      conkpalv_cmd_help   )
 COMMAND( "cp_updt",                 cp_updt_cmd,            SYSCMDNOPER,        cp_updt_cmd_desc,       cp_updt_cmd_help    )
@@ -1883,6 +2041,9 @@ COMMAND( "k",                       k_cmd,                  SYSCMDNOPER,
 COMMAND( "loadcore",                loadcore_cmd,           SYSCMDNOPER,        loadcore_cmd_desc,      loadcore_cmd_help   )
 COMMAND( "loadtext",                loadtext_cmd,           SYSCMDNOPER,        loadtext_cmd_desc,      loadtext_cmd_help   )
 COMMAND( "maxcpu",                  maxcpu_cmd,             SYSCMDNOPER,        maxcpu_cmd_desc,        NULL                )
+#if !defined( _MSVC_ )
+COMMAND( "migrate",                 migrate_cmd,            SYSCMDNOPER,        migrate_cmd_desc,       migrate_cmd_help    )
+#endif
 CMDABBR( "mounted_tape_reinit",  9, mounted_tape_reinit_cmd,SYSCMDNOPER,        mtapeinit_cmd_desc,     mtapeinit_cmd_help  )
 COMMAND( "netdev",                  netdev_cmd,             SYSCMDNOPER,        netdev_cmd_desc,        netdev_cmd_help     )
 COMMAND( "numcpu",                  numcpu_cmd,             SYSCMDNOPER,        numcpu_cmd_desc,        NULL                )
@@ -1936,6 +2097,7 @@ COMMAND( "stopall",                 stopall_cmd,            SYSCMDNDIAG8,
 COMMAND( "store",                   store_cmd,              SYSCMDNDIAG8,       store_cmd_desc,         NULL                )
 COMMAND( "sysclear",                sysclear_cmd,           SYSCMDNDIAG8,       sysclear_cmd_desc,      sysclear_cmd_help   )
 COMMAND( "sysreset",                sysreset_cmd,           SYSCMDNDIAG8,       sysreset_cmd_desc,      sysreset_cmd_help   )
+COMMAND( "cmma",                    cmma_cmd,               SYSCFGNDIAG8,       cmma_cmd_desc,          cmma_cmd_help       )
 COMMAND( "cnslport",                cnslport_cmd,           SYSCFGNDIAG8,       cnslport_cmd_desc,      NULL                )
 COMMAND( "cpuidfmt",                cpuidfmt_cmd,           SYSCFGNDIAG8,       cpuidfmt_cmd_desc,      NULL                )
 COMMAND( "cpumodel",                cpumodel_cmd,           SYSCFGNDIAG8,       cpumodel_cmd_desc,      NULL                )
@@ -1945,11 +2107,13 @@ COMMAND( "diag8cmd",                diag8_cmd,              SYSCFGNDIAG8,
 COMMAND( "engines",                 engines_cmd,            SYSCFGNDIAG8,       engines_cmd_desc,       NULL                )
 COMMAND( "lparname",                lparname_cmd,           SYSCFGNDIAG8,       lparname_cmd_desc,      lparname_cmd_help   )
 COMMAND( "lparnum",                 lparnum_cmd,            SYSCFGNDIAG8,       lparnum_cmd_desc,       lparnum_cmd_help    )
+COMMAND( "mainshare",               mainshare_cmd,          SYSCFGNDIAG8,       mainshare_cmd_desc,     mainshare_cmd_help  )
 COMMAND( "mainsize",                mainsize_cmd,           SYSCFGNDIAG8,       mainsize_cmd_desc,      mainsize_cmd_help   )
 CMDABBR( "manufacturer",    8,      stsi_manufacturer_cmd,  SYSCFGNDIAG8,       manuf_cmd_desc,         NULL                )
 COMMAND( "model",                   stsi_model_cmd,         SYSCFGNDIAG8,       model_cmd_desc,         model_cmd_help      )
 COMMAND( "plant",                   stsi_plant_cmd,         SYSCFGNDIAG8,       plant_cmd_desc,         NULL                )
 COMMAND( "shcmdopt",                shcmdopt_cmd,           SYSCFGNDIAG8,       shcmdopt_cmd_desc,      shcmdopt_cmd_help   )
+COMMAND( "storshm",                 storshm_cmd,            SYSCFGNDIAG8,       storshm_cmd_desc,       storshm_cmd_help    )
 COMMAND( "sysepoch",                sysepoch_cmd,           SYSCFGNDIAG8,       sysepoch_cmd_desc,      NULL                )
 COMMAND( "tzoffset",                tzoffset_cmd,           SYSCFGNDIAG8,       tzoffset_cmd_desc,      NULL                )
 COMMAND( "xpndsize",                xpndsize_cmd,           SYSCFGNDIAG8,       xpndsize_cmd_desc,      xpndsize_cmd_help   )
@@ -2066,6 +2230,9 @@ COMMAND( "icount",                  icount_cmd,             SYSCMDNOPER,
 #if defined( OPTION_IODELAY_KLUDGE )
 COMMAND( "iodelay",                 iodelay_cmd,            SYSCMDNOPER,        iodelay_cmd_desc,       iodelay_cmd_help    )
 #endif
+COMMAND( "fault",                   fault_cmd,              SYSCMDNOPER,        fault_cmd_desc,         fault_cmd_help      )
+COMMAND( "mck",                     mck_cmd,                SYSCMDNOPER,        mck_cmd_desc,           mck_cmd_help        )
+COMMAND( "svctime",                 svctime_cmd,            SYSCMDNOPER,        svctime_cmd_desc,       svctime_cmd_help    )
 COMMAND( "pgmprdos",                pgmprdos_cmd,           SYSCFGNDIAG8,       pgmprdos_cmd_desc,      pgmprdos_cmd_help   )
 COMMAND( "maxrates",                maxrates_cmd,           SYSCMD,             maxrates_cmd_desc,      maxrates_cmd_help   )
 #if defined( OPTION_SCSI_TAPE )
@@ -13,6 +13,11 @@
 
 #include "hercules.h"
 
+#if defined( __GNUC__ ) && (defined( __x86_64__ ) || defined( __i386__ ))
+  #include <immintrin.h>
+  #define CP_AVX2_XLATE                 /* AVX2 table lookup support */
+#endif
+
 /* space for user modifiable tables */
 static unsigned char user_h_to_g[256];
 static int user_h_to_g_filled = FALSE;
@@ -1017,11 +1022,69 @@ cp_1140_to_1252[] = {
  };       /* x0  x1  x2  x3  x4  x5  x6  x7  x8  x9  xA  xB  xC  xD  xE  xF */
 
 /*--------------------------------------------------------------------------*/
+/* Host code pages to Unicode, characters 0x80-0xFF                         */
+
+static const U16
+cp_437_to_ucs[128] = {
+ /*          x0     x1     x2     x3     x4     x5     x6     x7     x8     x9     xA     xB     xC     xD     xE     xF  */
+ /* 8x */ 0x00C7,0x00FC,0x00E9,0x00E2,0x00E4,0x00E0,0x00E5,0x00E7,0x00EA,0x00EB,0x00E8,0x00EF,0x00EE,0x00EC,0x00C4,0x00C5,
+ /* 9x */ 0x00C9,0x00E6,0x00C6,0x00F4,0x00F6,0x00F2,0x00FB,0x00F9,0x00FF,0x00D6,0x00DC,0x00A2,0x00A3,0x00A5,0x20A7,0x0192,
+ /* Ax */ 0x00E1,0x00ED,0x00F3,0x00FA,0x00F1,0x00D1,0x00AA,0x00BA,0x00BF,0x2310,0x00AC,0x00BD,0x00BC,0x00A1,0x00AB,0x00BB,
+ /* Bx */ 0x2591,0x2592,0x2593,0x2502,0x2524,0x2561,0x2562,0x2556,0x2555,0x2563,0x2551,0x2557,0x255D,0x255C,0x255B,0x2510,
+ /* Cx */ 0x2514,0x2534,0x252C,0x251C,0x2500,0x253C,0x255E,0x255F,0x255A,0x2554,0x2569,0x2566,0x2560,0x2550,0x256C,0x2567,
+ /* Dx */ 0x2568,0x2564,0x2565,0x2559,0x2558,0x2552,0x2553,0x256B,0x256A,0x2518,0x250C,0x2588,0x2584,0x258C,0x2590,0x2580,
+ /* Ex */ 0x03B1,0x00DF,0x0393,0x03C0,0x03A3,0x03C3,0x00B5,0x03C4,0x03A6,0x0398,0x03A9,0x03B4,0x221E,0x03C6,0x03B5,0x2229,
+ /* Fx */ 0x2261,0x00B1,0x2265,0x2264,0x2320,0x2321,0x00F7,0x2248,0x00B0,0x2219,0x00B7,0x221A,0x207F,0x00B2,0x25A0,0x00A0
+};
+
+static const U16
+cp_850_to_ucs[128] = {
+ /*          x0     x1     x2     x3     x4     x5     x6     x7     x8     x9     xA     xB     xC     xD     xE     xF  */
+ /* 8x */ 0x00C7,0x00FC,0x00E9,0x00E2,0x00E4,0x00E0,0x00E5,0x00E7,0x00EA,0x00EB,0x00E8,0x00EF,0x00EE,0x00EC,0x00C4,0x00C5,
+ /* 9x */ 0x00C9,0x00E6,0x00C6,0x00F4,0x00F6,0x00F2,0x00FB,0x00F9,0x00FF,0x00D6,0x00DC,0x00F8,0x00A3,0x00D8,0x00D7,0x0192,
+ /* Ax */ 0x00E1,0x00ED,0x00F3,0x00FA,0x00F1,0x00D1,0x00AA,0x00BA,0x00BF,0x00AE,0x00AC,0x00BD,0x00BC,0x00A1,0x00AB,0x00BB,
+ /* Bx */ 0x2591,0x2592,0x2593,0x2502,0x2524,0x00C1,0x00C2,0x00C0,0x00A9,0x2563,0x2551,0x2557,0x255D,0x00A2,0x00A5,0x2510,
+ /* Cx */ 0x2514,0x2534,0x252C,0x251C,0x2500,0x253C,0x00E3,0x00C3,0x255A,0x2554,0x2569,0x2566,0x2560,0x2550,0x256C,0x00A4,
+ /* Dx */ 0x00F0,0x00D0,0x00CA,0x00CB,0x00C8,0x0131,0x00CD,0x00CE,0x00CF,0x2518,0x250C,0x2588,0x2584,0x00A6,0x00CC,0x2580,
+ /* Ex */ 0x00D3,0x00DF,0x00D4,0x00D2,0x00F5,0x00D5,0x00B5,0x00FE,0x00DE,0x00DA,0x00DB,0x00D9,0x00FD,0x00DD,0x00AF,0x00B4,
+ /* Fx */ 0x00AD,0x00B1,0x2017,0x00BE,0x00B6,0x00A7,0x00F7,0x00B8,0x00B0,0x00A8,0x00B7,0x00B9,0x00B3,0x00B2,0x25A0,0x00A0
+};
+
+/* 1252 differs from 819 (ISO 8859-1) only in the range 0x80-0x9F */
+static const U16
+cp_1252_to_ucs[32] = {
+ /*          x0     x1     x2     x3     x4     x5     x6     x7     x8     x9     xA     xB     xC     xD     xE     xF  */
+ /* 8x */ 0x20AC,0x0081,0x201A,0x0192,0x201E,0x2026,0x2020,0x2021,0x02C6,0x2030,0x0160,0x2039,0x0152,0x008D,0x017D,0x008F,
+ /* 9x */ 0x0090,0x2018,0x2019,0x201C,0x201D,0x2022,0x2013,0x2014,0x02DC,0x2122,0x0161,0x203A,0x0153,0x009D,0x017E,0x0178
+};
+
+/*--------------------------------------------------------------------------*/
+/* Unicode conversion tables                                                */
+/*                                                                          */
+/* Code points outside the Basic Multilingual Plane are not supported.      */
+/* Guest codes of 0x0100 and above in u2g are DBCS characters.              */
+
+#define CP_UNMAPPED     0xFFFF          /* No mapping for character  */
+#define CP_REPLACEMENT  0xFFFD          /* Unicode replacement char  */
+#define CP_IDEO_SPACE   0x3000          /* Ideographic space         */
+#define CP_DBCS_SPACE   0x4040          /* DBCS space                */
+
+typedef struct _CPUNI {
+    U16     g2u[256];                   /* SBCS guest to Unicode     */
+    U16    *dg2u[256];                  /* DBCS guest to Unicode,
+                                           indexed by lead byte      */
+    U16    *u2g[256];                   /* Unicode to guest, indexed
+                                           by high order byte        */
+    BYTE    dbcs;                       /* SO/SI stateful code page  */
+    BYTE    subchar;                    /* SBCS substitution char    */
+    U16     dsubchar;                   /* DBCS substitution char    */
+} CPUNI;
 
 typedef struct _CPCONV {
     char *name;
     unsigned char *h2g;
     unsigned char *g2h;
+    CPUNI *uni;                         /* Unicode tables (UCM only) */
 } CPCONV;
 
 /* NOTE: 'maint' can never be a code page name */
@@ -1059,6 +1122,18 @@ static CPCONV cpconv[] = {
 
 static CPCONV *codepage_conv = cpconv;
 
+/* Code pages loaded from UCM mapping tables */
+static CPCONV **ucmconv = NULL;
+static int      ucmcount = 0;
+
+/* Unicode tables built from the current built-in code page */
+#define CP_UNI_PAGES    16              /* Enough for any host page  */
+static CPUNI    builtin_uni;
+static U16      builtin_pages[CP_UNI_PAGES][256];
+static CPCONV  *builtin_uni_conv = NULL;
+
+static bool     host_utf8 = false;      /* Host encoding is UTF-8    */
+
 DLL_EXPORT unsigned char *h2g_tab() { return codepage_conv->h2g; }
 DLL_EXPORT unsigned char *g2h_tab() { return codepage_conv->g2h; }
 
@@ -1067,13 +1142,22 @@ DLL_EXPORT const char* query_codepage()
     return codepage_conv->name;
 }
 
+static CPCONV* find_ucm_codepage( const char* name )
+{
+    int i;
+    for (i = 0; i < ucmcount; i++)
+        if (strcasecmp( name, ucmconv[i]->name ) == 0)
+            return ucmconv[i];
+    return NULL;
+}
+
 DLL_EXPORT bool valid_codepage_name( const char* name )
 {
     const CPCONV* cp;
     for(cp = cpconv; cp->name; cp++)
         if (strcasecmp( name, cp->name ) == 0)
             return true;
-    return false;
+    return find_ucm_codepage( name ) != NULL;
 }
 
 DLL_EXPORT void set_codepage( const char* name )
@@ -1093,6 +1177,8 @@ DLL_EXPORT void set_codepage( const char* name )
         name = "default";
     }
 
+    builtin_uni_conv = NULL;
+
     for(codepage_conv = cpconv;
         codepage_conv->name && strcasecmp(codepage_conv->name,name);
         codepage_conv++);
@@ -1100,6 +1186,17 @@ DLL_EXPORT void set_codepage( const char* name )
     if( codepage_conv->name && strcasecmp(codepage_conv->name,"user") == 0 && user_in_use == FALSE )
         codepage_conv++;
 
+    /* Code pages loaded from UCM tables are only usable in UTF-8 */
+    if (!codepage_conv->name)
+    {
+        CPCONV* ucm = find_ucm_codepage( name );
+        if (ucm)
+        {
+            codepage_conv = ucm;
+            host_utf8 = true;
+        }
+    }
+
     if(codepage_conv->name)
     {
         if (!dflt)
@@ -1116,6 +1213,9 @@ DLL_EXPORT int update_codepage(int argc, char *argv[], char *cmd )
 {
     int rc = 0;
 
+    /* User tables may change; rebuild Unicode tables on next use */
+    builtin_uni_conv = NULL;
+
     if ( CMD(cmd,alter,3) )
     {
         int     addargc;
@@ -1536,6 +1636,68 @@ DLL_EXPORT int update_codepage(int argc, char *argv[], char *cmd )
     return rc;
 }
 
+/*--------------------------------------------------------------------------*/
+/* Translate a buffer through a 256 byte table                              */
+/*--------------------------------------------------------------------------*/
+#if defined( CP_AVX2_XLATE )
+/* The table is split into sixteen 16 byte rows, one per high order
+   nibble. Each row is looked up with VPSHUFB by the low order nibble
+   and the result kept only for the bytes whose high nibble selects
+   that row. This translates 32 bytes per iteration. */
+__attribute__(( target( "avx2" )))
+static void cp_xlate_avx2( const BYTE* tab, const BYTE* in, BYTE* out, size_t len )
+{
+    __m256i  row[16];
+    __m256i  lonib = _mm256_set1_epi8( 0x0F );
+    size_t   i;
+    int      k;
+
+    for (k = 0; k < 16; k++)
+        row[k] = _mm256_broadcastsi128_si256(
+                     _mm_loadu_si128( (const __m128i*)(tab + (k << 4)) ));
+
+    for (i = 0; i + 32 <= len; i += 32)
+    {
+        __m256i v   = _mm256_loadu_si256( (const __m256i*)(in + i) );
+        __m256i lo  = _mm256_and_si256( v, lonib );
+        __m256i hi  = _mm256_and_si256( _mm256_srli_epi16( v, 4 ), lonib );
+        __m256i res = _mm256_setzero_si256();
+
+        for (k = 0; k < 16; k++)
+        {
+            __m256i sel = _mm256_cmpeq_epi8( hi, _mm256_set1_epi8( (char)k ));
+            res = _mm256_or_si256( res,
+                      _mm256_and_si256( sel, _mm256_shuffle_epi8( row[k], lo )));
+        }
+        _mm256_storeu_si256( (__m256i*)(out + i), res );
+    }
+
+    for (; i < len; i++)
+        out[i] = tab[ in[i] ];
+}
+#endif /* defined( CP_AVX2_XLATE ) */
+
+static void cp_xlate( const BYTE* tab, const BYTE* in, BYTE* out, size_t len )
+{
+    size_t i;
+
+#if defined( CP_AVX2_XLATE )
+    static int avx2 = -1;
+
+    if (avx2 < 0)
+        avx2 = __builtin_cpu_supports( "avx2" ) ? 1 : 0;
+
+    if (avx2 && len >= 64)
+    {
+        cp_xlate_avx2( tab, in, out, len );
+        return;
+    }
+#endif
+
+    for (i = 0; i < len; i++)
+        out[i] = tab[ in[i] ];
+}
+
 DLL_EXPORT unsigned char host_to_guest (unsigned char byte)
 {
     return (unsigned char)codepage_conv->h2g[(unsigned int)byte];
@@ -1549,20 +1711,14 @@ DLL_EXPORT unsigned char guest_to_host (unsigned char byte)
 
 DLL_EXPORT BYTE* buf_host_to_guest( const BYTE *psinbuf, BYTE *psoutbuf, const u_int ilength )
 {
-    u_int count;
-
-    for( count = 0; count < ilength; count++ )
-        psoutbuf[count] = host_to_guest(psinbuf[count]);
+    cp_xlate( codepage_conv->h2g, psinbuf, psoutbuf, ilength );
 
     return psoutbuf;
 }
 
 DLL_EXPORT BYTE* buf_guest_to_host( const BYTE *psinbuf, BYTE *psoutbuf, const u_int ilength )
 {
-    u_int count;
-
-    for( count = 0; count < ilength; count++ )
-        psoutbuf[count] = guest_to_host(psinbuf[count]);
+    cp_xlate( codepage_conv->g2h, psinbuf, psoutbuf, ilength );
 
     return psoutbuf;
 }
@@ -1591,12 +1747,9 @@ DLL_EXPORT BYTE* str_host_to_guest( const BYTE *psinbuf, BYTE *psoutbuf, const u
 
 DLL_EXPORT BYTE* str_guest_to_host( const BYTE *psinbuf, BYTE *psoutbuf, const u_int ilength )
 {
-    u_int count;
-
-    for( count = 0; count < ilength; count++ )
-        psoutbuf[count] = guest_to_host(psinbuf[count]);
+    cp_xlate( codepage_conv->g2h, psinbuf, psoutbuf, ilength );
 
-    psoutbuf[count] = '\0';
+    psoutbuf[ilength] = '\0';
 
     return psoutbuf;
 }
@@ -1642,6 +1795,546 @@ DLL_EXPORT BYTE* prt_host_to_guest( const BYTE *psinbuf, BYTE *psoutbuf, const u
     return psoutbuf;
 }
 
+/*--------------------------------------------------------------------------*/
+/* Unicode conversion                                                       */
+/*--------------------------------------------------------------------------*/
+
+static U16 host_to_ucs( int hostcp, BYTE c )
+{
+    if (c < 0x80)
+        return c;
+    switch (hostcp)
+    {
+    case 437:  return cp_437_to_ucs[ c - 0x80 ];
+    case 850:  return cp_850_to_ucs[ c - 0x80 ];
+    case 1252: if (c < 0xA0) return cp_1252_to_ucs[ c - 0x80 ];
+               return c;
+    default:   return c;                /* 819 is ISO 8859-1         */
+    }
+}
+
+static U16 uni_lookup( const CPUNI* uni, U16 u )
+{
+    const U16* page = uni->u2g[ u >> 8 ];
+    return page ? page[ u & 0xFF ] : CP_UNMAPPED;
+}
+
+/* Build the Unicode tables of a built-in code page. The host side
+   of the page is named by its numeric prefix ("437/037" etc);
+   all others are treated as ISO 8859-1. */
+static const CPUNI* builtin_unicode( CPCONV* conv )
+{
+    CPUNI*  uni = &builtin_uni;
+    int     hostcp = atoi( conv->name ? conv->name : "" );
+    int     npages = 0;
+    int     i;
+    U16     u;
+
+    if (builtin_uni_conv == conv)
+        return uni;
+
+    memset( uni, 0, sizeof(CPUNI) );
+    uni->subchar = conv->h2g[ (BYTE)'?' ];
+
+    for (i = 0; i < 256; i++)
+    {
+        uni->g2u[i] = u = host_to_ucs( hostcp, conv->g2h[i] );
+
+        if (!uni->u2g[ u >> 8 ])
+        {
+            if (npages >= CP_UNI_PAGES)
+                continue;
+            uni->u2g[ u >> 8 ] = builtin_pages[ npages++ ];
+            memset( uni->u2g[ u >> 8 ], 0xFF, 256 * sizeof(U16) );
+        }
+        /* Round trip mappings take precedence */
+        if (uni->u2g[ u >> 8 ][ u & 0xFF ] == CP_UNMAPPED)
+            uni->u2g[ u >> 8 ][ u & 0xFF ] = (U16) i;
+    }
+
+    /* Add host characters that do not round trip */
+    for (i = 0; i < 256; i++)
+    {
+        u = host_to_ucs( hostcp, (BYTE) i );
+        if (!uni->u2g[ u >> 8 ])
+        {
+            if (npages >= CP_UNI_PAGES)
+                continue;
+            uni->u2g[ u >> 8 ] = builtin_pages[ npages++ ];
+            memset( uni->u2g[ u >> 8 ], 0xFF, 256 * sizeof(U16) );
+        }
+        if (uni->u2g[ u >> 8 ][ u & 0xFF ] == CP_UNMAPPED)
+            uni->u2g[ u >> 8 ][ u & 0xFF ] = conv->h2g[i];
+    }
+
+    builtin_uni_conv = conv;
+    return uni;
+}
+
+static const CPUNI* current_unicode()
+{
+    if (codepage_conv->uni)
+        return codepage_conv->uni;
+    return builtin_unicode( codepage_conv );
+}
+
+DLL_EXPORT bool codepage_utf8()
+{
+    return host_utf8;
+}
+
+DLL_EXPORT bool codepage_dbcs()
+{
+    return codepage_conv->uni && codepage_conv->uni->dbcs;
+}
+
+DLL_EXPORT void set_codepage_utf8( bool utf8 )
+{
+    /* UCM code pages have no single byte host equivalent */
+    if (!utf8 && codepage_conv->uni)
+        utf8 = true;
+
+    host_utf8 = utf8;
+}
+
+static int is_control( U16 u )
+{
+    return u < 0x20 || (u >= 0x7F && u < 0xA0);
+}
+
+/* Append a character in the host encoding; returns bytes stored */
+static size_t put_host_char( U16 u, BYTE* out, size_t room )
+{
+    if (!host_utf8)
+    {
+        if (room < 1) return 0;
+        out[0] = (u < 0x100) ? (BYTE) u : '?';
+        return 1;
+    }
+    if (u < 0x80)
+    {
+        if (room < 1) return 0;
+        out[0] = (BYTE) u;
+        return 1;
+    }
+    if (u < 0x800)
+    {
+        if (room < 2) return 0;
+        out[0] = (BYTE)(0xC0 |  (u >> 6));
+        out[1] = (BYTE)(0x80 |  (u & 0x3F));
+        return 2;
+    }
+    if (room < 3) return 0;
+    out[0] = (BYTE)(0xE0 |  (u >> 12));
+    out[1] = (BYTE)(0x80 | ((u >> 6) & 0x3F));
+    out[2] = (BYTE)(0x80 |  (u & 0x3F));
+    return 3;
+}
+
+/* Decode one UTF-8 character; returns bytes consumed */
+static size_t get_utf8_char( const BYTE* in, size_t len, U16* u )
+{
+    BYTE    c = in[0];
+    size_t  n, i;
+    U32     cp;
+
+    if (c < 0x80)      { *u = c; return 1; }
+    else if (c < 0xC2) { *u = CP_REPLACEMENT; return 1; }
+    else if (c < 0xE0) { n = 2; cp = c & 0x1F; }
+    else if (c < 0xF0) { n = 3; cp = c & 0x0F; }
+    else if (c < 0xF5) { n = 4; cp = c & 0x07; }
+    else               { *u = CP_REPLACEMENT; return 1; }
+
+    if (len < n)
+    {
+        *u = CP_REPLACEMENT;
+        return len;
+    }
+    for (i = 1; i < n; i++)
+    {
+        if ((in[i] & 0xC0) != 0x80)
+        {
+            *u = CP_REPLACEMENT;
+            return i;
+        }
+        cp = (cp << 6) | (in[i] & 0x3F);
+    }
+    *u = (cp > 0xFFFF) ? CP_REPLACEMENT : (U16) cp;
+    return n;
+}
+
+/*--------------------------------------------------------------------------*/
+/* Convert guest data to the host encoding. The output is always null      */
+/* terminated; the returned length excludes the null.                      */
+/*--------------------------------------------------------------------------*/
+DLL_EXPORT size_t cp_guest_to_host( CPSTATE* st, const BYTE* in, size_t inlen,
+                                    BYTE* out, size_t outsize, int flags )
+{
+    const CPUNI* uni;
+    size_t  i, n, len = 0;
+    U16     u;
+
+    if (!outsize)
+        return 0;
+    outsize--;                          /* room for the null         */
+
+    /* Single byte host code page: straight table translation */
+    if (!host_utf8 && !codepage_conv->uni)
+    {
+        len = MIN( inlen, outsize );
+        cp_xlate( codepage_conv->g2h, in, out, len );
+        if (flags & (CP_CTL_DOT | CP_CTL_SPACE))
+            for (i = 0; i < len; i++)
+                if (!isprint( out[i] ))
+                    out[i] = (flags & CP_CTL_DOT) ? '.' : ' ';
+        out[len] = 0;
+        return len;
+    }
+
+    uni = current_unicode();
+
+    for (i = 0; i < inlen; i++)
+    {
+        BYTE c = in[i];
+
+        if (uni->dbcs)
+        {
+            if (c == CP_SO) { st->shift = 1; st->haslead = 0; continue; }
+            if (c == CP_SI) { st->shift = 0; st->haslead = 0; continue; }
+
+            if (st->shift)
+            {
+                if (!st->haslead)
+                {
+                    st->lead = c;
+                    st->haslead = 1;
+                    continue;
+                }
+                st->haslead = 0;
+
+                u = uni->dg2u[ st->lead ] ? uni->dg2u[ st->lead ][ c ]
+                                          : CP_UNMAPPED;
+                if (u == CP_UNMAPPED)
+                    u = ((st->lead << 8 | c) == CP_DBCS_SPACE) ?
+                        CP_IDEO_SPACE : CP_REPLACEMENT;
+
+                if (!(n = put_host_char( u, out + len, outsize - len )))
+                    break;
+                len += n;
+                continue;
+            }
+        }
+
+        u = uni->g2u[c];
+
+        if (u == CP_UNMAPPED)
+            u = CP_REPLACEMENT;
+        else if (is_control( u ) && (flags & (CP_CTL_DOT | CP_CTL_SPACE)))
+            u = (flags & CP_CTL_DOT) ? '.' : ' ';
+
+        if (!(n = put_host_char( u, out + len, outsize - len )))
+            break;
+        len += n;
+    }
+
+    out[len] = 0;
+    return len;
+}
+
+/*--------------------------------------------------------------------------*/
+/* Convert host data to the guest code page. DBCS characters are enclosed  */
+/* in SO/SI, and the output always ends in single byte mode.               */
+/*--------------------------------------------------------------------------*/
+DLL_EXPORT size_t cp_host_to_guest( CPSTATE* st, const BYTE* in, size_t inlen,
+                                    BYTE* out, size_t outsize, int flags )
+{
+    const CPUNI* uni;
+    size_t  i, len = 0;
+    U16     u, g;
+
+    /* Single byte host code page: straight table translation */
+    if (!host_utf8 && !codepage_conv->uni)
+    {
+        len = MIN( inlen, outsize );
+        for (i = 0; i < len; i++)
+        {
+            BYTE c = in[i];
+            if ((flags & (CP_CTL_DOT | CP_CTL_SPACE)) && !isprint( c ))
+                c = (flags & CP_CTL_DOT) ? '.' : ' ';
+            out[i] = codepage_conv->h2g[c];
+        }
+        return len;
+    }
+
+    uni = current_unicode();
+
+    for (i = 0; i < inlen; )
+    {
+        size_t need;
+
+        if (host_utf8)
+            i += get_utf8_char( in + i, inlen - i, &u );
+        else
+            u = in[i++];
+
+        if (is_control( u ) && (flags & (CP_CTL_DOT | CP_CTL_SPACE)))
+            u = (flags & CP_CTL_DOT) ? '.' : ' ';
+
+        if ((g = uni_lookup( uni, u )) == CP_UNMAPPED)
+            g = (uni->dbcs && u >= 0x0800) ? uni->dsubchar : uni->subchar;
+
+        if (g >= 0x0100)
+        {
+            /* Double byte character; keep room for the closing SI */
+            need = 2 + (st->shift ? 0 : 1) + 1;
+            if (len + need > outsize)
+                break;
+            if (!st->shift)
+            {
+                out[len++] = CP_SO;
+                st->shift = 1;
+            }
+            out[len++] = (BYTE)(g >> 8);
+            out[len++] = (BYTE) g;
+        }
+        else
+        {
+            need = 1 + (st->shift ? 1 : 0);
+            if (len + need > outsize)
+                break;
+            if (st->shift)
+            {
+                out[len++] = CP_SI;
+                st->shift = 0;
+            }
+            out[len++] = (BYTE) g;
+        }
+    }
+
+    if (st->shift)
+    {
+        out[len++] = CP_SI;
+        st->shift = 0;
+    }
+
+    return len;
+}
+
+/*--------------------------------------------------------------------------*/
+/* Load an ICU-style UCM mapping table                                      */
+/*                                                                          */
+/* Only the header fields <code_set_name>, <uconv_class>, <subchar> and     */
+/* the CHARMAP section are used. Mappings with precision |0 are used in     */
+/* both directions, |1 (fallback) from Unicode only and |3 (reverse         */
+/* fallback) to Unicode only; |2 (subchar1) mappings are ignored.           */
+/*--------------------------------------------------------------------------*/
+
+static int ucm_bytes( const char* p, BYTE* b, int max )
+{
+    int n = 0;
+    unsigned int x;
+
+    while (p[0] == '\\' && p[1] == 'x' && n < max)
+    {
+        if (sscanf( p + 2, "%2x", &x ) != 1)
+            return -1;
+        b[n++] = (BYTE) x;
+        p += 4;
+    }
+    return (n && !(p[0] == '\\' && p[1] == 'x')) ? n : -1;
+}
+
+static U16* ucm_page( U16** pages, int idx )
+{
+    if (!pages[idx])
+    {
+        if (!(pages[idx] = malloc( 256 * sizeof(U16) )))
+            return NULL;
+        memset( pages[idx], 0xFF, 256 * sizeof(U16) );
+    }
+    return pages[idx];
+}
+
+DLL_EXPORT int load_codepage_ucm( const char* fn, const char* name )
+{
+    FILE*   f;
+    CPCONV* conv;
+    CPUNI*  uni;
+    CPCONV** newlist;
+    char    line[512];
+    char    setname[64] = "";
+    char   *p;
+    BYTE    b[4];
+    unsigned int ucs;
+    int     prec, n, i;
+    int     lineno = 0, incharmap = 0;
+    int     nsbcs = 0, ndbcs = 0;
+    U16    *page;
+    U16     g;
+    const char* err = NULL;
+
+    if (!(f = fopen( fn, "r" )))
+    {
+        // "Codepage: Error loading %s line %d: %s"
+        WRMSG( HHC01496, "E", fn, 0, strerror( errno ));
+        return -1;
+    }
+
+    if (!(conv = calloc( 1, sizeof(CPCONV) ))
+     || !(uni  = calloc( 1, sizeof(CPUNI) ))
+     || !(conv->g2h = malloc( 256 ))
+     || !(conv->h2g = malloc( 256 )))
+    {
+        fclose( f );
+        WRMSG( HHC01496, "E", fn, 0, strerror( ENOMEM ));
+        return -1;
+    }
+    conv->uni = uni;
+    memset( uni->g2u, 0xFF, sizeof(uni->g2u) );
+    uni->subchar  = 0x3F;               /* EBCDIC SUB                */
+    uni->dsubchar = 0xFEFE;
+
+    while (!err && fgets( line, sizeof(line), f ))
+    {
+        lineno++;
+        for (p = line; isspace( (unsigned char)*p ); p++);
+
+        if (!*p || *p == '#')
+            continue;
+
+        if (!incharmap)
+        {
+            if (strncmp( p, "CHARMAP", 7 ) == 0)
+                incharmap = 1;
+            else if (strncmp( p, "<code_set_name>", 15 ) == 0)
+                sscanf( p + 15, " \"%63[^\"]\"", setname );
+            else if (strncmp( p, "<uconv_class>", 13 ) == 0)
+            {
+                if (strstr( p, "EBCDIC_STATEFUL" ))
+                    uni->dbcs = 1;
+                else if (!strstr( p, "SBCS" ))
+                    err = "only SBCS and EBCDIC_STATEFUL tables are supported";
+            }
+            else if (strncmp( p, "<subchar>", 9 ) == 0)
+            {
+                for (p += 9; isspace( (unsigned char)*p ); p++);
+                n = ucm_bytes( p, b, 2 );
+                if (n == 1)
+                    uni->subchar = b[0];
+                else if (n == 2)
+                    uni->dsubchar = (U16)(b[0] << 8 | b[1]);
+            }
+            continue;
+        }
+
+        if (strncmp( p, "END CHARMAP", 11 ) == 0)
+            break;
+
+        /* <Uxxxx> \xHH[\xHH] |n */
+        if (sscanf( p, "<U%x>", &ucs ) != 1)
+        {
+            err = "invalid mapping";
+            break;
+        }
+        p = strchr( p, '>' ) + 1;
+
+        /* Skip supplementary and multiple code point mappings */
+        if (ucs > 0xFFFF || *p == '<')
+            continue;
+
+        for (; isspace( (unsigned char)*p ); p++);
+        if ((n = ucm_bytes( p, b, 2 )) < 0)
+        {
+            err = "invalid byte sequence";
+            break;
+        }
+        p = strchr( p, '|' );
+        prec = p ? atoi( p + 1 ) : 0;
+
+        if (prec == 2)
+            continue;
+
+        g = (n == 1) ? b[0] : (U16)(b[0] << 8 | b[1]);
+
+        /* Guest to Unicode */
+        if (prec == 0 || prec == 3)
+        {
+            if (n == 1)
+            {
+                if (prec == 0 || uni->g2u[ b[0] ] == CP_UNMAPPED)
+                    uni->g2u[ b[0] ] = (U16) ucs;
+                nsbcs++;
+            }
+            else
+            {
+                if (!(page = ucm_page( uni->dg2u, b[0] )))
+                    err = strerror( ENOMEM );
+                else if (prec == 0 || page[ b[1] ] == CP_UNMAPPED)
+                    page[ b[1] ] = (U16) ucs;
+                ndbcs++;
+            }
+        }
+
+        /* Unicode to guest */
+        if (!err && (prec == 0 || prec == 1))
+        {
+            if (!(page = ucm_page( uni->u2g, ucs >> 8 )))
+                err = strerror( ENOMEM );
+            else if (prec == 0 || page[ ucs & 0xFF ] == CP_UNMAPPED)
+                page[ ucs & 0xFF ] = g;
+        }
+    }
+
+    fclose( f );
+
+    if (!err && !incharmap)
+        err = "no CHARMAP section";
+    if (!err && !name && !setname[0])
+        err = "no code set name";
+    if (!err && find_ucm_codepage( name ? name : setname ))
+        err = "code page is already loaded";
+    if (!err && valid_codepage_name( name ? name : setname ))
+        err = "name is a built-in code page";
+
+    if (err)
+    {
+        WRMSG( HHC01496, "E", fn, lineno, err );
+        for (i = 0; i < 256; i++)
+        {
+            free( uni->dg2u[i] );
+            free( uni->u2g[i] );
+        }
+        free( conv->g2h );
+        free( conv->h2g );
+        free( uni );
+        free( conv );
+        return -1;
+    }
+
+    /* Single byte equivalents for callers that are not Unicode aware */
+    for (i = 0; i < 256; i++)
+    {
+        ucs = uni->g2u[i];
+        conv->g2h[i] = (ucs < 0x100) ? (BYTE) ucs : '?';
+        g = uni_lookup( uni, (U16) i );
+        conv->h2g[i] = (g < 0x100) ? (BYTE) g : uni->subchar;
+    }
+
+    conv->name = strdup( name ? name : setname );
+
+    if (!(newlist = realloc( ucmconv, (ucmcount + 1) * sizeof(CPCONV*) )))
+    {
+        WRMSG( HHC01496, "E", fn, lineno, strerror( ENOMEM ));
+        return -1;
+    }
+    ucmconv = newlist;
+    ucmconv[ ucmcount++ ] = conv;
+
+    // "Codepage: %s loaded from %s: %d single byte and %d double byte mappings"
+    WRMSG( HHC01497, "I", conv->name, fn, nsbcs, ndbcs );
+    return 0;
+}
+
 static int import_file(char *fn, char *buf, int buflen)
 {
     FILE   *binfile;
@@ -28,4 +28,32 @@ COD_DLL_IMPORT BYTE* str_host_to_guest( const BYTE *psinbuf, BYTE *psoutbuf, con
 COD_DLL_IMPORT BYTE* prt_guest_to_host( const BYTE *psinbuf, BYTE *psoutbuf, const u_int ilength );
 COD_DLL_IMPORT BYTE* prt_host_to_guest( const BYTE *psinbuf, BYTE *psoutbuf, const u_int ilength );
 
+/* Unicode and DBCS aware conversion                                */
+/*                                                                  */
+/* When the host encoding is UTF-8, or the guest code page was      */
+/* loaded from an ICU-style UCM mapping table, guest data is        */
+/* converted through Unicode. DBCS code pages (EBCDIC_STATEFUL)     */
+/* switch between single and double byte mode on SO and SI; the     */
+/* shift state is carried in a CPSTATE so that a stream can be      */
+/* converted in pieces. A zeroed CPSTATE is in single byte mode.    */
+
+typedef struct CPSTATE {
+    BYTE    shift;                      /* Guest is in DBCS mode     */
+    BYTE    haslead;                    /* DBCS lead byte pending    */
+    BYTE    lead;                       /* Pending DBCS lead byte    */
+} CPSTATE;
+
+#define CP_SO           0x0E            /* EBCDIC shift-out (DBCS)   */
+#define CP_SI           0x0F            /* EBCDIC shift-in (SBCS)    */
+
+#define CP_CTL_DOT      0x01            /* Control chars become '.'  */
+#define CP_CTL_SPACE    0x02            /* Control chars become ' '  */
+
+COD_DLL_IMPORT bool codepage_utf8();
+COD_DLL_IMPORT bool codepage_dbcs();
+COD_DLL_IMPORT void set_codepage_utf8( bool utf8 );
+COD_DLL_IMPORT int  load_codepage_ucm( const char* fn, const char* name );
+COD_DLL_IMPORT size_t cp_guest_to_host( CPSTATE* st, const BYTE* in, size_t inlen, BYTE* out, size_t outsize, int flags );
+COD_DLL_IMPORT size_t cp_host_to_guest( CPSTATE* st, const BYTE* in, size_t inlen, BYTE* out, size_t outsize, int flags );
+
 #endif /* _HERCULES_CODEPAGE_H */
@@ -21,6 +21,7 @@ DISABLE_GCC_UNUSED_FUNCTION_WARNING;
 #include "opcode.h"
 #include "chsc.h"
 #include "cckddasd.h"
+#include "storshm.h"
 
 /*-------------------------------------------------------------------*/
 /*   ARCH_DEP section: compiled multiple times, once for each arch.  */
@@ -232,12 +233,179 @@ DISABLE_GCC_WARNING( "-Wint-to-pointer-cast" )
 
 static U64    config_allocmsize  = 0;
 static BYTE*  config_allocmaddr  = NULL;
+static size_t config_allocshm    = 0;       /* Size if shared memory */
+static char*  config_shmpath     = NULL;    /* Shared memory object  */
+static bool   config_realloc     = false;   /* Allocate new storage  */
+
+static void mainshare_forget();
+
+/*-------------------------------------------------------------------*/
+/* Remove the name of the shared memory object                       */
+/*-------------------------------------------------------------------*/
+static void storshm_unlink()
+{
+    if (config_shmpath)
+    {
+        unlink( config_shmpath );
+        free( config_shmpath );
+        config_shmpath = NULL;
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/* Allocate storage in the shared memory object named by 'storshm'   */
+/*-------------------------------------------------------------------*/
+static BYTE* storshm_create( size_t size )
+{
+#if !defined( _MSVC_ )
+    char   path[ MAX_PATH ];
+    BYTE*  p;
+    int    fd, err;
+
+    if (storshm_path( path, sizeof( path ), sysblk.storshmname ) != 0)
+        return NULL;
+
+    /* Tools that still map the previous object keep their view of it */
+    storshm_unlink();
+    unlink( path );
+
+    /* (only the user running Hercules may map it) */
+    if ((fd = open( path, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR )) < 0)
+        return NULL;
+
+    if (ftruncate( fd, (off_t) size ) != 0
+        || (p = mmap( NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0 )) == MAP_FAILED)
+    {
+        err = errno;
+        close( fd );
+        unlink( path );
+        errno = err;
+        return NULL;
+    }
+
+    close( fd );
+    config_shmpath = strdup( path );
+    return p;
+#else
+    UNREFERENCED( size );
+    errno = ENOTSUP;
+    return NULL;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Release storage allocated in a shared memory object               */
+/*-------------------------------------------------------------------*/
+static void storshm_free( BYTE* addr, size_t size )
+{
+    STORSHM_HDR*  hdr = (STORSHM_HDR*) addr;
+
+    /* Tools still mapping the object learn it is no longer used */
+    hdr->retired = 1;
+    hdr->generation += 2;
+
+    if (sysblk.storshm == hdr)
+        sysblk.storshm = NULL;
+
+#if !defined( _MSVC_ )
+    munmap( addr, size );
+#else
+    UNREFERENCED( size );
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Describe the storage in the shared memory object header           */
+/*-------------------------------------------------------------------*/
+static void storshm_publish()
+{
+    STORSHM_HDR*  hdr = (STORSHM_HDR*) config_allocmaddr;
+    int           cpu;
+
+    hdr->generation++;                  /* (odd while changing)      */
+
+    memcpy( hdr->eyecatcher, STORSHM_EYECATCHER, sizeof( hdr->eyecatcher ));
+    hdr->version    = STORSHM_VERSION;
+    hdr->hdrsize    = STORSHM_HDRSIZE;
+    hdr->retired    = 0;
+    hdr->mainsize   = sysblk.mainsize;
+    hdr->keyoffset  = sysblk.storkeys - config_allocmaddr;
+    hdr->mainoffset = sysblk.mainstor - config_allocmaddr;
+    hdr->keyunit    = _STORKEY_ARRAY_UNITSIZE;
+    hdr->numcpu     = MIN( MAX_CPU_ENGS, STORSHM_MAXCPU );
+
+    sysblk.storshm = hdr;
+
+    storshm_reset();
+
+    for (cpu = 0; cpu < (int) hdr->numcpu; cpu++)
+        storshm_cpu( cpu );
+
+    hdr->generation++;
+}
+
+/*-------------------------------------------------------------------*/
+/* storshm_reset - show tools that storage was reset                 */
+/*-------------------------------------------------------------------*/
+void storshm_reset()
+{
+    STORSHM_HDR*  hdr = sysblk.storshm;
+
+    if (!hdr)
+        return;
+
+    hdr->archmode = sysblk.arch_mode == ARCH_900_IDX ? 2
+                  : sysblk.arch_mode == ARCH_390_IDX ? 1 : 0;
+    hdr->generation += 2;
+}
+
+/*-------------------------------------------------------------------*/
+/* storshm_cpu - publish whether a CPU is online and its prefix      */
+/*-------------------------------------------------------------------*/
+void storshm_cpu( int cpu )
+{
+    STORSHM_HDR*  hdr = sysblk.storshm;
+
+    if (!hdr || cpu < 0 || cpu >= (int) hdr->numcpu)
+        return;
+
+    if (IS_CPU_ONLINE( cpu ))
+    {
+        hdr->prefix[ cpu ] = sysblk.regs[ cpu ]->PX_G;
+        hdr->online[ cpu ] = 1;
+    }
+    else
+    {
+        hdr->online[ cpu ] = 0;
+        hdr->prefix[ cpu ] = 0;
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/* configure_storshm - allocate storage in a shared memory object    */
+/*-------------------------------------------------------------------*/
+/* 'name' is the name of the object, NULL to allocate storage from   */
+/* the heap again.  Main storage is reallocated and thus cleared.    */
+/*-------------------------------------------------------------------*/
+int configure_storshm( const char* name )
+{
+    if (are_any_cpus_started())
+        return HERRCPUONL;
+
+    free( sysblk.storshmname );
+    sysblk.storshmname = name ? strdup( name ) : NULL;
+
+    config_realloc = true;
+    return configure_storage( sysblk.mainsize >> SHIFT_4K );
+}
 
 int configure_storage( U64 mainsize /* number of 4K pages */ )
 {
     BYTE*  mainstor;
     BYTE*  storkeys;
     BYTE*  dofree = NULL;
+    size_t dofreeshm = 0;
     char*  mfree  = NULL;
     U64    storsize;
     U32    skeysize;
@@ -246,19 +414,29 @@ int configure_storage( U64 mainsize /* number of 4K pages */ )
     if (are_any_cpus_started())
         return HERRCPUONL;
 
+    /* Main storage must not be replaced under a zero frame scan */
+    obtain_lock( &sysblk.mainsharelock );
+
     /* Release storage and return if deconfiguring */
     if (mainsize == ~0ULL)
     {
-        if (config_allocmaddr)
+        if (config_allocshm)
+            storshm_free( config_allocmaddr, config_allocshm );
+        else if (config_allocmaddr)
             free( config_allocmaddr );
 
+        storshm_unlink();
+
         sysblk.storkeys = 0;
         sysblk.mainstor = 0;
         sysblk.mainsize = 0;
 
         config_allocmsize = 0;
         config_allocmaddr = NULL;
+        config_allocshm   = 0;
 
+        mainshare_forget();
+        release_lock( &sysblk.mainsharelock );
         return 0;
     }
 
@@ -313,13 +491,21 @@ int configure_storage( U64 mainsize /* number of 4K pages */ )
     if (0
         || (storsize > config_allocmsize)
         || (storsize < config_allocmsize && mainsize <= DEF_MAINSIZE_PAGES)
+        || config_realloc
     )
     {
+        config_realloc = false;
+
         if (config_mfree && mainsize > DEF_MAINSIZE_PAGES)
             mfree = malloc( config_mfree );
 
-        /* Obtain storage with pagesize hint for cleanest allocation */
-        storkeys = calloc( (size_t)(storsize + 1), _4K );
+        /* Obtain storage with pagesize hint for cleanest allocation,
+         * or behind the header of the shared memory object for tools.
+         */
+        if (sysblk.storshmname)
+            storkeys = storshm_create( STORSHM_HDRSIZE + (size_t)(storsize << SHIFT_4K) );
+        else
+            storkeys = calloc( (size_t)(storsize + 1), _4K );
 
         if (mfree)
             free( mfree );
@@ -336,20 +522,28 @@ int configure_storage( U64 mainsize /* number of 4K pages */ )
 
             // "Error in function %s: %s"
             WRMSG( HHC01430, "S", buf, strerror( errno ));
+            release_lock( &sysblk.mainsharelock );
             return -1;
         }
 
         /* Previously allocated storage to be freed, update actual
          * storage pointers and adjust new storage to page boundary.
          */
-        dofree = config_allocmaddr;
+        dofree    = config_allocmaddr;
+        dofreeshm = config_allocshm;
 
         config_allocmsize = storsize;
         config_allocmaddr = storkeys;
+        config_allocshm   = sysblk.storshmname ?
+                            STORSHM_HDRSIZE + (size_t)(storsize << SHIFT_4K) : 0;
 
         sysblk.main_clear = 1;
+        sysblk.main_image = 0;
 
-        storkeys = (BYTE*)(((U64)storkeys + (_4K-1)) & ~0x0FFFULL);
+        if (config_allocshm)
+            storkeys += STORSHM_HDRSIZE;
+        else
+            storkeys = (BYTE*)(((U64)storkeys + (_4K-1)) & ~0x0FFFULL);
     }
     else
     {
@@ -374,10 +568,22 @@ int configure_storage( U64 mainsize /* number of 4K pages */ )
      *         that may be allocated following the initial storage
      *         allocation.
      */
-    if (dofree)
+    if (dofreeshm)
+        storshm_free( dofree, dofreeshm );
+    else if (dofree)
         free( dofree );
 
+    /* Describe storage to tools, or remove a former shared object */
+    if (config_allocshm)
+        storshm_publish();
+    else
+        storshm_unlink();
+
+    mainshare_forget();
+    release_lock( &sysblk.mainsharelock );
+
     /* Initial power-on reset for main storage */
+    cmma_reset();
     storage_clear();  /* only clears if needed */
 
 #if 0   /* DEBUG-JJ - 20/03/2000 */
@@ -418,6 +624,488 @@ int configure_storage( U64 mainsize /* number of 4K pages */ )
     return 0;
 }
 
+#if !defined( _MSVC_ )
+/*-------------------------------------------------------------------*/
+/* configure_storage_image - map a main storage image copy-on-write  */
+/*-------------------------------------------------------------------*/
+int configure_storage_image( int fd, U64 size /* in bytes */ )
+{
+    /* Ensure all CPUs have been stopped */
+    if (are_any_cpus_started())
+        return HERRCPUONL;
+
+    if (!size || (size & (_4K-1)) || size > sysblk.mainsize)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    /* The image replaces the current main storage pages.  They are
+     * shared with every other private mapping of the same image and
+     * only copied by the host when they are first modified.
+     */
+    obtain_lock( &sysblk.mainsharelock );
+
+    if (mmap( sysblk.mainstor, (size_t) size, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_FIXED, fd, 0 ) == MAP_FAILED)
+    {
+        release_lock( &sysblk.mainsharelock );
+        return -1;
+    }
+
+    mainshare_forget();
+    release_lock( &sysblk.mainsharelock );
+
+    /* Tools can no longer see main storage in the shared object */
+    if (sysblk.storshm)
+    {
+        sysblk.storshm->retired = 1;
+        sysblk.storshm->generation += 2;
+        sysblk.storshm = NULL;
+    }
+
+    cmma_reset();
+    sysblk.main_clear = 0;
+    sysblk.main_image = 1;
+    return 0;
+}
+#endif
+
+/*-------------------------------------------------------------------*/
+/* release_host_pages - give host pages of main storage back         */
+/*-------------------------------------------------------------------*/
+static bool release_host_pages( BYTE* addr, size_t len )
+{
+#if defined( MADV_DONTNEED )
+    /* Main storage mapped from a clone image would be read back from
+     * the image, so there the pages are replaced by anonymous ones.
+     */
+    if (sysblk.main_image)
+        return mmap( addr, len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0 )
+               != MAP_FAILED;
+
+    /* Pages of a shared memory object must be removed from it */
+    if (config_allocshm)
+#if defined( MADV_REMOVE )
+        return madvise( addr, len, MADV_REMOVE ) == 0;
+#else
+        return false;
+#endif
+
+    /* (fails for locked storage, which is then just cleared) */
+    return madvise( addr, len, MADV_DONTNEED ) == 0;
+#else
+    UNREFERENCED( addr );
+    UNREFERENCED( len );
+    return false;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* release_storage - return main storage frames to the host          */
+/*-------------------------------------------------------------------*/
+/* The 'len' bytes at absolute address 'addr' contain zeros when     */
+/* they are next referenced.  The host pages entirely within the     */
+/* range are given back to the host, the rest is just cleared.       */
+/* Returns the number of bytes given back to the host.               */
+/*-------------------------------------------------------------------*/
+static U64 release_frames( RADR addr, U64 len )
+{
+    BYTE*      beg  = sysblk.mainstor + addr;
+    BYTE*      end  = beg + len;
+    uintptr_t  hpsz = (uintptr_t) HPAGESIZE();
+    BYTE*      hbeg = (BYTE*)(((uintptr_t) beg + hpsz - 1) & ~(hpsz - 1));
+    BYTE*      hend = (BYTE*)( (uintptr_t) end             & ~(hpsz - 1));
+
+    if (hbeg >= hend || !release_host_pages( hbeg, hend - hbeg ))
+    {
+        memset( beg, 0, (size_t) len );
+        return 0;
+    }
+
+    memset( beg,  0, hbeg - beg );
+    memset( hend, 0, end - hend );
+
+    return hend - hbeg;
+}
+
+/* (release_frames does the work; this also keeps the statistics)   */
+U64 release_storage( RADR addr, U64 len )
+{
+    U64  released = release_frames( addr, len );
+
+    obtain_lock( &sysblk.cmmalock );
+    sysblk.releasedbytes += released;
+    release_lock( &sysblk.cmmalock );
+
+    return released;
+}
+
+/*-------------------------------------------------------------------*/
+/*        Collaborative memory management (ESSA instruction)         */
+/*-------------------------------------------------------------------*/
+/* The guest tells with ESSA which frames it no longer uses.  Those  */
+/* are returned to the host, a run of consecutive frames at a time   */
+/* since the guest usually releases whole blocks one frame after     */
+/* the other.  Until the run is complete its frames stay resident.   */
+/* Volatile frames are never discarded so no discard faults occur.   */
+/*-------------------------------------------------------------------*/
+
+#define CMMA_MAXRUN     256             /* Frames released at once   */
+
+/*-------------------------------------------------------------------*/
+/* Return the pending run of unused frames to the host               */
+/*-------------------------------------------------------------------*/
+static void cmma_release_run()  /* (with cmmalock held) */
+{
+    U64  frame;
+
+    if (sysblk.cmmarunend == sysblk.cmmarunbeg)
+        return;
+
+    sysblk.releasedbytes +=
+        release_frames(  sysblk.cmmarunbeg << SHIFT_4K,
+                        (sysblk.cmmarunend - sysblk.cmmarunbeg) << SHIFT_4K );
+
+    for (frame = sysblk.cmmarunbeg; frame < sysblk.cmmarunend; frame++)
+        sysblk.cmmastate[ frame ] |= ESSA_CONTENT_ZERO;
+
+    sysblk.cmmarunbeg = sysblk.cmmarunend = 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* cmma_essa - perform an ESSA operation on a 4K frame               */
+/*-------------------------------------------------------------------*/
+/* Returns the state of the frame before the operation.              */
+/*-------------------------------------------------------------------*/
+BYTE cmma_essa( U64 frame, int op )
+{
+    BYTE  old, new;
+
+    obtain_lock( &sysblk.cmmalock );
+
+    if (!sysblk.cmmastate
+        && !(sysblk.cmmastate = calloc( (size_t)(sysblk.mainsize >> SHIFT_4K), 1 )))
+    {
+        /* (without state every frame is stable and resident) */
+        release_lock( &sysblk.cmmalock );
+        return ESSA_USAGE_STABLE | ESSA_CONTENT_RESIDENT;
+    }
+
+    old = sysblk.cmmastate[ frame ];
+
+    /* A frame in the pending run must be released before it changes */
+    if (op != ESSA_GET_STATE
+        && frame >= sysblk.cmmarunbeg && frame < sysblk.cmmarunend)
+    {
+        cmma_release_run();
+        old = sysblk.cmmastate[ frame ];
+    }
+
+    switch (op)
+    {
+    case ESSA_SET_STABLE:
+    case ESSA_SET_STABLE_RESIDENT:
+        new = ESSA_USAGE_STABLE;
+        break;
+
+    case ESSA_SET_STABLE_IF_RESIDENT:
+        new = (old & ESSA_CONTENT_MASK) ? old : ESSA_USAGE_STABLE;
+        break;
+
+    case ESSA_SET_UNUSED:
+        new = ESSA_USAGE_UNUSED | (old & ESSA_CONTENT_MASK);
+        break;
+
+    case ESSA_SET_VOLATILE:
+        new = ESSA_USAGE_VOLATILE;
+        break;
+
+    case ESSA_SET_POT_VOLATILE:
+        new = ESSA_USAGE_POT_VOLATILE;
+        break;
+
+    default: /* ESSA_GET_STATE */
+        new = old;
+        break;
+    }
+
+    sysblk.cmmastate[ frame ] = new;
+
+    if ((old & ESSA_USAGE_MASK) != ESSA_USAGE_UNUSED
+     && (new & ESSA_USAGE_MASK) == ESSA_USAGE_UNUSED)
+        sysblk.cmmaunused++;
+    else if ((old & ESSA_USAGE_MASK) == ESSA_USAGE_UNUSED
+          && (new & ESSA_USAGE_MASK) != ESSA_USAGE_UNUSED)
+        sysblk.cmmaunused--;
+
+    /* A newly unused frame extends the pending run or starts a new one */
+    if (op == ESSA_SET_UNUSED && !(old & ESSA_CONTENT_MASK))
+    {
+        if (frame != sysblk.cmmarunend
+            || sysblk.cmmarunend - sysblk.cmmarunbeg >= CMMA_MAXRUN)
+        {
+            cmma_release_run();
+            sysblk.cmmarunbeg = frame;
+        }
+        sysblk.cmmarunend = frame + 1;
+    }
+
+    release_lock( &sysblk.cmmalock );
+    return old;
+}
+
+/*-------------------------------------------------------------------*/
+/* cmma_flush - return all pending unused frames to the host         */
+/*-------------------------------------------------------------------*/
+void cmma_flush()
+{
+    obtain_lock( &sysblk.cmmalock );
+    if (sysblk.cmmastate)
+        cmma_release_run();
+    release_lock( &sysblk.cmmalock );
+}
+
+/*-------------------------------------------------------------------*/
+/* cmma_reset - make every frame stable (storage has been cleared)   */
+/*-------------------------------------------------------------------*/
+void cmma_reset()
+{
+    obtain_lock( &sysblk.cmmalock );
+    free( sysblk.cmmastate );
+    sysblk.cmmastate  = NULL;
+    sysblk.cmmarunbeg = sysblk.cmmarunend = 0;
+    sysblk.cmmaunused = 0;
+    release_lock( &sysblk.cmmalock );
+}
+
+/*-------------------------------------------------------------------*/
+/*                   Main storage page sharing                       */
+/*-------------------------------------------------------------------*/
+/* Main storage is registered with the host for same page merging    */
+/* (KSM on Linux) and all-zero frames are given back to the host.    */
+/* A frame is only discarded when two scans in a row found it zero,  */
+/* which leaves the frames the guest is working with alone, and only */
+/* after checking it once more with the CPUs stopped and the I/O     */
+/* subsystem idle, so no store to the frame can be lost.  Neither    */
+/* the content nor the storage key of a frame changes, so the guest  */
+/* can not tell a discarded frame from any other.                    */
+/*-------------------------------------------------------------------*/
+
+#define MS_ZERO         0x01            /* Zero when last scanned    */
+#define MS_DISCARDED    0x02            /* Given back to the host    */
+#define MS_CANDIDATE    0x04            /* To be discarded now       */
+
+/*-------------------------------------------------------------------*/
+/* Register main storage for same page merging or unregister it      */
+/*-------------------------------------------------------------------*/
+static int mainshare_advise( int enable )
+{
+#if defined( MADV_MERGEABLE )
+    uintptr_t  hpsz = (uintptr_t) HPAGESIZE();
+    BYTE*      hbeg = (BYTE*)(((uintptr_t) sysblk.mainstor + hpsz - 1) & ~(hpsz - 1));
+    BYTE*      hend = (BYTE*)(((uintptr_t) sysblk.mainstor
+                               + sysblk.mainsize)            & ~(hpsz - 1));
+
+    if (!sysblk.mainstor || hbeg >= hend)
+        return 0;
+
+    return madvise( hbeg, hend - hbeg,
+                    enable ? MADV_MERGEABLE : MADV_UNMERGEABLE );
+#else
+    UNREFERENCED( enable );
+    return 0;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Test whether a 4K frame contains only zeros                       */
+/*-------------------------------------------------------------------*/
+static inline bool frame_is_zero( const BYTE* frame )
+{
+    const U64*  p   = (const U64*) frame;
+    const U64*  end = (const U64*)(frame + _4K);
+
+    for (; p < end; p += 4)
+        if (p[0] | p[1] | p[2] | p[3])
+            return false;
+
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/* Zero frame scanner thread                                         */
+/*-------------------------------------------------------------------*/
+static void* mainshare_thread( void* arg )
+{
+    U32  secs = 0;
+
+    UNREFERENCED( arg );
+
+    for (;;)
+    {
+        obtain_lock( &sysblk.mainsharelock );
+        if (sysblk.shutdown || !sysblk.mainshare || !sysblk.mainshareint)
+        {
+            sysblk.mainsharetid = 0;
+            release_lock( &sysblk.mainsharelock );
+            break;
+        }
+        release_lock( &sysblk.mainsharelock );
+
+        SLEEP( 1 );
+
+        if (++secs >= sysblk.mainshareint)
+        {
+            mainshare_scan();
+            secs = 0;
+        }
+    }
+
+    return NULL;
+}
+
+/*-------------------------------------------------------------------*/
+/* mainshare_set - enable or disable main storage page sharing       */
+/*-------------------------------------------------------------------*/
+/* 'interval' is the number of seconds between zero frame scans, 0   */
+/* to scan only on request.  Returns -1 with errno set if the host   */
+/* refused to merge main storage pages; zero frames are then still   */
+/* given back to the host.                                           */
+/*-------------------------------------------------------------------*/
+int mainshare_set( int enable, U32 interval )
+{
+    int  rc, err;
+
+    obtain_lock( &sysblk.mainsharelock );
+
+    sysblk.mainshare    = enable ? 1 : 0;
+    sysblk.mainshareint = enable ? interval : 0;
+
+    rc  = mainshare_advise( enable );
+    err = errno;
+
+    if (sysblk.mainshare && sysblk.mainshareint && !sysblk.mainsharetid)
+    {
+        if ((errno = create_thread( &sysblk.mainsharetid, DETACHED,
+                                    mainshare_thread, NULL, "mainshare" )))
+        {
+            // "Error in function create_thread(): %s"
+            WRMSG( HHC00102, "E", strerror( errno ));
+            sysblk.mainsharetid = 0;
+        }
+    }
+
+    release_lock( &sysblk.mainsharelock );
+
+    errno = err;
+    return rc;
+}
+
+/*-------------------------------------------------------------------*/
+/* mainshare_scan - give all-zero frames back to the host            */
+/*-------------------------------------------------------------------*/
+/* Returns the number of bytes newly given back to the host.         */
+/*-------------------------------------------------------------------*/
+U64 mainshare_scan()
+{
+    CPU_BITMAP  started_mask;
+    BYTE*       map;
+    U64         frames, frame, beg, n = 0, bytes = 0;
+    bool        busy;
+
+    obtain_lock( &sysblk.mainsharelock );
+
+    frames = sysblk.mainsize >> SHIFT_4K;
+
+    if (!sysblk.mainshare || !sysblk.mainstor
+        || (!(map = sysblk.mainsharemap)
+            && !(map = sysblk.mainsharemap = calloc( (size_t) frames, 1 ))))
+    {
+        release_lock( &sysblk.mainsharelock );
+        return 0;
+    }
+
+    /* First pass while the guest is running: frames that were zero
+     * the last time as well become candidates for being discarded.
+     */
+    for (frame = 0; frame < frames; frame++)
+    {
+        if (!frame_is_zero( sysblk.mainstor + (frame << SHIFT_4K) ))
+            map[ frame ] = 0;
+        else if ((map[ frame ] & (MS_ZERO | MS_DISCARDED)) == MS_ZERO)
+        {
+            map[ frame ] |= MS_CANDIDATE;
+            n++;
+        }
+        else
+            map[ frame ] |= MS_ZERO;
+    }
+
+    /* Second pass with the CPUs stopped.  A guest that is not running
+     * is left alone since its storage may be in the process of being
+     * loaded, and so is one with I/O in progress.
+     */
+    if (n)
+    {
+        sr_stop_cpus( &started_mask );
+
+        obtain_lock( &sysblk.ioqlock );
+        busy = sysblk.ioq != NULL;
+        release_lock( &sysblk.ioqlock );
+
+        busy = busy || !started_mask || sr_active_devices();
+
+        for (frame = 0; frame < frames; )
+        {
+            if (!(map[ frame ] & MS_CANDIDATE))
+            {
+                frame++;
+                continue;
+            }
+
+            for (beg = frame; frame < frames && (map[ frame ] & MS_CANDIDATE); frame++)
+            {
+                map[ frame ] &= ~MS_CANDIDATE;
+                if (busy || !frame_is_zero( sysblk.mainstor + (frame << SHIFT_4K) ))
+                    break;
+                map[ frame ] |= MS_DISCARDED;
+            }
+
+            if (frame > beg)
+                bytes += release_frames( beg << SHIFT_4K, (frame - beg) << SHIFT_4K );
+        }
+
+        sr_start_cpus( started_mask );
+    }
+
+    sysblk.zerobytes += bytes;
+
+    release_lock( &sysblk.mainsharelock );
+    return bytes;
+}
+
+/*-------------------------------------------------------------------*/
+/* Forget what the scans found since main storage was replaced       */
+/*-------------------------------------------------------------------*/
+static void mainshare_forget()  /* (with mainsharelock held) */
+{
+    free( sysblk.mainsharemap );
+    sysblk.mainsharemap = NULL;
+
+    if (sysblk.mainshare)
+        mainshare_advise( 1 );
+}
+
+/* (waits for a scan in progress to finish) */
+void mainshare_reset()
+{
+    obtain_lock( &sysblk.mainsharelock );
+    mainshare_forget();
+    release_lock( &sysblk.mainsharelock );
+}
+
 /*-------------------------------------------------------------------*/
 /* configure_xstorage - configure EXPANDED storage                   */
 /*-------------------------------------------------------------------*/
@@ -1095,6 +1783,8 @@ int configure_cpu( int target_cpu )
         if (arecpu)
             sysblk.regs[ ourcpu ]->intwait = false;
 
+        storshm_cpu( target_cpu );
+
 #if defined( FEATURE_011_CONFIG_TOPOLOGY_FACILITY )
         /* Set topology-change-report-pending condition */
         sysblk.topchnge = 1;
@@ -1159,6 +1849,8 @@ int deconfigure_cpu( int target_cpu )
         sysblk.cputid    [ target_cpu ] = 0;
         sysblk.cpuclockid[ target_cpu ] = 0;
 
+        storshm_cpu( target_cpu );
+
 #if defined( FEATURE_011_CONFIG_TOPOLOGY_FACILITY )
         /* Set topology-change-report-pending condition */
         sysblk.topchnge = 1;
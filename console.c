@@ -2846,7 +2846,17 @@ BYTE    buf[BUFLEN_1052];               /* Receive buffer            */
     dev->keybdrem -= 2;
 
     /* Translate the keyboard buffer to EBCDIC */
-    prt_host_to_guest( dev->buf, dev->buf, dev->keybdrem );
+    if (codepage_utf8())
+    {
+        BYTE     guest[ BUFLEN_1052 ];
+        CPSTATE  cps = {0};
+
+        dev->keybdrem = (int) cp_host_to_guest( &cps, dev->buf, dev->keybdrem,
+                                                guest, sizeof(guest), CP_CTL_DOT );
+        memcpy( dev->buf, guest, dev->keybdrem );
+    }
+    else
+        prt_host_to_guest( dev->buf, dev->buf, dev->keybdrem );
 
     /* Return attention status */
     return (CSW_ATTN);
@@ -4421,6 +4431,34 @@ BYTE    stat;                           /* Unit status               */
         num = (count < bufsize) ? count : bufsize;
         *residual = count - num;
 
+        if (codepage_utf8())
+        {
+            /* Translate data in channel buffer to UTF-8 */
+            BYTE     utf8[ BUFLEN_1052 * 3 + 2 ];
+            CPSTATE  cps = {0};
+
+            len = (U32) cp_guest_to_host( &cps, iobuf, num,
+                                          utf8, sizeof(utf8) - 1, 0 );
+
+            /* Perform end of record processing if not data-chaining */
+            if ((flags & CCW_FLAGS_CD) == 0 && code == 0x09)
+                utf8[len++] = '\n';
+            utf8[len] = 0;
+
+            /* Send the data to the client (via telnet_printf) */
+            if (!sendto_client( dev->tn, utf8, len ))
+            {
+                /* Return with Unit Check status if the send failed */
+                dev->sense[0] = SENSE_EC;
+                *unitstat = CSW_CE | CSW_DE | CSW_UC;
+                break;
+            }
+
+            /* Return normal status */
+            *unitstat = CSW_CE | CSW_DE;
+            break;
+        }
+
         /* Translate data in channel buffer to ASCII */
         for (len = 0; len < num; len++)
         {
@@ -4892,6 +4892,7 @@ RADR    n;                              /* Prefix value              */
 
         /* Load new value into prefix register */
         regs->PX = n;
+        storshm_cpu( regs->cpuad );
 
         /* Set pointer to active PSA structure */
         regs->psa = (PSA_3XX*)(regs->mainstor + regs->PX);
@@ -6203,6 +6204,7 @@ static char *ordername[] = {
 
             /* Load new value into prefix register of target CPU */
             tregs->PX = abs;
+            storshm_cpu( tregs->cpuad );
 
             /* Set pointer to active PSA structure */
             tregs->psa = (PSA_3XX*)(tregs->mainstor + tregs->PX);
@@ -1771,6 +1771,10 @@ cpustate_stopping:
 
         sysblk.started_mask |= regs->cpubit;
         regs->ints_state |= sysblk.ints_state;
+
+        /* Injected machine check still pending */
+        if (regs->mckcode)
+            ON_IC_MCK( regs, mck_subclass( regs->mckcode ));
         set_cpu_timer(regs,saved_timer);
 
         ON_IC_INTERRUPT(regs);
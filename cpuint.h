@@ -12,45 +12,47 @@
  Floating interrupts are made pending to all CPUs, and are
  recorded in the sysblk structure, CPU specific interrupts
  are recorded in the regs structure.
- hi0m mmmm pppp p00p xxxx xxxx xxxx h0hs : type U32
- || | |||| |||| |--| |||| |||| |||| |-||   h:mask  is always '1'
- || | |||| |||| |  | |||| |||| |||| | ||   s:state is always '1'
- || | |||| |||| |  | |||| |||| |||| | |+--> '1' : PSW_WAIT
- || | |||| |||| |  | |||| |||| |||| | +---> '1' : RESTART
- || | |||| |||| |  | |||| |||| |||| |             (available)
- || | |||| |||| |  | |||| |||| |||| +-----> '1' : STORSTAT
- || | |||| |||| |  | |||| |||| ||||
- || | |||| |||| |  | |||| |||| |||+-------> '1' : ETR
- || | |||| |||| |  | |||| |||| ||+--------> '1' : EXTSIG
- || | |||| |||| |  | |||| |||| |+---------> '1' : INTKEY
- || | |||| |||| |  | |||| |||| +----------> '1' : ITIMER
- || | |||| |||| |  | |||| ||||
- || | |||| |||| |  | |||| |||+------------> '1' : ECPS VTIMER
- || | |||| |||| |  | |||| ||+-------------> '1' : SERVSIG
- || | |||| |||| |  | |||| |+--------------> '1' : PTIMER
- || | |||| |||| |  | |||| +---------------> '1' : CLKC
- || | |||| |||| |  | ||||
- || | |||| |||| |  | |||+-----------------> '1' : TODSYNC
- || | |||| |||| |  | ||+------------------> '1' : EXTCALL
- || | |||| |||| |  | |+-------------------> '1' : EMERSIG
- || | |||| |||| |  | +--------------------> '1' : MALFALT
- || | |||| |||| |  |
- || | |||| |||| |  +----------------------> '1' : PER IFNUL
- || | |||| |||| |
- || | |||| |||| |
- || | |||| |||| +-------------------------> '1' : PER STURA
- || | |||| ||||
- || | |||| |||+---------------------------> '1' : PER GRA
- || | |||| ||+----------------------------> '1' : PER SA
- || | |||| |+-----------------------------> '1' : PER IF
- || | |||| +------------------------------> '1' : PER SB
- || | ||||
- || | |||+--------------------------------> '1' : WARNING
- || | ||+---------------------------------> '1' : XDMGRPT
- || | |+----------------------------------> '1' : DGRDRPT
- || | +-----------------------------------> '1' : RCVYRPT
- || |
- || +-------------------------------------> '1' : CHANRPT
+ himm mmmm pppp p00p xxxx xxxx xxxx h0hs : type U32
+ |||| |||| |||| |--| |||| |||| |||| |-||   h:mask  is always '1'
+ |||| |||| |||| |  | |||| |||| |||| | ||   s:state is always '1'
+ |||| |||| |||| |  | |||| |||| |||| | |+--> '1' : PSW_WAIT
+ |||| |||| |||| |  | |||| |||| |||| | +---> '1' : RESTART
+ |||| |||| |||| |  | |||| |||| |||| |             (available)
+ |||| |||| |||| |  | |||| |||| |||| +-----> '1' : STORSTAT
+ |||| |||| |||| |  | |||| |||| ||||
+ |||| |||| |||| |  | |||| |||| |||+-------> '1' : ETR
+ |||| |||| |||| |  | |||| |||| ||+--------> '1' : EXTSIG
+ |||| |||| |||| |  | |||| |||| |+---------> '1' : INTKEY
+ |||| |||| |||| |  | |||| |||| +----------> '1' : ITIMER
+ |||| |||| |||| |  | |||| ||||
+ |||| |||| |||| |  | |||| |||+------------> '1' : ECPS VTIMER
+ |||| |||| |||| |  | |||| ||+-------------> '1' : SERVSIG
+ |||| |||| |||| |  | |||| |+--------------> '1' : PTIMER
+ |||| |||| |||| |  | |||| +---------------> '1' : CLKC
+ |||| |||| |||| |  | ||||
+ |||| |||| |||| |  | |||+-----------------> '1' : TODSYNC
+ |||| |||| |||| |  | ||+------------------> '1' : EXTCALL
+ |||| |||| |||| |  | |+-------------------> '1' : EMERSIG
+ |||| |||| |||| |  | +--------------------> '1' : MALFALT
+ |||| |||| |||| |  |
+ |||| |||| |||| |  +----------------------> '1' : PER IFNUL
+ |||| |||| |||| |
+ |||| |||| |||| |
+ |||| |||| |||| +-------------------------> '1' : PER STURA
+ |||| |||| ||||
+ |||| |||| |||+---------------------------> '1' : PER GRA
+ |||| |||| ||+----------------------------> '1' : PER SA
+ |||| |||| |+-----------------------------> '1' : PER IF
+ |||| |||| +------------------------------> '1' : PER SB
+ |||| ||||
+ |||| |||+--------------------------------> '1' : WARNING
+ |||| ||+---------------------------------> '1' : XDMGRPT
+ |||| |+----------------------------------> '1' : DGRDRPT
+ |||| +-----------------------------------> '1' : RCVYRPT
+ ||||
+ |||+-------------------------------------> '1' : CHANRPT
+ |||
+ ||+--------------------------------------> '1' : MCKEXIG
  ||
  |+---------------------------------------> '1' : IO
  +----------------------------------------> '1' : INTERRUPT possible
@@ -83,7 +85,7 @@
 /* Interrupt bit numbers */
 #define IC_INTERRUPT       31 /* 0x80000000 */
 #define IC_IO              30 /* 0x40000000 */
-#define IC_UNUSED_29       29 /* 0x20000000 */
+#define IC_MCKEXIG         29 /* 0x20000000 - Exigent machine check       */
 #define IC_CHANRPT         28 /* 0x10000000 - Architecture dependent (CR14) */
 #define IC_RCVYRPT         27 /* 0x08000000 - Architecture dependent (CR14) */
 #define IC_DGRDRPT         26 /* 0x04000000 - Architecture dependent (CR14) */
@@ -161,14 +163,19 @@
                          | BIT(IC_ETR) \
                          )
 
-/* Machine check subclasses */
-#define IC_MCKPENDING    ( BIT(IC_CHANRPT) \
+/* Machine check subclasses in CR 14 */
+#define IC_MCK_SCM_CR14  ( BIT(IC_CHANRPT) \
                          | BIT(IC_RCVYRPT) \
                          | BIT(IC_DGRDRPT) \
                          | BIT(IC_XDMGRPT) \
                          | BIT(IC_WARNING) \
                          )
 
+/* Machine check subclasses; exigent conditions have no CR 14 mask */
+#define IC_MCKPENDING    ( BIT(IC_MCKEXIG) \
+                         | IC_MCK_SCM_CR14 \
+                         )
+
 /* Not disabled mask */
 #define IC_OPEN_MASK     ( IC_MCKPENDING \
                          | IC_EXTPENDING \
@@ -218,7 +225,7 @@
      ? ( ((_regs)->psw.sysmask & PSW_IOMASK) ? BIT(IC_IO) : 0 ) \
      : ( ((_regs)->psw.sysmask & 0xFE) ? BIT(IC_IO) : 0 ) \
    ) \
- | ( MACHMASK(&(_regs)->psw) ? ((_regs)->CR(14) & IC_MCKPENDING) : 0 ) \
+ | ( MACHMASK(&(_regs)->psw) ? (BIT(IC_MCKEXIG) | ((_regs)->CR(14) & IC_MCK_SCM_CR14)) : 0 ) \
  | ( PER_MODE((_regs)) ? ((_regs)->ints_mask & IC_PER_MASK) : 0 ) \
  | ( ((_regs)->psw.sysmask & PSW_EXTMASK) ? (IC_CR0_TO_INTMASK((_regs))) : 0 ) \
  | ( WAITSTATE(&(_regs)->psw) ? BIT(IC_PSW_WAIT) : 0 ) \
@@ -227,7 +234,7 @@
 #define IC_ECMODE_MASK(_regs) \
  ( ( IC_INITIAL_MASK ) \
  | ( ((_regs)->psw.sysmask & PSW_IOMASK) ? BIT(IC_IO) : 0 ) \
- | ( MACHMASK(&(_regs)->psw) ? ((_regs)->CR(14) & IC_MCKPENDING) : 0 ) \
+ | ( MACHMASK(&(_regs)->psw) ? (BIT(IC_MCKEXIG) | ((_regs)->CR(14) & IC_MCK_SCM_CR14)) : 0 ) \
  | ( PER_MODE((_regs)) ? ((_regs)->ints_mask & IC_PER_MASK) : 0 ) \
  | ( ((_regs)->psw.sysmask & PSW_EXTMASK) ? (IC_CR0_TO_INTMASK((_regs))) : 0 ) \
  | ( WAITSTATE(&(_regs)->psw) ? BIT(IC_PSW_WAIT) : 0 ) \
@@ -236,7 +243,7 @@
 #define IC_BCMODE_MASK(_regs) \
  ( ( IC_INITIAL_MASK ) \
  | ( ((_regs)->psw.sysmask & 0xFE) ? BIT(IC_IO) : 0 ) \
- | ( MACHMASK(&(_regs)->psw) ? ((_regs)->CR(14) & IC_MCKPENDING) : 0 ) \
+ | ( MACHMASK(&(_regs)->psw) ? (BIT(IC_MCKEXIG) | ((_regs)->CR(14) & IC_MCK_SCM_CR14)) : 0 ) \
  | ( PER_MODE((_regs)) ? ((_regs)->ints_mask & IC_PER_MASK) : 0 ) \
  | ( ((_regs)->psw.sysmask & PSW_EXTMASK) ? (IC_CR0_TO_INTMASK((_regs))) : 0 ) \
  | ( WAITSTATE(&(_regs)->psw) ? BIT(IC_PSW_WAIT) : 0 ) \
@@ -434,6 +441,14 @@
      (_regs)->ints_state |= BIT(IC_EXTCALL); \
  } while (0)
 
+#define ON_IC_MCK(_regs, _bits) \
+ do { \
+   if ( (_regs)->ints_mask & (_bits) ) \
+     (_regs)->ints_state |= BIT(IC_INTERRUPT) | (_bits); \
+   else \
+     (_regs)->ints_state |= (_bits); \
+ } while (0)
+
 #define ON_IC_MALFALT(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_MALFALT) ) \
@@ -587,6 +602,11 @@
    (_regs)->ints_state &= ~BIT(IC_EXTCALL); \
  } while (0)
 
+#define OFF_IC_MCK(_regs) \
+ do { \
+   (_regs)->ints_state &= ~(IC_MCKPENDING & ~BIT(IC_CHANRPT)); \
+ } while (0)
+
 #define OFF_IC_MALFALT(_regs) \
  do { \
    (_regs)->ints_state &= ~BIT(IC_MALFALT); \
@@ -2448,6 +2448,11 @@ int     ix = TLBIX(addr);               /* TLB index                 */
     /* Save ptr to storage key for this translated logical address */
     regs->dat.storkey = ARCH_DEP( get_ptr_to_storekey )( aaddr );
 
+    /* Machine check if the frame is set up for machine check injection */
+    if (unlikely( sysblk.mckframes && (*regs->dat.storkey & STORKEY_BADFRM)
+               && !SIE_MODE( regs ) ))
+        ARCH_DEP( mck_bad_frame )( regs, aaddr );
+
 #if defined( _FEATURE_SIE )
     /* Do not apply host key access when SIE fetches/stores data */
     if (unlikely(SIE_ACTIVE(regs)))
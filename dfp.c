@@ -25,6 +25,7 @@
 #include "decimal64.h"
 #include "decimal32.h"
 #include "decPacked.h"
+#include "decDouble.h"
 #endif
 
 DISABLE_GCC_UNUSED_SET_WARNING;
@@ -490,53 +491,6 @@ int             cc;                     /* Condition code            */
     return cc;
 } /* end function dfp_compare_exponent */
 
-/*-------------------------------------------------------------------*/
-/* Convert 64-bit signed binary integer to decimal number            */
-/*                                                                   */
-/* This subroutine is called by the CDGTR and CXGTR instructions.    */
-/* It converts a 64-bit signed binary integer value into a           */
-/* decimal number structure. The inexact condition will be set       */
-/* in the decimal context structure if the number is rounded to      */
-/* fit the maximum number of digits specified in the context.        */
-/*                                                                   */
-/* Input:                                                            */
-/*      dn      Pointer to decimal number structure                  */
-/*      n       64-bit signed binary integer value                   */
-/*      pset    Pointer to decimal number context structure          */
-/* Output:                                                           */
-/*      The decimal number structure is updated.                     */
-/*-------------------------------------------------------------------*/
-static void
-dfp_number_from_fix64(decNumber *dn, S64 n, decContext *pset)
-{
-int             sign = 0;               /* Sign of binary integer    */
-int             i;                      /* Counter                   */
-char            zoned[32];              /* Zoned decimal work area   */
-static char     maxnegzd[]="-9223372036854775808";
-static U64      maxneg64 = 0x8000000000000000ULL;
-
-    /* Handle maximum negative number as special case */
-    if (n == (S64)maxneg64)
-    {
-        decNumberFromString(dn, maxnegzd, pset);
-        return;
-    }
-
-    /* Convert binary value to zoned decimal */
-    if (n < 0) { n = -n; sign = 1; }
-    i = sizeof(zoned) - 1;
-    zoned[i] = '\0';
-    do {
-        zoned[--i] = (n % 10) + '0';
-        n /= 10;
-    } while(i > 1 && n > 0);
-    if (sign) zoned[--i] = '-';
-
-    /* Convert zoned decimal value to decimal number structure */
-    decNumberFromString(dn, zoned+i, pset);
-
-} /* end function dfp_number_from_fix64 */
-
 /*-------------------------------------------------------------------*/
 /* Convert decimal number to 64-bit signed binary integer            */
 /*                                                                   */
@@ -825,6 +779,393 @@ int             exp;                    /* Adjusted exponent         */
 
 } /* end function dfp_test_data_group */
 
+/*-------------------------------------------------------------------*/
+/* Fixed-size decimal arithmetic                                     */
+/*                                                                   */
+/* The arithmetic, compare, quantize and 64-bit fixed point          */
+/* conversion instructions use the decDouble and decQuad functions   */
+/* of the decNumber library when their operands are finite.  These   */
+/* work directly on the encoded 64-bit and 128-bit values (which     */
+/* have the same layout as the decimal64 and decimal128 structures   */
+/* holding the register contents) rather than expanding them into    */
+/* decNumber structures and encoding the result again, which is      */
+/* several times faster.  Infinities and NaNs, which need the        */
+/* architected handling of their payloads, still take the decNumber  */
+/* path.  Both paths give the same results and conditions.           */
+/*-------------------------------------------------------------------*/
+#define DFP_ADD         0               /* Add                       */
+#define DFP_SUBTRACT    1               /* Subtract                  */
+#define DFP_MULTIPLY    2               /* Multiply                  */
+#define DFP_DIVIDE      3               /* Divide                    */
+#define DFP_QUANTIZE    4               /* Quantize                  */
+
+#define DFP_DOUBLE(xp)  ((decDouble*)(xp))
+#define DFP_QUAD(xp)    ((decQuad*)(xp))
+
+/*-------------------------------------------------------------------*/
+/* Adjust the status after a decDouble or decQuad operation          */
+/*                                                                   */
+/* decNumber indicates Rounded with every inexact result, which the  */
+/* decDouble and decQuad functions do not, and dfp_status_check      */
+/* uses it to select the DXC.                                        */
+/*-------------------------------------------------------------------*/
+static inline void
+dfp_fixed_status(decContext *pset)
+{
+    if (pset->status & DEC_Inexact)
+        pset->status |= DEC_Rounded;
+
+} /* end function dfp_fixed_status */
+
+/*-------------------------------------------------------------------*/
+/* Perform a long or extended DFP arithmetic operation               */
+/*                                                                   */
+/* Input:                                                            */
+/*      op      DFP_ADD, DFP_SUBTRACT, DFP_MULTIPLY, DFP_DIVIDE or   */
+/*              DFP_QUANTIZE                                         */
+/*      x1      Pointer to decimal64/128 structure for the result    */
+/*      x2,x3   Pointers to decimal64/128 structures for the first   */
+/*              and second operands (for DFP_QUANTIZE, the value to  */
+/*              be quantized and the value with the new exponent)    */
+/*      pset    Pointer to decimal number context structure          */
+/* Output:                                                           */
+/*      The result structure and the context status are updated.    */
+/*-------------------------------------------------------------------*/
+static void
+dfp64_operation(int op, decimal64 *x1, decimal64 *x2, decimal64 *x3,
+                decContext *pset)
+{
+decNumber       d1, d2, d3;             /* Working decimal numbers   */
+
+    if (decDoubleIsFinite(DFP_DOUBLE(x2))
+     && decDoubleIsFinite(DFP_DOUBLE(x3)))
+    {
+        switch (op) {
+        case DFP_ADD:
+            decDoubleAdd(DFP_DOUBLE(x1), DFP_DOUBLE(x2), DFP_DOUBLE(x3), pset);
+            break;
+        case DFP_SUBTRACT:
+            decDoubleSubtract(DFP_DOUBLE(x1), DFP_DOUBLE(x2), DFP_DOUBLE(x3), pset);
+            break;
+        case DFP_MULTIPLY:
+            decDoubleMultiply(DFP_DOUBLE(x1), DFP_DOUBLE(x2), DFP_DOUBLE(x3), pset);
+            break;
+        case DFP_DIVIDE:
+            decDoubleDivide(DFP_DOUBLE(x1), DFP_DOUBLE(x2), DFP_DOUBLE(x3), pset);
+            break;
+        case DFP_QUANTIZE:
+            decDoubleQuantize(DFP_DOUBLE(x1), DFP_DOUBLE(x2), DFP_DOUBLE(x3), pset);
+            break;
+        } /* end switch(op) */
+
+        dfp_fixed_status(pset);
+        return;
+    }
+
+    decimal64ToNumber(x2, &d2);
+    decimal64ToNumber(x3, &d3);
+
+    switch (op) {
+    case DFP_ADD:      decNumberAdd(&d1, &d2, &d3, pset); break;
+    case DFP_SUBTRACT: decNumberSubtract(&d1, &d2, &d3, pset); break;
+    case DFP_MULTIPLY: decNumberMultiply(&d1, &d2, &d3, pset); break;
+    case DFP_DIVIDE:   decNumberDivide(&d1, &d2, &d3, pset); break;
+    case DFP_QUANTIZE: decNumberQuantize(&d1, &d2, &d3, pset); break;
+    } /* end switch(op) */
+
+    decimal64FromNumber(x1, &d1, pset);
+
+} /* end function dfp64_operation */
+
+static void
+dfp128_operation(int op, decimal128 *x1, decimal128 *x2, decimal128 *x3,
+                 decContext *pset)
+{
+decNumber       d1, d2, d3;             /* Working decimal numbers   */
+
+    if (decQuadIsFinite(DFP_QUAD(x2))
+     && decQuadIsFinite(DFP_QUAD(x3)))
+    {
+        switch (op) {
+        case DFP_ADD:
+            decQuadAdd(DFP_QUAD(x1), DFP_QUAD(x2), DFP_QUAD(x3), pset);
+            break;
+        case DFP_SUBTRACT:
+            decQuadSubtract(DFP_QUAD(x1), DFP_QUAD(x2), DFP_QUAD(x3), pset);
+            break;
+        case DFP_MULTIPLY:
+            decQuadMultiply(DFP_QUAD(x1), DFP_QUAD(x2), DFP_QUAD(x3), pset);
+            break;
+        case DFP_DIVIDE:
+            decQuadDivide(DFP_QUAD(x1), DFP_QUAD(x2), DFP_QUAD(x3), pset);
+            break;
+        case DFP_QUANTIZE:
+            decQuadQuantize(DFP_QUAD(x1), DFP_QUAD(x2), DFP_QUAD(x3), pset);
+            break;
+        } /* end switch(op) */
+
+        dfp_fixed_status(pset);
+        return;
+    }
+
+    decimal128ToNumber(x2, &d2);
+    decimal128ToNumber(x3, &d3);
+
+    switch (op) {
+    case DFP_ADD:      decNumberAdd(&d1, &d2, &d3, pset); break;
+    case DFP_SUBTRACT: decNumberSubtract(&d1, &d2, &d3, pset); break;
+    case DFP_MULTIPLY: decNumberMultiply(&d1, &d2, &d3, pset); break;
+    case DFP_DIVIDE:   decNumberDivide(&d1, &d2, &d3, pset); break;
+    case DFP_QUANTIZE: decNumberQuantize(&d1, &d2, &d3, pset); break;
+    } /* end switch(op) */
+
+    decimal128FromNumber(x1, &d1, pset);
+
+} /* end function dfp128_operation */
+
+/*-------------------------------------------------------------------*/
+/* Return the condition code for a long or extended DFP result       */
+/*-------------------------------------------------------------------*/
+static inline int
+dfp64_result_cc(decimal64 *xp)
+{
+    return decDoubleIsNaN(DFP_DOUBLE(xp)) ? 3 :
+           decDoubleIsZero(DFP_DOUBLE(xp)) ? 0 :
+           decDoubleIsNegative(DFP_DOUBLE(xp)) ? 1 : 2;
+
+} /* end function dfp64_result_cc */
+
+static inline int
+dfp128_result_cc(decimal128 *xp)
+{
+    return decQuadIsNaN(DFP_QUAD(xp)) ? 3 :
+           decQuadIsZero(DFP_QUAD(xp)) ? 0 :
+           decQuadIsNegative(DFP_QUAD(xp)) ? 1 : 2;
+
+} /* end function dfp128_result_cc */
+
+/*-------------------------------------------------------------------*/
+/* Compare two long or extended DFP values                           */
+/*                                                                   */
+/* Input:                                                            */
+/*      x1,x2   Pointers to decimal64/128 structures to be compared  */
+/*      pset    Pointer to decimal number context structure          */
+/* Output:                                                           */
+/*      The return value is the condition code (0=equal, 1=first     */
+/*      operand low, 2=first operand high, 3=unordered).  The        */
+/*      context status indicates an invalid operation for an SNaN.   */
+/*-------------------------------------------------------------------*/
+static int
+dfp64_compare(decimal64 *x1, decimal64 *x2, decContext *pset)
+{
+decimal64       xr;                     /* Comparison result         */
+decNumber       d1, d2, dr;             /* Working decimal numbers   */
+
+    if (decDoubleIsFinite(DFP_DOUBLE(x1))
+     && decDoubleIsFinite(DFP_DOUBLE(x2)))
+    {
+        decDoubleCompare(DFP_DOUBLE(&xr), DFP_DOUBLE(x1), DFP_DOUBLE(x2), pset);
+        return dfp64_result_cc(&xr);
+    }
+
+    decimal64ToNumber(x1, &d1);
+    decimal64ToNumber(x2, &d2);
+    decNumberCompare(&dr, &d1, &d2, pset);
+
+    return decNumberIsNaN(&dr) ? 3 :
+           decNumberIsZero(&dr) ? 0 :
+           decNumberIsNegative(&dr) ? 1 : 2;
+
+} /* end function dfp64_compare */
+
+static int
+dfp128_compare(decimal128 *x1, decimal128 *x2, decContext *pset)
+{
+decimal128      xr;                     /* Comparison result         */
+decNumber       d1, d2, dr;             /* Working decimal numbers   */
+
+    if (decQuadIsFinite(DFP_QUAD(x1))
+     && decQuadIsFinite(DFP_QUAD(x2)))
+    {
+        decQuadCompare(DFP_QUAD(&xr), DFP_QUAD(x1), DFP_QUAD(x2), pset);
+        return dfp128_result_cc(&xr);
+    }
+
+    decimal128ToNumber(x1, &d1);
+    decimal128ToNumber(x2, &d2);
+    decNumberCompare(&dr, &d1, &d2, pset);
+
+    return decNumberIsNaN(&dr) ? 3 :
+           decNumberIsZero(&dr) ? 0 :
+           decNumberIsNegative(&dr) ? 1 : 2;
+
+} /* end function dfp128_compare */
+
+/*-------------------------------------------------------------------*/
+/* Convert 64-bit signed binary integer to long or extended DFP      */
+/*                                                                   */
+/* This subroutine is called by the CDGTR and CXGTR instructions.    */
+/* The integer is converted exactly into a decQuad, which is then    */
+/* rounded to long DFP according to the context if necessary.        */
+/*                                                                   */
+/* Input:                                                            */
+/*      xp      Pointer to decimal64/128 structure for the result    */
+/*      n       64-bit signed binary integer value                   */
+/*      pset    Pointer to decimal number context structure (long)   */
+/* Output:                                                           */
+/*      The decimal64/128 structure and the context status are       */
+/*      updated.                                                     */
+/*-------------------------------------------------------------------*/
+static void
+dfp128_from_fix64(decimal128 *xp, S64 n)
+{
+U64             u;                      /* Magnitude of the integer  */
+uint8_t         bcd[DECQUAD_Pmax];      /* One digit per byte        */
+int             i;                      /* Array subscript           */
+
+    u = (n < 0) ? (U64)0 - (U64)n : (U64)n;
+
+    for (i = DECQUAD_Pmax - 1; i >= 0; i--)
+    {
+        bcd[i] = (uint8_t)(u % 10);
+        u /= 10;
+    }
+
+    decQuadFromBCD(DFP_QUAD(xp), 0, bcd, (n < 0) ? DECFLOAT_Sign : 0);
+
+} /* end function dfp128_from_fix64 */
+
+static void
+dfp64_from_fix64(decimal64 *xp, S64 n, decContext *pset)
+{
+decimal128      xq;                     /* Exact extended value      */
+
+    dfp128_from_fix64(&xq, n);
+    decDoubleFromWider(DFP_DOUBLE(xp), DFP_QUAD(&xq), pset);
+    dfp_fixed_status(pset);
+
+} /* end function dfp64_from_fix64 */
+
+/*-------------------------------------------------------------------*/
+/* Build a 64-bit signed binary integer from decimal digits          */
+/*                                                                   */
+/* Input:                                                            */
+/*      np      Pointer to the 64-bit signed binary integer result   */
+/*      bcd     Coefficient digits, one per byte                     */
+/*      digits  Number of coefficient digits                         */
+/*      exp     Exponent (zero or more) of the integer value         */
+/*      neg     1 if the integer value is negative                   */
+/* Return value:                                                     */
+/*      0=Success, -1=Value outside the range of a 64-bit integer    */
+/*-------------------------------------------------------------------*/
+static int
+dfp_bcd_to_fix64(S64 *np, const uint8_t *bcd, int digits, int32_t exp,
+                 int neg)
+{
+U64             u = 0;                  /* Magnitude of the integer  */
+U64             max;                    /* Maximum magnitude         */
+int             i;                      /* Array subscript           */
+
+    max = neg ? 0x8000000000000000ULL : 0x7FFFFFFFFFFFFFFFULL;
+
+    for (i = 0; i < digits + exp; i++)
+    {
+        if (u > (max - (i < digits ? bcd[i] : 0)) / 10)
+            return -1;
+        u = u * 10 + (i < digits ? bcd[i] : 0);
+    }
+
+    *np = neg ? (S64)((U64)0 - u) : (S64)u;
+    return 0;
+
+} /* end function dfp_bcd_to_fix64 */
+
+/*-------------------------------------------------------------------*/
+/* Convert long or extended DFP to 64-bit signed binary integer      */
+/*                                                                   */
+/* This subroutine is called by the CGDTR and CGXTR instructions.    */
+/* A finite value is rounded to an integer according to the context */
+/* and converted from its coefficient digits.  Values outside the    */
+/* range of a 64-bit integer, infinities and NaNs are converted by   */
+/* dfp_number_to_fix64.  The conditions are the same as there.       */
+/*                                                                   */
+/* Input:                                                            */
+/*      xp      Pointer to decimal64/128 structure                   */
+/*      pset    Pointer to decimal number context structure          */
+/* Output:                                                           */
+/*      The return value is the 64-bit signed binary integer result  */
+/*-------------------------------------------------------------------*/
+static S64
+dfp64_to_fix64(decimal64 *xp, decContext *pset)
+{
+S64             n;                      /* 64-bit signed result      */
+decimal64       xi, xc;                 /* Integer value, comparison */
+uint8_t         bcd[DECDOUBLE_Pmax];    /* Coefficient digits        */
+int32_t         exp;                    /* Exponent of integer value */
+int             neg;                    /* 1=value is negative       */
+decNumber       d;                      /* Working decimal number    */
+
+    if (decDoubleIsFinite(DFP_DOUBLE(xp)))
+    {
+        /* Round to an integer, whose exponent is zero or more */
+        decDoubleToIntegralValue(DFP_DOUBLE(&xi), DFP_DOUBLE(xp), pset, pset->round);
+        neg = decDoubleToBCD(DFP_DOUBLE(&xi), &exp, bcd) ? 1 : 0;
+
+        if (dfp_bcd_to_fix64(&n, bcd, DECDOUBLE_Pmax, exp, neg) == 0)
+        {
+            /* Raise inexact condition if result was rounded */
+            decDoubleCompare(DFP_DOUBLE(&xc), DFP_DOUBLE(&xi), DFP_DOUBLE(xp), pset);
+            if (!decDoubleIsZero(DFP_DOUBLE(&xc)))
+            {
+                pset->status |= DEC_IEEE_854_Inexact;
+                if (decDoubleIsNegative(DFP_DOUBLE(&xc)) == decDoubleIsSigned(DFP_DOUBLE(xp)))
+                    pset->status |= DEC_Rounded;
+            }
+            return n;
+        }
+    }
+
+    decimal64ToNumber(xp, &d);
+    return dfp_number_to_fix64(&d, pset);
+
+} /* end function dfp64_to_fix64 */
+
+static S64
+dfp128_to_fix64(decimal128 *xp, decContext *pset)
+{
+S64             n;                      /* 64-bit signed result      */
+decimal128      xi, xc;                 /* Integer value, comparison */
+uint8_t         bcd[DECQUAD_Pmax];      /* Coefficient digits        */
+int32_t         exp;                    /* Exponent of integer value */
+int             neg;                    /* 1=value is negative       */
+decNumber       d;                      /* Working decimal number    */
+
+    if (decQuadIsFinite(DFP_QUAD(xp)))
+    {
+        /* Round to an integer, whose exponent is zero or more */
+        decQuadToIntegralValue(DFP_QUAD(&xi), DFP_QUAD(xp), pset, pset->round);
+        neg = decQuadToBCD(DFP_QUAD(&xi), &exp, bcd) ? 1 : 0;
+
+        if (dfp_bcd_to_fix64(&n, bcd, DECQUAD_Pmax, exp, neg) == 0)
+        {
+            /* Raise inexact condition if result was rounded */
+            decQuadCompare(DFP_QUAD(&xc), DFP_QUAD(&xi), DFP_QUAD(xp), pset);
+            if (!decQuadIsZero(DFP_QUAD(&xc)))
+            {
+                pset->status |= DEC_IEEE_854_Inexact;
+                if (decQuadIsNegative(DFP_QUAD(&xc)) == decQuadIsSigned(DFP_QUAD(xp)))
+                    pset->status |= DEC_Rounded;
+            }
+            return n;
+        }
+    }
+
+    decimal128ToNumber(xp, &d);
+    return dfp_number_to_fix64(&d, pset);
+
+} /* end function dfp128_to_fix64 */
+
+
 #define _DFP_ARCH_INDEPENDENT_
 #endif /*!defined(_DFP_ARCH_INDEPENDENT_)*/
 
@@ -1765,7 +2106,6 @@ DEF_INST(add_dfp_ext_reg)
 {
 int             r1, r2, r3;             /* Values of R fields        */
 decimal128      x1, x2, x3;             /* Extended DFP values       */
-decNumber       d1, d2, d3;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
 
@@ -1782,10 +2122,7 @@ BYTE            dxc;                    /* Data exception code       */
     /* Add FP register r3 to FP register r2 */
     ARCH_DEP(dfp_reg_to_decimal128)(r2, &x2, regs);
     ARCH_DEP(dfp_reg_to_decimal128)(r3, &x3, regs);
-    decimal128ToNumber(&x2, &d2);
-    decimal128ToNumber(&x3, &d3);
-    decNumberAdd(&d1, &d2, &d3, &set);
-    decimal128FromNumber(&x1, &d1, &set);
+    dfp128_operation(DFP_ADD, &x1, &x2, &x3, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
@@ -1794,9 +2131,7 @@ BYTE            dxc;                    /* Data exception code       */
     ARCH_DEP(dfp_reg_from_decimal128)(r1, &x1, regs);
 
     /* Set condition code */
-    regs->psw.cc = decNumberIsNaN(&d1) ? 3 :
-                   decNumberIsZero(&d1) ? 0 :
-                   decNumberIsNegative(&d1) ? 1 : 2;
+    regs->psw.cc = dfp128_result_cc(&x1);
 
     /* Raise data exception if error occurred */
     if (dxc != 0)
@@ -1815,7 +2150,6 @@ DEF_INST(add_dfp_long_reg)
 {
 int             r1, r2, r3;             /* Values of R fields        */
 decimal64       x1, x2, x3;             /* Long DFP values           */
-decNumber       d1, d2, d3;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
 
@@ -1831,10 +2165,7 @@ BYTE            dxc;                    /* Data exception code       */
     /* Add FP register r3 to FP register r2 */
     ARCH_DEP(dfp_reg_to_decimal64)(r2, &x2, regs);
     ARCH_DEP(dfp_reg_to_decimal64)(r3, &x3, regs);
-    decimal64ToNumber(&x2, &d2);
-    decimal64ToNumber(&x3, &d3);
-    decNumberAdd(&d1, &d2, &d3, &set);
-    decimal64FromNumber(&x1, &d1, &set);
+    dfp64_operation(DFP_ADD, &x1, &x2, &x3, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
@@ -1843,9 +2174,7 @@ BYTE            dxc;                    /* Data exception code       */
     ARCH_DEP(dfp_reg_from_decimal64)(r1, &x1, regs);
 
     /* Set condition code */
-    regs->psw.cc = decNumberIsNaN(&d1) ? 3 :
-                   decNumberIsZero(&d1) ? 0 :
-                   decNumberIsNegative(&d1) ? 1 : 2;
+    regs->psw.cc = dfp64_result_cc(&x1);
 
     /* Raise data exception if error occurred */
     if (dxc != 0)
@@ -1864,9 +2193,9 @@ DEF_INST(compare_dfp_ext_reg)
 {
 int             r1, r2;                 /* Values of R fields        */
 decimal128      x1, x2;                 /* Extended DFP values       */
-decNumber       d1, d2, dr;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
+int             cc;                     /* Condition code            */
 
     RRE(inst, regs, r1, r2);
 
@@ -1880,17 +2209,13 @@ BYTE            dxc;                    /* Data exception code       */
     /* Compare FP register r1 with FP register r2 */
     ARCH_DEP(dfp_reg_to_decimal128)(r1, &x1, regs);
     ARCH_DEP(dfp_reg_to_decimal128)(r2, &x2, regs);
-    decimal128ToNumber(&x1, &d1);
-    decimal128ToNumber(&x2, &d2);
-    decNumberCompare(&dr, &d1, &d2, &set);
+    cc = dfp128_compare(&x1, &x2, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
 
     /* Set condition code */
-    regs->psw.cc = decNumberIsNaN(&dr) ? 3 :
-                   decNumberIsZero(&dr) ? 0 :
-                   decNumberIsNegative(&dr) ? 1 : 2;
+    regs->psw.cc = cc;
 
     /* Raise data exception if error occurred */
     if (dxc != 0)
@@ -1909,9 +2234,9 @@ DEF_INST(compare_dfp_long_reg)
 {
 int             r1, r2;                 /* Values of R fields        */
 decimal64       x1, x2;                 /* Long DFP values           */
-decNumber       d1, d2, dr;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
+int             cc;                     /* Condition code            */
 
     RRE(inst, regs, r1, r2);
 
@@ -1924,17 +2249,13 @@ BYTE            dxc;                    /* Data exception code       */
     /* Compare FP register r1 with FP register r2 */
     ARCH_DEP(dfp_reg_to_decimal64)(r1, &x1, regs);
     ARCH_DEP(dfp_reg_to_decimal64)(r2, &x2, regs);
-    decimal64ToNumber(&x1, &d1);
-    decimal64ToNumber(&x2, &d2);
-    decNumberCompare(&dr, &d1, &d2, &set);
+    cc = dfp64_compare(&x1, &x2, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
 
     /* Set condition code */
-    regs->psw.cc = decNumberIsNaN(&dr) ? 3 :
-                   decNumberIsZero(&dr) ? 0 :
-                   decNumberIsNegative(&dr) ? 1 : 2;
+    regs->psw.cc = cc;
 
     /* Raise data exception if error occurred */
     if (dxc != 0)
@@ -1953,9 +2274,9 @@ DEF_INST(compare_and_signal_dfp_ext_reg)
 {
 int             r1, r2;                 /* Values of R fields        */
 decimal128      x1, x2;                 /* Extended DFP values       */
-decNumber       d1, d2, dr;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
+int             cc;                     /* Condition code            */
 
     RRE(inst, regs, r1, r2);
 
@@ -1969,21 +2290,17 @@ BYTE            dxc;                    /* Data exception code       */
     /* Compare FP register r1 with FP register r2 */
     ARCH_DEP(dfp_reg_to_decimal128)(r1, &x1, regs);
     ARCH_DEP(dfp_reg_to_decimal128)(r2, &x2, regs);
-    decimal128ToNumber(&x1, &d1);
-    decimal128ToNumber(&x2, &d2);
-    decNumberCompare(&dr, &d1, &d2, &set);
+    cc = dfp128_compare(&x1, &x2, &set);
 
     /* Force signaling condition if result is a NaN */
-    if (decNumberIsNaN(&dr))
+    if (cc == 3)
         set.status |= DEC_IEEE_854_Invalid_operation;
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
 
     /* Set condition code */
-    regs->psw.cc = decNumberIsNaN(&dr) ? 3 :
-                   decNumberIsZero(&dr) ? 0 :
-                   decNumberIsNegative(&dr) ? 1 : 2;
+    regs->psw.cc = cc;
 
     /* Raise data exception if error occurred */
     if (dxc != 0)
@@ -2002,9 +2319,9 @@ DEF_INST(compare_and_signal_dfp_long_reg)
 {
 int             r1, r2;                 /* Values of R fields        */
 decimal64       x1, x2;                 /* Long DFP values           */
-decNumber       d1, d2, dr;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
+int             cc;                     /* Condition code            */
 
     RRE(inst, regs, r1, r2);
 
@@ -2017,21 +2334,17 @@ BYTE            dxc;                    /* Data exception code       */
     /* Compare FP register r1 with FP register r2 */
     ARCH_DEP(dfp_reg_to_decimal64)(r1, &x1, regs);
     ARCH_DEP(dfp_reg_to_decimal64)(r2, &x2, regs);
-    decimal64ToNumber(&x1, &d1);
-    decimal64ToNumber(&x2, &d2);
-    decNumberCompare(&dr, &d1, &d2, &set);
+    cc = dfp64_compare(&x1, &x2, &set);
 
     /* Force signaling condition if result is a NaN */
-    if (decNumberIsNaN(&dr))
+    if (cc == 3)
         set.status |= DEC_IEEE_854_Invalid_operation;
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
 
     /* Set condition code */
-    regs->psw.cc = decNumberIsNaN(&dr) ? 3 :
-                   decNumberIsZero(&dr) ? 0 :
-                   decNumberIsNegative(&dr) ? 1 : 2;
+    regs->psw.cc = cc;
 
     /* Raise data exception if error occurred */
     if (dxc != 0)
@@ -2260,8 +2573,6 @@ DEF_INST(convert_fix64_to_dfp_ext_reg)
 int             r1, r2;                 /* Values of R fields        */
 S64             n2;                     /* Value of R2 register      */
 decimal128      x1;                     /* Extended DFP value        */
-decNumber       d1;                     /* Working decimal number    */
-decContext      set;                    /* Working context           */
 
     RRE(inst, regs, r1, r2);
 
@@ -2269,16 +2580,11 @@ decContext      set;                    /* Working context           */
     DFPINST_CHECK(regs);
     DFPREGPAIR_CHECK(r1, regs);
 
-    /* Initialise the context for extended DFP */
-    decContextDefault(&set, DEC_INIT_DECIMAL128);
-    ARCH_DEP(dfp_rounding_mode)(&set, 0, regs);
-
     /* Load 64-bit binary integer value from r2 register */
     n2 = (S64)(regs->GR_G(r2));
 
     /* Convert binary integer to extended DFP format */
-    dfp_number_from_fix64(&d1, n2, &set);
-    decimal128FromNumber(&x1, &d1, &set);
+    dfp128_from_fix64(&x1, n2);
 
     /* Load result into FP register r1 */
     ARCH_DEP(dfp_reg_from_decimal128)(r1, &x1, regs);
@@ -2294,7 +2600,6 @@ DEF_INST(convert_fix64_to_dfp_long_reg)
 int             r1, r2;                 /* Values of R fields        */
 S64             n2;                     /* Value of R2 register      */
 decimal64       x1;                     /* Long DFP value            */
-decNumber       d1;                     /* Working decimal number    */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
 
@@ -2311,8 +2616,7 @@ BYTE            dxc;                    /* Data exception code       */
     n2 = (S64)(regs->GR_G(r2));
 
     /* Convert binary integer to long DFP format */
-    dfp_number_from_fix64(&d1, n2, &set);
-    decimal64FromNumber(&x1, &d1, &set);
+    dfp64_from_fix64(&x1, n2, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
@@ -2911,7 +3215,6 @@ int             r1, r2;                 /* Values of R fields        */
 int             m3;                     /* Values of M fields        */
 S64             n1;                     /* Result value              */
 decimal128      x2;                     /* Extended DFP value        */
-decNumber       d2;                     /* Working decimal number    */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
 
@@ -2927,10 +3230,9 @@ BYTE            dxc;                    /* Data exception code       */
 
     /* Load extended DFP value from FP register r2 */
     ARCH_DEP(dfp_reg_to_decimal128)(r2, &x2, regs);
-    decimal128ToNumber(&x2, &d2);
 
-    /* Convert decimal number to 64-bit binary integer */
-    n1 = dfp_number_to_fix64(&d2, &set);
+    /* Convert DFP value to 64-bit binary integer */
+    n1 = dfp128_to_fix64(&x2, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
@@ -2940,8 +3242,8 @@ BYTE            dxc;                    /* Data exception code       */
 
     /* Set condition code */
     regs->psw.cc = (set.status & DEC_IEEE_854_Invalid_operation) ? 3 :
-                   decNumberIsZero(&d2) ? 0 :
-                   decNumberIsNegative(&d2) ? 1 : 2;
+                   decQuadIsZero(DFP_QUAD(&x2)) ? 0 :
+                   decQuadIsNegative(DFP_QUAD(&x2)) ? 1 : 2;
 
     /* Raise data exception if error occurred */
     if (dxc != 0)
@@ -2962,7 +3264,6 @@ int             r1, r2;                 /* Values of R fields        */
 int             m3;                     /* Values of M fields        */
 S64             n1;                     /* Result value              */
 decimal64       x2;                     /* Long DFP value            */
-decNumber       d2;                     /* Working decimal number    */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
 
@@ -2977,10 +3278,9 @@ BYTE            dxc;                    /* Data exception code       */
 
     /* Load long DFP value from FP register r2 */
     ARCH_DEP(dfp_reg_to_decimal64)(r2, &x2, regs);
-    decimal64ToNumber(&x2, &d2);
 
-    /* Convert decimal number to 64-bit binary integer */
-    n1 = dfp_number_to_fix64(&d2, &set);
+    /* Convert DFP value to 64-bit binary integer */
+    n1 = dfp64_to_fix64(&x2, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
@@ -2990,8 +3290,8 @@ BYTE            dxc;                    /* Data exception code       */
 
     /* Set condition code */
     regs->psw.cc = (set.status & DEC_IEEE_854_Invalid_operation) ? 3 :
-                   decNumberIsZero(&d2) ? 0 :
-                   decNumberIsNegative(&d2) ? 1 : 2;
+                   decDoubleIsZero(DFP_DOUBLE(&x2)) ? 0 :
+                   decDoubleIsNegative(DFP_DOUBLE(&x2)) ? 1 : 2;
 
     /* Raise data exception if error occurred */
     if (dxc != 0)
@@ -3410,7 +3710,6 @@ DEF_INST(divide_dfp_ext_reg)
 {
 int             r1, r2, r3;             /* Values of R fields        */
 decimal128      x1, x2, x3;             /* Extended DFP values       */
-decNumber       d1, d2, d3;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
 
@@ -3427,10 +3726,7 @@ BYTE            dxc;                    /* Data exception code       */
     /* Divide FP register r2 by FP register r3 */
     ARCH_DEP(dfp_reg_to_decimal128)(r2, &x2, regs);
     ARCH_DEP(dfp_reg_to_decimal128)(r3, &x3, regs);
-    decimal128ToNumber(&x2, &d2);
-    decimal128ToNumber(&x3, &d3);
-    decNumberDivide(&d1, &d2, &d3, &set);
-    decimal128FromNumber(&x1, &d1, &set);
+    dfp128_operation(DFP_DIVIDE, &x1, &x2, &x3, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
@@ -3455,7 +3751,6 @@ DEF_INST(divide_dfp_long_reg)
 {
 int             r1, r2, r3;             /* Values of R fields        */
 decimal64       x1, x2, x3;             /* Long DFP values           */
-decNumber       d1, d2, d3;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
 
@@ -3471,10 +3766,7 @@ BYTE            dxc;                    /* Data exception code       */
     /* Divide FP register r2 by FP register r3 */
     ARCH_DEP(dfp_reg_to_decimal64)(r2, &x2, regs);
     ARCH_DEP(dfp_reg_to_decimal64)(r3, &x3, regs);
-    decimal64ToNumber(&x2, &d2);
-    decimal64ToNumber(&x3, &d3);
-    decNumberDivide(&d1, &d2, &d3, &set);
-    decimal64FromNumber(&x1, &d1, &set);
+    dfp64_operation(DFP_DIVIDE, &x1, &x2, &x3, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
@@ -4378,7 +4670,6 @@ DEF_INST(multiply_dfp_ext_reg)
 {
 int             r1, r2, r3;             /* Values of R fields        */
 decimal128      x1, x2, x3;             /* Extended DFP values       */
-decNumber       d1, d2, d3;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
 
@@ -4395,10 +4686,7 @@ BYTE            dxc;                    /* Data exception code       */
     /* Multiply FP register r2 by FP register r3 */
     ARCH_DEP(dfp_reg_to_decimal128)(r2, &x2, regs);
     ARCH_DEP(dfp_reg_to_decimal128)(r3, &x3, regs);
-    decimal128ToNumber(&x2, &d2);
-    decimal128ToNumber(&x3, &d3);
-    decNumberMultiply(&d1, &d2, &d3, &set);
-    decimal128FromNumber(&x1, &d1, &set);
+    dfp128_operation(DFP_MULTIPLY, &x1, &x2, &x3, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
@@ -4423,7 +4711,6 @@ DEF_INST(multiply_dfp_long_reg)
 {
 int             r1, r2, r3;             /* Values of R fields        */
 decimal64       x1, x2, x3;             /* Long DFP values           */
-decNumber       d1, d2, d3;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
 
@@ -4439,10 +4726,7 @@ BYTE            dxc;                    /* Data exception code       */
     /* Multiply FP register r2 by FP register r3 */
     ARCH_DEP(dfp_reg_to_decimal64)(r2, &x2, regs);
     ARCH_DEP(dfp_reg_to_decimal64)(r3, &x3, regs);
-    decimal64ToNumber(&x2, &d2);
-    decimal64ToNumber(&x3, &d3);
-    decNumberMultiply(&d1, &d2, &d3, &set);
-    decimal64FromNumber(&x1, &d1, &set);
+    dfp64_operation(DFP_MULTIPLY, &x1, &x2, &x3, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
@@ -4467,7 +4751,6 @@ DEF_INST(quantize_dfp_ext_reg)
 {
 int             r1, r2, r3, m4;         /* Values of R and M fields  */
 decimal128      x1, x2, x3;             /* Extended DFP values       */
-decNumber       d1, d2, d3;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
 
@@ -4484,10 +4767,7 @@ BYTE            dxc;                    /* Data exception code       */
     /* Quantize FP register r3 using FP register r2 */
     ARCH_DEP(dfp_reg_to_decimal128)(r2, &x2, regs);
     ARCH_DEP(dfp_reg_to_decimal128)(r3, &x3, regs);
-    decimal128ToNumber(&x2, &d2);
-    decimal128ToNumber(&x3, &d3);
-    decNumberQuantize(&d1, &d2, &d3, &set);
-    decimal128FromNumber(&x1, &d1, &set);
+    dfp128_operation(DFP_QUANTIZE, &x1, &x2, &x3, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
@@ -4512,7 +4792,6 @@ DEF_INST(quantize_dfp_long_reg)
 {
 int             r1, r2, r3, m4;         /* Values of R and M fields  */
 decimal64       x1, x2, x3;             /* Long DFP values           */
-decNumber       d1, d2, d3;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
 
@@ -4528,10 +4807,7 @@ BYTE            dxc;                    /* Data exception code       */
     /* Quantize FP register r3 using FP register r2 */
     ARCH_DEP(dfp_reg_to_decimal64)(r2, &x2, regs);
     ARCH_DEP(dfp_reg_to_decimal64)(r3, &x3, regs);
-    decimal64ToNumber(&x2, &d2);
-    decimal64ToNumber(&x3, &d3);
-    decNumberQuantize(&d1, &d2, &d3, &set);
-    decimal64FromNumber(&x1, &d1, &set);
+    dfp64_operation(DFP_QUANTIZE, &x1, &x2, &x3, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
@@ -4915,7 +5191,6 @@ DEF_INST(subtract_dfp_ext_reg)
 {
 int             r1, r2, r3;             /* Values of R fields        */
 decimal128      x1, x2, x3;             /* Extended DFP values       */
-decNumber       d1, d2, d3;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
 
@@ -4932,10 +5207,7 @@ BYTE            dxc;                    /* Data exception code       */
     /* Subtract FP register r3 from FP register r2 */
     ARCH_DEP(dfp_reg_to_decimal128)(r2, &x2, regs);
     ARCH_DEP(dfp_reg_to_decimal128)(r3, &x3, regs);
-    decimal128ToNumber(&x2, &d2);
-    decimal128ToNumber(&x3, &d3);
-    decNumberSubtract(&d1, &d2, &d3, &set);
-    decimal128FromNumber(&x1, &d1, &set);
+    dfp128_operation(DFP_SUBTRACT, &x1, &x2, &x3, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
@@ -4944,9 +5216,7 @@ BYTE            dxc;                    /* Data exception code       */
     ARCH_DEP(dfp_reg_from_decimal128)(r1, &x1, regs);
 
     /* Set condition code */
-    regs->psw.cc = decNumberIsNaN(&d1) ? 3 :
-                   decNumberIsZero(&d1) ? 0 :
-                   decNumberIsNegative(&d1) ? 1 : 2;
+    regs->psw.cc = dfp128_result_cc(&x1);
 
     /* Raise data exception if error occurred */
     if (dxc != 0)
@@ -4965,7 +5235,6 @@ DEF_INST(subtract_dfp_long_reg)
 {
 int             r1, r2, r3;             /* Values of R fields        */
 decimal64       x1, x2, x3;             /* Long DFP values           */
-decNumber       d1, d2, d3;             /* Working decimal numbers   */
 decContext      set;                    /* Working context           */
 BYTE            dxc;                    /* Data exception code       */
 
@@ -4981,10 +5250,7 @@ BYTE            dxc;                    /* Data exception code       */
     /* Subtract FP register r3 from FP register r2 */
     ARCH_DEP(dfp_reg_to_decimal64)(r2, &x2, regs);
     ARCH_DEP(dfp_reg_to_decimal64)(r3, &x3, regs);
-    decimal64ToNumber(&x2, &d2);
-    decimal64ToNumber(&x3, &d3);
-    decNumberSubtract(&d1, &d2, &d3, &set);
-    decimal64FromNumber(&x1, &d1, &set);
+    dfp64_operation(DFP_SUBTRACT, &x1, &x2, &x3, &set);
 
     /* Check for exception condition */
     dxc = ARCH_DEP(dfp_status_check)(&set, regs);
@@ -4993,9 +5259,7 @@ BYTE            dxc;                    /* Data exception code       */
     ARCH_DEP(dfp_reg_from_decimal64)(r1, &x1, regs);
 
     /* Set condition code */
-    regs->psw.cc = decNumberIsNaN(&d1) ? 3 :
-                   decNumberIsZero(&d1) ? 0 :
-                   decNumberIsNegative(&d1) ? 1 : 2;
+    regs->psw.cc = dfp64_result_cc(&x1);
 
     /* Raise data exception if error occurred */
     if (dxc != 0)
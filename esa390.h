@@ -1189,6 +1189,28 @@ typedef struct PSA_900  PSA_900;
 #define EXT_BLOCKIO_INTERRUPT                           0x2603
 #endif
 
+/*-------------------------------------------------------------------*/
+/* ESSA (CMMA) operation request codes in the M3 field */
+
+#define ESSA_GET_STATE                  0   /* Extract state only    */
+#define ESSA_SET_STABLE                 1
+#define ESSA_SET_UNUSED                 2
+#define ESSA_SET_VOLATILE               3
+#define ESSA_SET_POT_VOLATILE           4
+#define ESSA_SET_STABLE_RESIDENT        5
+#define ESSA_SET_STABLE_IF_RESIDENT     6
+
+/* ESSA frame state returned in R1 bits 56-63 */
+
+#define ESSA_USAGE_MASK                 0x0C    /* Usage state       */
+#define ESSA_USAGE_STABLE               0x00
+#define ESSA_USAGE_UNUSED               0x04
+#define ESSA_USAGE_POT_VOLATILE         0x08
+#define ESSA_USAGE_VOLATILE             0x0C
+#define ESSA_CONTENT_MASK               0x03    /* Block content     */
+#define ESSA_CONTENT_RESIDENT           0x00
+#define ESSA_CONTENT_ZERO               0x03    /* Discarded: zeros  */
+
 /*-------------------------------------------------------------------*/
 /* Macros for classifying CCW operation codes */
 
@@ -1318,8 +1340,10 @@ typedef struct PMCW PMCW;
 /* Bit definitions for PMCW flag byte 27 */
 
 #define PMCW27_I        0x80            /* Interrupt Interlock Cntl  */
+#define PMCW27_F        0x04            /* Meas. block format control*/
+#define PMCW27_X        0x02            /* Ext. meas. word mode enbl */
 #define PMCW27_S        0x01            /* Concurrent sense mode     */
-#define PMCW27_RESV     0x7E            /* Reserved bits - must be 0 */
+#define PMCW27_RESV     0x78            /* Reserved bits - must be 0 */
 
 /*-------------------------------------------------------------------*/
 /*        Extended-Status Word (ESW) structure definition            */
@@ -1340,6 +1364,22 @@ struct ESW
 };
 typedef struct ESW  ESW;
 
+/*-------------------------------------------------------------------*/
+/*      Extended-Measurement Word (EMW) structure definition         */
+/*-------------------------------------------------------------------*/
+struct EMW
+{
+    FWORD   dct;                        /* Device connect time       */
+    FWORD   fpt;                        /* Function pending time     */
+    FWORD   ddt;                        /* Device disconnect time    */
+    FWORD   cuqt;                       /* Control unit queueing time*/
+    FWORD   daot;                       /* Device active only time   */
+    FWORD   dbt;                        /* Device busy time          */
+    FWORD   icrt;                       /* Initial cmd response time */
+    FWORD   resv;                       /* Reserved word - must be 0 */
+};
+typedef struct EMW  EMW;
+
 /*-------------------------------------------------------------------*/
 /* Bit definitions for subchannel logout byte 0 */
 
@@ -1570,9 +1610,12 @@ struct IRB
     SCSW    scsw;                       /* Subchannel status word    */
     ESW     esw;                        /* Extended status word      */
     BYTE    ecw[32];                    /* Extended control word     */
+    EMW     emw;                        /* Extended measurement word */
 };
 typedef struct IRB  IRB;
 
+#define IRB_SIZE_NOEMW  64              /* IRB size without the EMW  */
+
 /*-------------------------------------------------------------------*/
 /*          Measurement Block (MBK) structure definition             */
 /*-------------------------------------------------------------------*/
@@ -1584,10 +1627,32 @@ struct MBK
     FWORD   fpt;                        /* Function pending time     */
     FWORD   ddt;                        /* Device disconnect time    */
     FWORD   cuqt;                       /* Control unit queueing time*/
-    FWORD   resv[3];                    /* Reserved                  */
+    FWORD   daot;                       /* Device active only time   */
+    FWORD   dbt;                        /* Device busy time          */
+    FWORD   icrt;                       /* Initial cmd response time */
 };
 typedef struct MBK  MBK;
 
+/*-------------------------------------------------------------------*/
+/*   Format-1 (extended) Measurement Block (MBK1) structure          */
+/*-------------------------------------------------------------------*/
+struct MBK1
+{
+    FWORD   srcount;                    /* SSCH + RSCH count         */
+    FWORD   samplecnt;                  /* Sample count              */
+    FWORD   dct;                        /* Device connect time       */
+    FWORD   fpt;                        /* Function pending time     */
+    FWORD   ddt;                        /* Device disconnect time    */
+    FWORD   cuqt;                       /* Control unit queueing time*/
+    FWORD   daot;                       /* Device active only time   */
+    FWORD   dbt;                        /* Device busy time          */
+    FWORD   icrt;                       /* Initial cmd response time */
+    FWORD   resv[7];                    /* Reserved                  */
+};
+typedef struct MBK1  MBK1;
+
+#define MB_UNIT         (128 * ETOD_USEC) /* 128 microsecond units   */
+
 /*-------------------------------------------------------------------*/
 /* Bit definitions for SCHM instruction */
 
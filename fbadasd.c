@@ -186,6 +186,11 @@ CCKD_DEVHDR     cdevhdr;                /* Compressed device header  */
                 cckd_sf_parse_sfn( dev, argv[i]+3 );
                 continue;
             }
+            if (strcasecmp ("sfnew", argv[i]) == 0)
+            {
+                dev->ckdsfnew = 1;
+                continue;
+            }
             if (strlen (argv[i]) > 3
              && memcmp("cu=", argv[i], 3) == 0)   /* support for cu= added but  */
             {                                     /* is ignored for the present */
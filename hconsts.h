@@ -458,6 +458,9 @@
 /*-------------------------------------------------------------------*/
 #define MAX_SCRIPT_STMT       1024      /* Max script stmt length    */
 #define MAX_SCRIPT_DEPTH        10      /* Max script nesting depth  */
+#define MAX_SCRIPT_BLOCKS       16      /* Max if/while nesting depth*/
+#define MAX_EXPECT_BUF  (64 * 1024)     /* Max saved 'expect' output */
+#define EXPECT_MAXCAPT           9      /* Max 'expect' captures     */
 
 #define MIN_PAUSE_TIMEOUT    0.001      /* Minimum pause seconds     */
 #define DEF_PAUSE_TIMEOUT      1.0      /* Default pause seconds     */
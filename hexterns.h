@@ -66,8 +66,19 @@ int  configure_maxcpu (int maxcpu);
 int  configure_memlock(int);
 int  configure_memfree(int);
 int  configure_storage( U64 /* number of 4K pages */ );
+int  configure_storage_image( int fd, U64 /* size in bytes */ );
 int  configure_xstorage(U64);
 U64  adjust_mainsize( int archnum, U64 mainsize );
+U64  release_storage( RADR addr, U64 len );
+BYTE cmma_essa( U64 frame, int op );
+void cmma_flush();
+void cmma_reset();
+int  mainshare_set( int enable, U32 interval );
+U64  mainshare_scan();
+void mainshare_reset();
+int  configure_storshm( const char* name );
+void storshm_reset();
+void storshm_cpu( int cpu );
 
 int  configure_shrdport(U16 shrdport);
 SHR_DLL_IMPORT void shutdown_shared_server       ( void* unused );
@@ -397,6 +408,11 @@ int exec_cmd( int argc, char* argv[], char* cmdline );
 /* Functions in module sr.c */
 int suspend_cmd(int argc, char *argv[],char *cmdline);
 int resume_cmd(int argc, char *argv[],char *cmdline);
+int migrate_cmd(int argc, char *argv[],char *cmdline);
+int clone_cmd(int argc, char *argv[],char *cmdline);
+DEVBLK *sr_active_devices();
+void sr_stop_cpus( CPU_BITMAP* started_mask );
+void sr_start_cpus( CPU_BITMAP started_mask );
 
 /* Functions in module ecpsvm.c that are not *direct* instructions   */
 /* but rather are instead support functions used by either other     */
@@ -438,6 +454,15 @@ GOP_DLL_IMPORT int   getopt_long ( int nargc, char * const *nargv, const char *o
 
 /* Functions in module channel.c */
                 void shared_iowait (DEVBLK *dev);
+CHAN_DLL_IMPORT void svc_set_model (DEVBLK *dev, const SVCMODEL *model);
+CHAN_DLL_IMPORT void svc_set_chpid (BYTE chpid, U32 kbps);
+CHAN_DLL_IMPORT U32  svc_get_chpid (BYTE chpid);
+                void svc_ccw       (DEVBLK *dev, U32 bytes);
+                TOD  svc_delay     (DEVBLK *dev);
+CHAN_DLL_IMPORT int  fault_add     (const FLTRULE *rule);
+CHAN_DLL_IMPORT int  fault_del     (int id);
+CHAN_DLL_IMPORT bool fault_query   (int n, FLTRULE *rule);
+                bool fault_inject  (DEVBLK *dev, BYTE code, U32 count, BYTE *unitstat, U32 *residual);
 CHAN_DLL_IMPORT int  device_attention (DEVBLK *dev, BYTE unitstat);
 CHAN_DLL_IMPORT int  ARCH_DEP(device_attention) (DEVBLK *dev, BYTE unitstat);
 
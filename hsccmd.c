@@ -66,6 +66,7 @@ DISABLE_GCC_UNUSED_FUNCTION_WARNING;
 #include "ctc_ptp.h"
 #include "qeth.h"
 #include "cckddasd.h"
+#include "storshm.h"
 #include "inline.h"
 
 //-------------------------------------------------------------------
@@ -1361,6 +1362,671 @@ int iodelay_cmd(int argc, char *argv[], char *cmdline)
 }
 #endif /* defined( OPTION_IODELAY_KLUDGE ) */
 
+/*-------------------------------------------------------------------*/
+/* svctime command helpers                                           */
+/*-------------------------------------------------------------------*/
+static void svctime_display( DEVBLK* dev )
+{
+    char  buf[128];
+    U64   n = dev->svccount ? dev->svccount : 1;
+
+    if (!dev->svcon)
+    {
+        // "%1d:%04X service time model: %s"
+        WRMSG( HHC02350, "I", LCSS_DEVNUM, "none" );
+        return;
+    }
+
+    MSGBUF( buf, "overhead=%u seek=%u,%u rpm=%u xfer=%u hit=%u,%u cu=%02X,%u",
+        dev->svc.overhead, dev->svc.seekmin, dev->svc.seekmax,
+        dev->svc.rpm, dev->svc.xfer, dev->svc.hitpct, dev->svc.hittime,
+        dev->svc.cu, dev->svc.paths );
+
+    // "%1d:%04X service time model: %s"
+    WRMSG( HHC02350, "I", LCSS_DEVNUM, buf );
+
+    // "%1d:%04X programs %"PRIu64", average modelled %"PRIu64" us, ..."
+    WRMSG( HHC02351, "I", LCSS_DEVNUM, dev->svccount,
+        dev->svcmodel / n, dev->svcactual / n, dev->svccuq / n );
+}
+
+static int svctime_value( const char* arg, U32* val1, U32* val2, int hex )
+{
+    char  c;
+
+    if (val2 && strchr( arg, ',' ))
+        return sscanf( arg, hex ? "%x,%u%c" : "%u,%u%c", val1, val2, &c ) == 2;
+
+    return sscanf( arg, hex ? "%x%c" : "%u%c", val1, &c ) == 1;
+}
+
+/*-------------------------------------------------------------------*/
+/* svctime command - display or set device service time models       */
+/*-------------------------------------------------------------------*/
+int svctime_cmd( int argc, char* argv[], char* cmdline )
+{
+    DEVBLK*   dev;
+    SVCMODEL  model;
+    U16       lcss;
+    U16       devnum;
+    U32       val1, val2;
+    char      buf[32];
+    int       i, found = 0;
+
+    UNREFERENCED( cmdline );
+
+    UPPER_ARGV_0( argv );
+
+    /* Display all models and channel path bandwidths */
+    if (argc < 2)
+    {
+        for (dev = sysblk.firstdev; dev; dev = dev->nextdev)
+        {
+            if (dev->allocated && dev->svcon)
+            {
+                svctime_display( dev );
+                found = 1;
+            }
+        }
+        for (i=0; i < 256; i++)
+        {
+            if ((val1 = svc_get_chpid( i )))
+            {
+                MSGBUF( buf, "%u KB/s", val1 );
+                // "CHPID %02X bandwidth %s"
+                WRMSG( HHC02352, "I", i, buf );
+                found = 1;
+            }
+        }
+        if (!found)
+            // "No device service time models are set"
+            WRMSG( HHC02353, "I" );
+        return 0;
+    }
+
+    /* Display or set the bandwidth of a channel path */
+    if (CMD( argv[1], CHPID, 3 ))
+    {
+        if (argc < 3 || argc > 4
+         || !svctime_value( argv[2], &val1, NULL, 1 ) || val1 > 0xFF)
+        {
+            // "Invalid command usage. Type 'help %s' for assistance."
+            WRMSG( HHC02299, "E", argv[0] );
+            return -1;
+        }
+        if (argc == 4)
+        {
+            if (!svctime_value( argv[3], &val2, NULL, 0 ))
+            {
+                // "Invalid argument %s%s"
+                WRMSG( HHC02205, "E", argv[3], "" );
+                return -1;
+            }
+            svc_set_chpid( (BYTE) val1, val2 );
+        }
+        val2 = svc_get_chpid( (BYTE) val1 );
+        if (val2)
+            MSGBUF( buf, "%u KB/s", val2 );
+        else
+            STRLCPY( buf, "unlimited" );
+        // "CHPID %02X bandwidth %s"
+        WRMSG( HHC02352, "I", val1, buf );
+        return 0;
+    }
+
+    if (parse_single_devnum( argv[1], &lcss, &devnum ) < 0)
+        return -1;    // (message already displayed)
+
+    if (!(dev = find_device_by_devnum( lcss, devnum )))
+    {
+        // HHC02200 "%1d:%04X device not found"
+        devnotfound_msg( lcss, devnum );
+        return -1;
+    }
+
+    if (argc == 2)
+    {
+        svctime_display( dev );
+        return 0;
+    }
+
+    if (argc == 3 && CMD( argv[2], OFF, 3 ))
+    {
+        svc_set_model( dev, NULL );
+        svctime_display( dev );
+        return 0;
+    }
+
+    /* Keywords not given keep the device's current values */
+    if (dev->svcon)
+        model = dev->svc;
+    else
+    {
+        memset( &model, 0, sizeof( model ));
+        model.paths = 1;
+    }
+
+    for (i=2; i < argc; i++)
+    {
+        char* kw  = argv[i];
+        char* val = strchr( kw, '=' );
+        int   ok  = 0;
+
+        if (val)
+        {
+            *val++ = 0;
+
+            if      (CMD( kw, OVERHEAD, 2 ))
+                ok = svctime_value( val, &model.overhead, NULL, 0 );
+            else if (CMD( kw, SEEK, 2 ))
+            {
+                val2 = 0;
+                if ((ok = svctime_value( val, &val1, &val2, 0 )))
+                {
+                    model.seekmin = val1;
+                    model.seekmax = MAX( val1, val2 );
+                }
+            }
+            else if (CMD( kw, RPM, 1 ))
+                ok = svctime_value( val, &model.rpm, NULL, 0 );
+            else if (CMD( kw, XFER, 1 ))
+                ok = svctime_value( val, &model.xfer, NULL, 0 );
+            else if (CMD( kw, HIT, 1 ))
+            {
+                val2 = model.hittime;
+                if ((ok = svctime_value( val, &val1, &val2, 0 ) && val1 <= 100))
+                {
+                    model.hitpct  = val1;
+                    model.hittime = val2;
+                }
+            }
+            else if (CMD( kw, CU, 2 ))
+            {
+                val2 = model.paths;
+                if ((ok = svctime_value( val, &val1, &val2, 1 )
+                    && val1 <= 0xFF && val2 >= 1 && val2 <= SVC_MAXPATHS))
+                {
+                    model.cu    = val1;
+                    model.paths = val2;
+                }
+            }
+            *--val = '=';
+        }
+
+        if (!ok)
+        {
+            // "Invalid argument %s%s"
+            WRMSG( HHC02205, "E", argv[i], "" );
+            return -1;
+        }
+    }
+
+    svc_set_model( dev, &model );
+    svctime_display( dev );
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* fault command helpers                                             */
+/*-------------------------------------------------------------------*/
+static void fault_format( const FLTRULE* rule, char* buf, size_t bufsz )
+{
+    char  work[128];
+    int   i;
+
+    switch (rule->action)
+    {
+    case FLT_UC:
+        snprintf( buf, bufsz, "UC" );
+        for (i=0; i < rule->senselen; i++)
+        {
+            MSGBUF( work, "%s%02X", i ? "" : "=", rule->sense[i] );
+            strlcat( buf, work, bufsz );
+        }
+        break;
+    case FLT_BUSY:
+        snprintf( buf, bufsz, "BUSY" );
+        break;
+    case FLT_DELAY:
+        snprintf( buf, bufsz, "DELAY=%u", rule->delay );
+        break;
+    default:
+        snprintf( buf, bufsz, "NOINTR" );
+        break;
+    }
+
+    if (rule->ccw >= 0)
+    {
+        MSGBUF( work, " CCW=%02X", rule->ccw );
+        strlcat( buf, work, bufsz );
+    }
+    if (rule->lo || rule->hi != 0xFFFFFFFF)
+    {
+        MSGBUF( work, " RANGE=%u-%u", rule->lo, rule->hi );
+        strlcat( buf, work, bufsz );
+    }
+    if (rule->nth)
+    {
+        MSGBUF( work, " NTH=%u", rule->nth );
+        strlcat( buf, work, bufsz );
+    }
+    if (rule->every)
+    {
+        MSGBUF( work, " EVERY=%u", rule->every );
+        strlcat( buf, work, bufsz );
+    }
+    if (rule->prob)
+    {
+        MSGBUF( work, " PROB=%u SEED=%u", rule->prob, rule->seed );
+        strlcat( buf, work, bufsz );
+    }
+    if (rule->limit)
+    {
+        MSGBUF( work, " LIMIT=%u", rule->limit );
+        strlcat( buf, work, bufsz );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/* fault command - define, delete or list device fault injections    */
+/*-------------------------------------------------------------------*/
+int fault_cmd( int argc, char* argv[], char* cmdline )
+{
+    FLTRULE   rule;
+    U16       lcss;
+    U16       devnum;
+    char      buf[256];
+    char      c;
+    int       i, n;
+
+    UNREFERENCED( cmdline );
+
+    UPPER_ARGV_0( argv );
+
+    /* List the defined rules */
+    if (argc < 2)
+    {
+        for (n=0; fault_query( n, &rule ); n++)
+        {
+            fault_format( &rule, buf, sizeof( buf ));
+            // "Fault %d: %1d:%04X %s; matched %u, injected %u"
+            WRMSG( HHC02355, "I", rule.id, rule.lcss, rule.devnum,
+                buf, rule.matches, rule.injected );
+        }
+        if (!n)
+            // "No fault rules are defined"
+            WRMSG( HHC02356, "I" );
+        return 0;
+    }
+
+    /* Delete one or all rules */
+    if (CMD( argv[1], DELETE, 3 ))
+    {
+        if (argc != 3)
+        {
+            // "Invalid command usage. Type 'help %s' for assistance."
+            WRMSG( HHC02299, "E", argv[0] );
+            return -1;
+        }
+        if (CMD( argv[2], ALL, 3 ))
+            i = 0;
+        else if (sscanf( argv[2], "%d%c", &i, &c ) != 1 || i <= 0)
+        {
+            // "Invalid argument %s%s"
+            WRMSG( HHC02205, "E", argv[2], "" );
+            return -1;
+        }
+        // "%d fault rule(s) deleted"
+        WRMSG( HHC02357, "I", fault_del( i ));
+        return 0;
+    }
+
+    /* Define a new rule; the device need not be attached yet */
+    if (argc < 3)
+    {
+        // "Missing argument(s). Type 'help %s' for assistance."
+        WRMSG( HHC02202, "E", argv[0] );
+        return -1;
+    }
+
+    if (parse_single_devnum( argv[1], &lcss, &devnum ) < 0)
+        return -1;    // (message already displayed)
+
+    memset( &rule, 0, sizeof( rule ));
+    rule.lcss   = lcss;
+    rule.devnum = devnum;
+    rule.ccw    = -1;
+    rule.hi     = 0xFFFFFFFF;
+    rule.seed   = 1;
+
+    for (i=2; i < argc; i++)
+    {
+        char* kw  = argv[i];
+        char* eq  = strchr( kw, '=' );
+        char* val = eq ? eq + 1 : NULL;
+        U32   lo, hi;
+        int   ok  = 0;
+
+        if (eq)
+            *eq = 0;
+
+        if (CMD( kw, UC, 2 ))
+        {
+            rule.action = FLT_UC;
+            rule.senselen = 0;
+            ok = 1;
+            while (ok && val && *val)
+            {
+                if (rule.senselen >= sizeof( rule.sense )
+                 || sscanf( val, "%2x", &lo ) != 1
+                 || !isxdigit( (unsigned char) val[1] ))
+                    ok = 0;
+                else
+                {
+                    rule.sense[ rule.senselen++ ] = (BYTE) lo;
+                    val += 2;
+                }
+            }
+        }
+        else if (!val && CMD( kw, BUSY, 4 ))
+            ok = (rule.action = FLT_BUSY);
+        else if (!val && CMD( kw, NOINTR, 5 ))
+            ok = (rule.action = FLT_NOINTR);
+        else if (val && CMD( kw, DELAY, 3 ))
+            ok = sscanf( val, "%u%c", &rule.delay, &c ) == 1
+              && (rule.action = FLT_DELAY);
+        else if (val && CMD( kw, CCW, 3 ))
+        {
+            ok = sscanf( val, "%x%c", &lo, &c ) == 1 && lo <= 0xFF;
+            rule.ccw = lo;
+        }
+        else if (val && CMD( kw, RANGE, 3 ))
+        {
+            n = sscanf( val, "%u-%u%c", &lo, &hi, &c );
+            if (n == 1)
+                hi = lo;
+            ok = (n == 1 || n == 2) && lo <= hi;
+            rule.lo = lo;
+            rule.hi = hi;
+        }
+        else if (val && CMD( kw, NTH, 3 ))
+            ok = sscanf( val, "%u%c", &rule.nth, &c ) == 1 && rule.nth;
+        else if (val && CMD( kw, EVERY, 3 ))
+            ok = sscanf( val, "%u%c", &rule.every, &c ) == 1 && rule.every;
+        else if (val && CMD( kw, PROB, 4 ))
+            ok = sscanf( val, "%u%c", &rule.prob, &c ) == 1
+              && rule.prob >= 1 && rule.prob <= 100;
+        else if (val && CMD( kw, SEED, 4 ))
+            ok = sscanf( val, "%u%c", &rule.seed, &c ) == 1;
+        else if (val && CMD( kw, LIMIT, 3 ))
+            ok = sscanf( val, "%u%c", &rule.limit, &c ) == 1;
+
+        if (eq)
+            *eq = '=';
+
+        if (!ok)
+        {
+            // "Invalid argument %s%s"
+            WRMSG( HHC02205, "E", argv[i], "" );
+            return -1;
+        }
+    }
+
+    if (!rule.action)
+    {
+        // "Invalid command usage. Type 'help %s' for assistance."
+        WRMSG( HHC02299, "E", argv[0] );
+        return -1;
+    }
+
+    if ((rule.id = fault_add( &rule )) < 0)
+        return -1;
+
+    fault_format( &rule, buf, sizeof( buf ));
+    // "Fault %d: %1d:%04X %s; matched %u, injected %u"
+    WRMSG( HHC02355, "I", rule.id, lcss, devnum, buf, 0, 0 );
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* mck command helpers                                               */
+/*-------------------------------------------------------------------*/
+typedef struct
+{
+    const char*  name;                  /* Condition or register     */
+    U64          bits;                  /* Interruption code bits    */
+}
+MCKNAME;
+
+static const MCKNAME mck_conds[] =
+{
+    { "SD",  MCIC_SD },                 /* System damage             */
+    { "P",   MCIC_P  },                 /* Instruction proc damage   */
+    { "SR",  MCIC_SR },                 /* System recovery           */
+    { "TD",  MCIC_CD },                 /* Timing facility damage    */
+    { "ED",  MCIC_ED },                 /* External damage           */
+    { "DG",  MCIC_DG },                 /* Degradation               */
+    { "W",   MCIC_W  },                 /* Warning                   */
+    { "SP",  MCIC_SP },                 /* Service processor damage  */
+    { "CK",  MCIC_CK },                 /* Channel subsystem damage  */
+    { "B",   MCIC_B  },                 /* Backed up                 */
+    { "SE",  MCIC_SE },                 /* Storage error uncorrected */
+    { "SC",  MCIC_SC },                 /* Storage error corrected   */
+    { "KE",  MCIC_KE },                 /* Storkey error uncorrected */
+    { "DS",  MCIC_DS },                 /* Storage degradation       */
+    { "IE",  MCIC_IE },                 /* Indirect storage error    */
+    { "DA",  MCIC_DA },                 /* Delayed access exception  */
+};
+
+static const MCKNAME mck_regs[] =
+{
+    { "PSW", MCIC_WP | MCIC_MS | MCIC_PM | MCIC_IA },
+    { "GR",  MCIC_GR },
+    { "FP",  MCIC_FP },
+    { "XF",  MCIC_XF },
+    { "CR",  MCIC_CR },
+    { "AR",  MCIC_AR },
+    { "ST",  MCIC_ST },
+    { "PR",  MCIC_PR },
+    { "CT",  MCIC_CT },
+    { "CC",  MCIC_CC },
+};
+
+/* OR the bits named by a comma separated list into *bits */
+static bool mck_names( char* list, const MCKNAME* names, size_t count,
+                       U64* bits )
+{
+    char*   tok;
+    char*   save = NULL;
+    size_t  i;
+
+    for (tok = strtok_r( list, ",", &save ); tok;
+         tok = strtok_r( NULL, ",", &save ))
+    {
+        for (i=0; i < count && strcasecmp( tok, names[i].name ); i++);
+        if (i >= count)
+            return false;
+        *bits |= names[i].bits;
+    }
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/* mck command - inject machine checks or define injection frames    */
+/*-------------------------------------------------------------------*/
+int mck_cmd( int argc, char* argv[], char* cmdline )
+{
+    MCKRULE   rule;
+    U64       cond = 0, invalid = 0, fsta = 0, work64;
+    bool      code = false, frame = false, addr = false, xdmg = false;
+    char      cpustr[8];
+    char      buf[256];
+    char      c;
+    U32       num;
+    int       i, n, cpu = -2;
+
+    UNREFERENCED( cmdline );
+
+    UPPER_ARGV_0( argv );
+
+    /* List the defined rules */
+    if (argc < 2)
+    {
+        for (n=0; mck_query( n, &rule ); n++)
+        {
+            if (rule.cpu < 0)
+                STRLCPY( cpustr, "any" );
+            else
+                MSGBUF( cpustr, "%02X", rule.cpu );
+            // "Machine check rule %d: CPU %s, code %16.16"PRIX64", ..."
+            WRMSG( HHC17018, "I", rule.id, cpustr, rule.mcic | MCIC_FA,
+                (U64) rule.frame, rule.limit, rule.injected );
+        }
+        if (!n)
+            // "No machine check rules are defined"
+            WRMSG( HHC17019, "I" );
+        return 0;
+    }
+
+    /* Delete one or all rules */
+    if (CMD( argv[1], DELETE, 3 ))
+    {
+        if (argc != 3)
+        {
+            // "Invalid command usage. Type 'help %s' for assistance."
+            WRMSG( HHC02299, "E", argv[0] );
+            return -1;
+        }
+        if (CMD( argv[2], ALL, 3 ))
+            i = 0;
+        else if (sscanf( argv[2], "%d%c", &i, &c ) != 1 || i <= 0)
+        {
+            // "Invalid argument %s%s"
+            WRMSG( HHC02205, "E", argv[2], "" );
+            return -1;
+        }
+        // "%d machine check rule(s) deleted"
+        WRMSG( HHC17020, "I", mck_del( i ));
+        return 0;
+    }
+
+    memset( &rule, 0, sizeof( rule ));
+
+    for (i=1; i < argc; i++)
+    {
+        char* kw  = argv[i];
+        char* eq  = strchr( kw, '=' );
+        char* val = eq ? eq + 1 : NULL;
+        bool  ok  = false;
+
+        if (eq)
+            *eq = 0;
+
+        if (val && CMD( kw, CPU, 3 ))
+        {
+            if (CMD( val, ANY, 3 ))
+            {
+                cpu = -1;
+                ok = true;
+            }
+            else
+            {
+                ok = sscanf( val, "%x%c", &num, &c ) == 1
+                  && num < (U32) sysblk.maxcpu;
+                cpu = (int) num;
+            }
+        }
+        else if (val && CMD( kw, MCIC, 4 ))
+            ok = sscanf( val, "%"SCNx64"%c", &rule.mcic, &c ) == 1
+              && (code = true);
+        else if (val && CMD( kw, XDMG, 4 ))
+            ok = sscanf( val, "%x%c", &rule.xdmg, &c ) == 1
+              && (xdmg = true);
+        else if (val && CMD( kw, ADDR, 4 ))
+            ok = sscanf( val, "%"SCNx64"%c", &fsta, &c ) == 1
+              && fsta < sysblk.mainsize && (addr = true);
+        else if (val && CMD( kw, FRAME, 5 ))
+        {
+            ok = sscanf( val, "%"SCNx64"%c", &work64, &c ) == 1
+              && work64 < sysblk.mainsize && (frame = true);
+            rule.frame = (RADR) work64;
+        }
+        else if (val && CMD( kw, LIMIT, 3 ))
+            ok = sscanf( val, "%u%c", &rule.limit, &c ) == 1;
+        else if (val && CMD( kw, INVALID, 3 ))
+            ok = mck_names( val, mck_regs, _countof( mck_regs ), &invalid );
+        else if (!val)
+            ok = mck_names( kw, mck_conds, _countof( mck_conds ), &cond );
+
+        if (eq)
+            *eq = '=';
+
+        if (!ok)
+        {
+            // "Invalid argument %s%s"
+            WRMSG( HHC02205, "E", argv[i], "" );
+            return -1;
+        }
+    }
+
+    /* Exactly one of a list of conditions or a complete MCIC */
+    if (!(code ^ (cond != 0)) || (addr && frame) || (rule.limit && !frame))
+    {
+        // "Invalid command usage. Type 'help %s' for assistance."
+        WRMSG( HHC02299, "E", argv[0] );
+        return -1;
+    }
+
+    /* Supply the validity bits for conditions named individually */
+    if (!code)
+    {
+        rule.mcic = (cond | mck_validity()) & ~invalid;
+        if (xdmg)
+            rule.mcic |= MCIC_EC;
+        if (addr)
+            rule.mcic |= MCIC_FA;
+    }
+
+    /* Something must say which interrupt subclass it belongs to */
+    if (!mck_subclass( rule.mcic ))
+    {
+        // "Invalid command usage. Type 'help %s' for assistance."
+        WRMSG( HHC02299, "E", argv[0] );
+        return -1;
+    }
+
+    /* Without a frame the machine check is made pending right away
+       on the given or the target CPU, otherwise a frame rule applies
+       to any CPU unless one is given */
+    if (!frame)
+    {
+        if (cpu < 0)
+            cpu = sysblk.pcpu;
+        if (mck_inject( cpu, rule.mcic, rule.xdmg, (RADR) fsta ) < 0)
+        {
+            MSGBUF( buf, "CPU %02X", cpu );
+            // "Invalid argument %s%s"
+            WRMSG( HHC02205, "E", buf, ": processor is offline" );
+            return -1;
+        }
+        return 0;
+    }
+
+    rule.cpu = cpu < 0 ? -1 : cpu;
+
+    if ((rule.id = mck_add( &rule )) < 0)
+        return -1;
+
+    if (rule.cpu < 0)
+        STRLCPY( cpustr, "any" );
+    else
+        MSGBUF( cpustr, "%02X", rule.cpu );
+    // "Machine check rule %d: CPU %s, code %16.16"PRIX64", ..."
+    WRMSG( HHC17018, "I", rule.id, cpustr, rule.mcic | MCIC_FA,
+        (U64)(rule.frame & STORAGE_KEY_PAGEMASK), rule.limit, 0 );
+    return 0;
+}
+
 /*-------------------------------------------------------------------*/
 /* autoinit_cmd - show or set AUTOINIT switch                        */
 /*-------------------------------------------------------------------*/
@@ -4582,6 +5248,228 @@ int diag8_cmd( int argc, char* argv[], char* cmdline )
     return 0;
 }
 
+/*-------------------------------------------------------------------*/
+/* Format a host memory statistic kept in /proc/self (Linux only)    */
+/*-------------------------------------------------------------------*/
+static void fmt_host_pages( const char* path, const char* fmt,
+                            char* buf, size_t bufsz )
+{
+    U64    pages;
+    int    n = 0;
+    FILE*  fp;
+
+    if ((fp = fopen( path, "r" )))
+    {
+        n = fscanf( fp, fmt, &pages );
+        fclose( fp );
+    }
+
+    if (n == 1)
+        fmt_memsize( pages * HPAGESIZE(), buf, bufsz );
+    else
+        strlcpy( buf, "unknown", bufsz );
+}
+
+/*-------------------------------------------------------------------*/
+/* cmma command                                                      */
+/*-------------------------------------------------------------------*/
+int cmma_cmd( int argc, char* argv[], char* cmdline )
+{
+    char   unused[64], released[64], rss[64];
+
+    UNREFERENCED( cmdline );
+
+    UPPER_ARGV_0( argv );
+
+    if (argc > 2)
+    {
+        // "Invalid number of arguments for %s"
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if (argc == 2)
+    {
+        if (CMD( argv[1], on, 2 ))
+            sysblk.cmma = 1;
+        else if (CMD( argv[1], off, 3 ))
+            sysblk.cmma = 0;
+        else
+        {
+            // "Invalid argument %s%s"
+            WRMSG( HHC02205, "E", argv[1], "" );
+            return -1;
+        }
+
+        if (MLVL( VERBOSE ))
+        {
+            // "%-14s set to %s"
+            WRMSG( HHC02204, "I", argv[0], sysblk.cmma ? "ON" : "OFF" );
+        }
+        return 0;
+    }
+
+    /* Return the frames still waiting for it so the host is current */
+    cmma_flush();
+
+    fmt_memsize( sysblk.cmmaunused << SHIFT_4K, unused, sizeof( unused ));
+    fmt_memsize( sysblk.releasedbytes, released, sizeof( released ));
+    fmt_host_pages( "/proc/self/statm", "%*u %"SCNu64, rss, sizeof( rss ));
+
+    // "CMMA %s; %s of unused frames, %s returned to the host, host RSS %s"
+    WRMSG( HHC17016, "I", sysblk.cmma ? "ON" : "OFF", unused, released, rss );
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* mainshare command                                                 */
+/*-------------------------------------------------------------------*/
+int mainshare_cmd( int argc, char* argv[], char* cmdline )
+{
+    char   state[32], zero[64], merged[64], rss[64];
+    U32    interval = 300;
+    BYTE   c;
+
+    UNREFERENCED( cmdline );
+
+    UPPER_ARGV_0( argv );
+
+    if (argc > 3)
+    {
+        // "Invalid number of arguments for %s"
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if (argc > 1)
+    {
+#if !defined( MADV_DONTNEED )
+        // "%s support not included in this engine build"
+        WRMSG( HHC17015, "E", "Page sharing" );
+        return -1;
+#else
+        if (CMD( argv[1], on, 2 ))
+        {
+            if (argc == 3 && sscanf( argv[2], "%"SCNu32"%c", &interval, &c ) != 1)
+            {
+                // "Invalid argument %s%s"
+                WRMSG( HHC02205, "E", argv[2], "" );
+                return -1;
+            }
+
+            if (mainshare_set( 1, interval ) != 0)
+            {
+                // "Error in function %s: %s"
+                WRMSG( HHC01430, "W", "madvise(MADV_MERGEABLE)", strerror( errno ));
+            }
+        }
+        else if (argc == 2 && CMD( argv[1], off, 3 ))
+            mainshare_set( 0, 0 );
+        else if (argc == 2 && CMD( argv[1], scan, 4 ))
+        {
+            if (!sysblk.mainshare)
+            {
+                // "Invalid argument %s%s"
+                WRMSG( HHC02205, "E", argv[1], "; page sharing is OFF" );
+                return -1;
+            }
+            mainshare_scan();
+        }
+        else
+        {
+            // "Invalid argument %s%s"
+            WRMSG( HHC02205, "E", argv[argc-1], "" );
+            return -1;
+        }
+
+        if (!MLVL( VERBOSE ))
+            return 0;
+#endif
+    }
+
+    if (!sysblk.mainshare)
+        STRLCPY( state, "OFF" );
+    else if (sysblk.mainshareint)
+        MSGBUF( state, "ON, scan every %"PRIu32"s", sysblk.mainshareint );
+    else
+        STRLCPY( state, "ON" );
+
+    fmt_memsize( sysblk.zerobytes, zero, sizeof( zero ));
+    fmt_host_pages( "/proc/self/ksm_merging_pages", "%"SCNu64, merged, sizeof( merged ));
+    fmt_host_pages( "/proc/self/statm", "%*u %"SCNu64, rss, sizeof( rss ));
+
+    // "Page sharing %s; %s of zero frames returned to the host, %s merged by the host, host RSS %s"
+    WRMSG( HHC17017, "I", state, zero, merged, rss );
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* storshm command - main storage in a shared memory object          */
+/*-------------------------------------------------------------------*/
+int storshm_cmd( int argc, char* argv[], char* cmdline )
+{
+    char  path[ MAX_PATH ];
+    int   rc;
+
+    UNREFERENCED( cmdline );
+
+    UPPER_ARGV_0( argv );
+
+    if (argc > 2)
+    {
+        // "Invalid number of arguments for %s"
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if (argc == 2)
+    {
+#if defined( _MSVC_ )
+        // "%s support not included in this engine build"
+        WRMSG( HHC17015, "E", "Shared storage" );
+        return -1;
+#else
+        if (!CMD( argv[1], off, 3 )
+            && storshm_path( path, sizeof( path ), argv[1] ) != 0)
+        {
+            // "Invalid argument %s%s"
+            WRMSG( HHC02205, "E", argv[1], "" );
+            return -1;
+        }
+
+        rc = configure_storshm( CMD( argv[1], off, 3 ) ? NULL : argv[1] );
+
+        if (HERRCPUONL == rc)
+        {
+            // "CPUs must be offline or stopped"
+            WRMSG( HHC02389, "E" );
+            return rc;
+        }
+        else if (rc)
+        {
+            // "Configure storage error %d"
+            WRMSG( HHC02388, "E", rc );
+            return rc;
+        }
+
+        if (MLVL( VERBOSE ))
+        {
+            // "%-14s set to %s"
+            WRMSG( HHC02204, "I", argv[0], sysblk.storshm ? argv[1] : "OFF" );
+        }
+        return 0;
+#endif
+    }
+
+    if (!sysblk.storshm
+        || storshm_path( path, sizeof( path ), sysblk.storshmname ) != 0)
+        STRLCPY( path, "OFF" );
+
+    // "%-14s: %s"
+    WRMSG( HHC02203, "I", argv[0], path );
+    return 0;
+}
+
 /*-------------------------------------------------------------------*/
 /* shcmdopt command                                                  */
 /*-------------------------------------------------------------------*/
@@ -4760,7 +5648,7 @@ int cp_updt_cmd(int argc, char *argv[], char *cmdline)
 
 /*-------------------------------------------------------------------*/
 /* codepage xxxxxxxx command      *** KEEP AFTER CP_UPDT_CMD ***     */
-/* Note: maint can never be a code page name                         */
+/* Note: maint and load can never be code page names                 */
 /*-------------------------------------------------------------------*/
 int codepage_cmd( int argc, char* argv[], char* cmdline )
 {
@@ -4776,16 +5664,38 @@ int codepage_cmd( int argc, char* argv[], char* cmdline )
         argv++;
         rc = cp_updt_cmd( argc, argv, NULL );
     }
-    else if (argc == 2 && valid_codepage_name( argv[1] ))
+    /* Load a UCM mapping table */
+    else if ((argc == 3 || argc == 4) && CMD( argv[1], LOAD, 4 ))
+    {
+        rc = load_codepage_ucm( argv[2], argc == 4 ? argv[3] : NULL );
+    }
+    /* Change only the host encoding */
+    else if (argc == 2 && (CMD( argv[1], UTF8, 4 ) || CMD( argv[1], SBCS, 4 )))
+    {
+        set_codepage_utf8( CMD( argv[1], UTF8, 4 ));
+        // "Codepage: Host encoding is %s"
+        WRMSG( HHC01498, "I", codepage_utf8() ? "UTF-8" : "single byte" );
+    }
+    else if ((argc == 2 || argc == 3) && valid_codepage_name( argv[1] )
+         && (argc == 2 || CMD( argv[2], UTF8, 4 ) || CMD( argv[2], SBCS, 4 )))
     {
         /* Update codepage if valid operand is specified */
         set_codepage( argv[1] );
+
+        if (argc == 3)
+        {
+            set_codepage_utf8( CMD( argv[2], UTF8, 4 ));
+            // "Codepage: Host encoding is %s"
+            WRMSG( HHC01498, "I", codepage_utf8() ? "UTF-8" : "single byte" );
+        }
     }
     else if (argc == 1)
     {
         const char* cp = query_codepage();
         // "Codepage is %s"
         WRMSG( HHC01476, "I", cp ? cp : "(NULL)" );
+        // "Codepage: Host encoding is %s"
+        WRMSG( HHC01498, "I", codepage_utf8() ? "UTF-8" : "single byte" );
     }
     else
     {
@@ -50,6 +50,7 @@ int ARCH_DEP( archdep_pr_cmd )( REGS *regs, int argc, char *argv[] )
         }
 
         regs->PX = px;              /* set NEW prefix register value */
+        storshm_cpu( regs->cpuad );
     }
     else
         px = regs->PX;              /* retrieve CURRENT prefix value */
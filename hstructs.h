@@ -234,6 +234,10 @@ struct REGS {                           /* Processor registers       */
 #define ET_G    et.D
 #define ET_L    et.F.L.F
 
+        U64     mckcode;                /* Injected mach check code  */
+        U32     mckxdmg;                /* Injected ext damage code  */
+        RADR    mckfsta;                /* Injected failing stor addr*/
+
         unsigned int                    /* Flags (cpu thread only)   */
                 execflag:1,             /* 1=EXecuted instruction    */
                 exrl:1,                 /* 1=EXRL, 0=EX instruction  */
@@ -653,6 +657,22 @@ struct SYSBLK {
         BYTE   *storkeys;               /* -> Main storage key array */
         u_int   lock_mainstor:1;        /* Request mainstor to lock  */
         u_int   mainstor_locked:1;      /* Main storage locked       */
+        u_int   main_image:1;           /* Mapped from a clone image */
+        u_int   cmma:1;                 /* 1=ESSA enabled (CMMA)     */
+        LOCK    cmmalock;               /* CMMA state lock           */
+        BYTE   *cmmastate;              /* -> ESSA state of frames   */
+        U64     cmmarunbeg;             /* Unused frames not yet...  */
+        U64     cmmarunend;             /* ...returned to the host   */
+        U64     cmmaunused;             /* Frames in unused state    */
+        U64     releasedbytes;          /* Bytes returned to host    */
+        u_int   mainshare:1;            /* 1=Share host pages        */
+        LOCK    mainsharelock;          /* Zero frame scan lock      */
+        U32     mainshareint;           /* Scan interval in seconds  */
+        TID     mainsharetid;           /* Zero frame scanner thread */
+        BYTE   *mainsharemap;           /* -> Zero frame scan flags  */
+        U64     zerobytes;              /* Zero bytes given to host  */
+        char   *storshmname;            /* Shared storage object name*/
+        struct STORSHM_HDR *storshm;    /* -> Shared storage header  */
         U32     xpndsize;               /* Expanded size in 4K pages */
         BYTE   *xpndstor;               /* -> Expanded storage       */
         u_int   lock_xpndstor:1;        /* Request xpndstor to lock  */
@@ -935,6 +955,7 @@ atomic_update64( &sysblk.txf_stats[ contran ? 1 : 0 ].txf_ ## ctr, +1 )
         U32     crwalloc;               /* #of entries allocated     */
         U32     crwcount;               /* #of entries queued        */
         U32     crwindex;               /* CRW queue index           */
+        int     mckframes;              /* #of mck injection frames  */
         IOINT  *iointq;                 /* I/O interrupt queue       */
         DEVBLK *ioq;                    /* I/O queue                 */
         LOCK    ioqlock;                /* I/O queue lock            */
@@ -1196,6 +1217,64 @@ struct CHPBLK {
         BYTE    chptype;
 };
 
+/*-------------------------------------------------------------------*/
+/* Device service time model                                         */
+/*-------------------------------------------------------------------*/
+struct SVCMODEL {
+        U32     overhead;               /* Fixed overhead (usecs)    */
+        U32     seekmin;                /* Track-to-track seek (us)  */
+        U32     seekmax;                /* Full stroke seek (usecs)  */
+        U32     rpm;                    /* Rotational speed or zero  */
+        U32     xfer;                   /* Device data rate (KB/sec) */
+        U32     hitpct;                 /* Cache hit percentage      */
+        U32     hittime;                /* Cache hit access (usecs)  */
+        BYTE    cu;                     /* Control unit number       */
+        BYTE    paths;                  /* Control unit paths (1-8)  */
+#define SVC_MAXPATHS    8               /* Maximum paths per CU      */
+};
+
+/*-------------------------------------------------------------------*/
+/* Device fault injection rule                                       */
+/*-------------------------------------------------------------------*/
+struct FLTRULE {
+        FLTRULE *next;                  /* Next rule in chain        */
+        int     id;                     /* Rule number               */
+        U16     lcss;                   /* Logical channel subsystem */
+        U16     devnum;                 /* Device number             */
+        int     ccw;                    /* CCW opcode or -1 for any  */
+        U32     lo;                     /* Lowest track/block        */
+        U32     hi;                     /* Highest track/block       */
+        U32     nth;                    /* Inject on nth match only  */
+        U32     every;                  /* Inject on every nth match */
+        U32     prob;                   /* Percent chance to inject  */
+        U32     seed;                   /* Random number state       */
+        U32     limit;                  /* Maximum injections or 0   */
+        U32     delay;                  /* FLT_DELAY time (usecs)    */
+        U32     matches;                /* Number of matching CCWs   */
+        U32     injected;               /* Number of injections      */
+        BYTE    action;                 /* Fault to inject           */
+#define FLT_UC          1               /* Unit check with sense     */
+#define FLT_BUSY        2               /* Device busy               */
+#define FLT_DELAY       3               /* Delay before execution    */
+#define FLT_NOINTR      4               /* Drop ending interrupt     */
+        BYTE    senselen;               /* Number of sense bytes     */
+        BYTE    sense[32];              /* FLT_UC sense bytes        */
+};
+
+/*-------------------------------------------------------------------*/
+/* Machine check injection rule                                      */
+/*-------------------------------------------------------------------*/
+struct MCKRULE {
+        MCKRULE *next;                  /* Next rule in chain        */
+        int     id;                     /* Rule number               */
+        int     cpu;                    /* CPU address or -1 for any */
+        U64     mcic;                   /* Machine check int code    */
+        U32     xdmg;                   /* External damage code      */
+        RADR    frame;                  /* Absolute frame address    */
+        U32     limit;                  /* Maximum injections or 0   */
+        U32     injected;               /* Number of injections      */
+};
+
 
 /*-------------------------------------------------------------------*/
 /* Telnet Control Block                                              */
@@ -1366,6 +1445,8 @@ struct DEVBLK {                         /* Device configuration block*/
         SCSW    attnscsw;               /* ATTNsubchannel status word*/
         ESW     esw;                    /* Extended status word      */
         BYTE    ecw[32];                /* Extended control word     */
+        EMW     emw;                    /* Extended measurement word */
+        U64     mba;                    /* Format-1 meas. block addr */
         U32     numsense;               /* Number of sense bytes     */
         BYTE    sense[256];             /* Sense bytes 3480+ 64 bytes*/
         U32     numdevid;               /* Number of device id bytes */
@@ -1439,6 +1520,33 @@ struct DEVBLK {                         /* Device configuration block*/
         /*  Execute Channel Pgm Counts */
         U64     excps;                  /* Number of channel pgms Ex */
 
+        /*  Channel subsystem measurement (host ETOD clock values)   */
+        TOD     mbstart;                /* Start or resume pending   */
+        TOD     mbconnect;              /* Device connected          */
+        U64     mbtime[7];              /* Unstored interval times   */
+#define MB_DCT          0               /* Device connect time       */
+#define MB_FPT          1               /* Function pending time     */
+#define MB_DDT          2               /* Device disconnect time    */
+#define MB_CUQT         3               /* Control unit queuing time */
+#define MB_DAOT         4               /* Device active only time   */
+#define MB_DBT          5               /* Device busy time          */
+#define MB_ICRT         6               /* Initial cmd response time */
+        BYTE    mbqueued;               /* Start queued behind others*/
+
+        /*  Device service time model                                */
+        SVCMODEL svc;                   /* Model parameters          */
+        U64     svcbytes;               /* Bytes moved this program  */
+        U64     svcusecs;               /* Modelled usecs this pgm   */
+        U64     svccount;               /* Channel programs modelled */
+        U64     svcmodel;               /* Total modelled usecs      */
+        U64     svcactual;              /* Total actual usecs        */
+        U64     svccuq;                 /* Total CU queuing usecs    */
+        U32     svcseed;                /* Random number state       */
+        U32     svccyl;                 /* Last modelled cylinder    */
+        BYTE    svcon;                  /* Service model active      */
+        BYTE    svchit;                 /* 1=cache hit, 2=miss       */
+        BYTE    fltdrop;                /* Drop ending interrupt     */
+
         /*  Device dependent data (generic)                          */
         void    *dev_data;
 
@@ -1837,6 +1945,9 @@ struct DEVBLK {                         /* Device configuration block*/
                                         /* Line above ISW20030819-1  */
         u_int   ckdfakewr:1;            /* 1=Fake successful write
                                              for read only file      */
+        u_int   ckdsfnew:1;             /* 1=Existing shadow files are
+                                             read only; always start
+                                             a new one               */
         BYTE    ckdnvs:1;               /* 1=NVS defined             */
         BYTE    ckdraid:1;              /* 1=RAID device             */
         U16     ckdssdlen;              /* #of bytes of data prepared
@@ -140,7 +140,12 @@ DLL_EXPORT void html_header(WEBBLK *webblk)
     if (webblk->request_type != REQTYPE_POST)
         hprintf(webblk->sock,"Expires: 0\n");
 
-    hprintf(webblk->sock,"Content-type: text/html\n\n");
+    /* Guest data in pages (console messages etc) is UTF-8 encoded
+       when the host encoding is UTF-8 */
+    if (codepage_utf8())
+        hprintf(webblk->sock,"Content-type: text/html; charset=UTF-8\n\n");
+    else
+        hprintf(webblk->sock,"Content-type: text/html\n\n");
 
     if (!html_include(webblk,HTML_HEADER))
         hprintf(webblk->sock,"<HTML>\n<HEAD>\n<TITLE>Hercules</TITLE>\n</HEAD>\n<BODY>\n\n");
@@ -187,6 +187,9 @@ typedef struct ZPBLK     ZPBLK;     // Zone Parameter Block
 typedef struct TELNET    TELNET;    // Telnet Control Block
 typedef struct DEVBLK    DEVBLK;    // Device configuration block
 typedef struct CHPBLK    CHPBLK;    // Channel Path config block
+typedef struct SVCMODEL  SVCMODEL;  // Device service time model
+typedef struct FLTRULE   FLTRULE;   // Device fault injection rule
+typedef struct MCKRULE   MCKRULE;   // Machine check injection rule
 typedef struct IOINT     IOINT;     // I/O interrupt queue
 
 typedef struct GSYSINFO  GSYSINFO;  // Ebcdic machine information
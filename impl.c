@@ -891,6 +891,8 @@ int     rc;
     initialize_lock( &sysblk.config   );
     initialize_lock( &sysblk.todlock  );
     initialize_lock( &sysblk.mainlock );
+    initialize_lock( &sysblk.cmmalock );
+    initialize_lock( &sysblk.mainsharelock );
     initialize_lock( &sysblk.intlock  );
     initialize_lock( &sysblk.iointqlk );
     initialize_lock( &sysblk.sigplock );
@@ -184,6 +184,7 @@ int     b2;                             /* Effective addr base       */
 VADR    effective_addr2;                /* Effective address         */
 DEVBLK* dev;                            /* -> device block           */
 PMCW    pmcw;                           /* Path management ctl word  */
+U64     mba = 0;                        /* Measurement block address */
 
     S( inst, regs, b2, effective_addr2 );
 
@@ -212,9 +213,24 @@ PMCW    pmcw;                           /* Path management ctl word  */
 #endif
         || (pmcw.flag26 != 0)
         || (pmcw.flag27 & PMCW27_RESV)
+#if !defined( FEATURE_001_ZARCH_INSTALLED_FACILITY )
+        || (pmcw.flag27 & (PMCW27_F | PMCW27_X))
+#endif
     )
         ARCH_DEP( program_interrupt )( regs, PGM_OPERAND_EXCEPTION );
 
+#if defined( FEATURE_001_ZARCH_INSTALLED_FACILITY )
+    /* Fetch the format-1 measurement block address, which must be
+       on a 64-byte boundary */
+    if (pmcw.flag27 & PMCW27_F)
+    {
+        mba = ARCH_DEP( vfetch8 )( (effective_addr2 + offsetof( SCHIB, moddep ))
+                                   & ADDRESS_MAXWRAP( regs ), b2, regs );
+        if (mba & 0x3F)
+            ARCH_DEP( program_interrupt )( regs, PGM_OPERAND_EXCEPTION );
+    }
+#endif
+
     /* Program check if the ssid including lcss is invalid */
     SSID_CHECK( regs );
 
@@ -295,6 +311,9 @@ PMCW    pmcw;                           /* Path management ctl word  */
         dev->pmcw.flag26  =  pmcw.flag26;
         dev->pmcw.flag27  =  pmcw.flag27;
 
+        /* Update the format-1 measurement block address */
+        dev->mba = mba;
+
 #if defined( _FEATURE_IO_ASSIST )
         /* Relate the device storage view to the requested zone */
         {
@@ -792,6 +811,12 @@ SCHIB   schib;                          /* Subchannel information blk*/
 
     memset( schib.moddep, 0, sizeof( schib.moddep ));
 
+#if defined( FEATURE_001_ZARCH_INSTALLED_FACILITY )
+    /* Return the format-1 measurement block address */
+    if (schib.pmcw.flag27 & PMCW27_F)
+        STORE_DW( schib.moddep, dev->mba );
+#endif
+
     /* Store the subchannel information block */
     ARCH_DEP( vstorec )( &schib, sizeof(SCHIB)-1, effective_addr2,
                 b2, regs );
@@ -927,6 +952,7 @@ int     b2;                             /* Effective addr base       */
 VADR    effective_addr2;                /* Effective address         */
 DEVBLK* dev;                            /* -> device block           */
 IRB     irb;                            /* Interruption response blk */
+int     irblen;                         /* IRB length                */
 int     cc;                             /* Condition Code            */
 
     S( inst, regs, b2, effective_addr2 );
@@ -971,8 +997,13 @@ int     cc;                             /* Condition Code            */
         return;
     }
 
+    /* The extended measurement word is only stored when
+       the subchannel is enabled for it */
+    irblen = (dev->pmcw.flag27 & PMCW27_X) ? (int)sizeof( IRB )
+                                           : IRB_SIZE_NOEMW;
+
     /* validate operand before taking any action */
-    ARCH_DEP( validate_operand )( effective_addr2, b2, sizeof( IRB ) - 1,
+    ARCH_DEP( validate_operand )( effective_addr2, b2, irblen - 1,
                                   ACCTYPE_WRITE_SKP, regs );
 
     /* Perform serialization and checkpoint-synchronization */
@@ -983,7 +1014,7 @@ int     cc;                             /* Condition Code            */
     cc = test_subchan( regs, dev, &irb );
 
     /* Store the interruption response block */
-    ARCH_DEP( vstorec )( &irb, sizeof(IRB)-1, effective_addr2, b2, regs );
+    ARCH_DEP( vstorec )( &irb, irblen-1, effective_addr2, b2, regs );
 
     regs->psw.cc = cc;
 
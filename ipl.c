@@ -342,6 +342,9 @@ int ARCH_DEP( system_reset )( const int target_mode, const bool clear,
     sysblk.topchnge = 0;
 #endif
 
+    /* Tell shared storage viewers that storage was reset */
+    storshm_reset();
+
     /* Set the system state to "reset" */
     sysblk.sys_reset = TRUE;
 
@@ -621,6 +624,9 @@ int i, rc = 0;                          /* Array subscript           */
     regs->checkstop = 0;
     regs->sigp_reset = 0;
     regs->extccpu = 0;
+    regs->mckcode = 0;
+    regs->mckxdmg = 0;
+    regs->mckfsta = 0;
 #if defined( FEATURE_073_TRANSACT_EXEC_FACILITY )
     PTT_TXF( "TXF CPURES", 0, 0, regs->txf_tnd );
     /* EXIT SILENTLY from transactional execution mode */
@@ -698,6 +704,7 @@ int ARCH_DEP( initial_cpu_reset )( REGS* regs )
     regs->fpc    = 0;
     regs->PX     = 0;
     regs->psw.AMASK_G = AMASK24;
+    storshm_cpu( regs->cpuad );
 
     /* Ensure memory sizes are properly indicated */
     regs->mainstor = sysblk.mainstor;
@@ -958,8 +965,12 @@ void storage_clear()
 {
     if (!sysblk.main_clear)
     {
-        if (sysblk.mainstor) memset( sysblk.mainstor, 0x00, sysblk.mainsize );
+        /* (with page sharing the cleared storage goes back to the host) */
+        if (sysblk.mainstor && sysblk.mainshare)
+            release_storage( 0, sysblk.mainsize );
+        else if (sysblk.mainstor) memset( sysblk.mainstor, 0x00, sysblk.mainsize );
         if (sysblk.storkeys) memset( sysblk.storkeys, 0x00, sysblk.mainsize / _STORKEY_ARRAY_UNITSIZE );
+        cmma_reset();
         sysblk.main_clear = 1;
     }
 }
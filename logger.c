@@ -48,6 +48,8 @@ static FILE *logger_hrdcpy;             /* Hardcopy log or zero      */
 static int   logger_hrdcpyfd;           /* Hardcopt fd or -1         */
 static char  logger_filename[MAX_PATH];
 
+static LOGHOOK* logger_hooks[ LOG_MAXHOOKS ];  /* log stream hooks */
+
 /*********************************************************************/
 /*              log_read  -  read system log                         */
 /*********************************************************************/
@@ -307,6 +309,8 @@ DLL_EXPORT void logger_timestamped_logfile_write( const void* pBuff, size_t nByt
 static void* logger_thread( void* arg )
 {
     int bytes_read;
+    int i;
+    LOGHOOK* hooks[ LOG_MAXHOOKS ];     /* snapshot of logger_hooks  */
 
     UNREFERENCED( arg );
 
@@ -426,9 +430,19 @@ static void* logger_thread( void* arg )
                 if (nLeft)
                     logger_logfile_write( pLeft, nLeft );
             }
+
+            memcpy( hooks, logger_hooks, sizeof( hooks ));
         }
         release_lock( &logger_lock );
 
+        /* Pass the new log data to any interested hooks. This is done
+           without holding the lock so a hook may freely obtain locks
+           that other threads might hold while they issue messages. */
+        if (bytes_read)
+            for (i=0; i < LOG_MAXHOOKS; i++)
+                if (hooks[i])
+                    hooks[i]( logger_buffer + logger_currmsg, bytes_read );
+
         /* Increment buffer index to next available position */
         logger_currmsg += bytes_read;
 
@@ -725,6 +739,52 @@ DLL_EXPORT void log_wakeup( void* arg )
     }
 }
 
+/*********************************************************************/
+/*         log_hook_add / log_hook_del  -  log stream hooks          */
+/*********************************************************************/
+/* Register or remove a function to be called by the logger thread   */
+/* with each new chunk of log data. The data passed is NOT null      */
+/* terminated and a chunk need not end on a line boundary. Returns   */
+/* zero if successful or -1 if the maximum number of hooks has been  */
+/* reached. Adding a hook that is already registered is a no-op.     */
+/*********************************************************************/
+DLL_EXPORT int log_hook_add( LOGHOOK* hook )
+{
+    int i, slot = -1;
+
+    obtain_lock( &logger_lock );
+    {
+        for (i=0; i < LOG_MAXHOOKS; i++)
+        {
+            if (logger_hooks[i] == hook)
+            {
+                release_lock( &logger_lock );
+                return 0;
+            }
+            if (!logger_hooks[i] && slot < 0)
+                slot = i;
+        }
+        if (slot >= 0)
+            logger_hooks[ slot ] = hook;
+    }
+    release_lock( &logger_lock );
+
+    return slot < 0 ? -1 : 0;
+}
+
+DLL_EXPORT void log_hook_del( LOGHOOK* hook )
+{
+    int i;
+
+    obtain_lock( &logger_lock );
+    {
+        for (i=0; i < LOG_MAXHOOKS; i++)
+            if (logger_hooks[i] == hook)
+                logger_hooks[i] = NULL;
+    }
+    release_lock( &logger_lock );
+}
+
 /* is logger active */
 DLL_EXPORT int logger_isactive()
 {
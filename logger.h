@@ -48,6 +48,19 @@ LOGR_DLL_IMPORT void   log_wakeup      ( void* arg );
 LOGR_DLL_IMPORT char*  log_dsphrdcpy   ();
 LOGR_DLL_IMPORT int    logger_isactive ();
 
+/*-------------------------------------------------------------------*/
+/* log stream hooks: called by the logger thread for each chunk of   */
+/* new log data as soon as it has been read from the logger pipe.    */
+/* Hooks must NOT issue messages themselves and should return fast.  */
+/*-------------------------------------------------------------------*/
+
+#define LOG_MAXHOOKS    4           // max concurrently active hooks
+
+typedef void LOGHOOK( const char* msg, int msglen );
+
+LOGR_DLL_IMPORT int    log_hook_add    ( LOGHOOK* hook );
+LOGR_DLL_IMPORT void   log_hook_del    ( LOGHOOK* hook );
+
 #define TIMESTAMPLOG   (!sysblk.logoptnotime)
 #define DATESTAMPLOG   (!sysblk.logoptnodate)
 #define STAMPLOG       (TIMESTAMPLOG || DATESTAMPLOG)
@@ -28,6 +28,7 @@
 
 #include "hercules.h"
 #include "opcode.h"
+#include "inline.h"
 
 #ifndef _MACHCHK_C
 #define _MACHCHK_C
@@ -241,9 +242,103 @@ U32 crw = 0;
 
 } /* end function get_next_channel_report_word */
 
+/*-------------------------------------------------------------------*/
+/* Return the interrupt subclass bit(s) for a machine check code     */
+/*-------------------------------------------------------------------*/
+U32 mck_subclass( U64 mcic )
+{
+U32 bits = 0;
+
+    /* System damage and instruction processing damage are exigent
+       and are only subject to the PSW machine check mask */
+    if (mcic & (MCIC_SD | MCIC_P))
+        bits |= BIT( IC_MCKEXIG );
+    if (mcic & MCIC_SR)
+        bits |= BIT( IC_RCVYRPT );
+    if (mcic & MCIC_DG)
+        bits |= BIT( IC_DGRDRPT );
+    if (mcic & (MCIC_CD | MCIC_ED | MCIC_SP | MCIC_CK))
+        bits |= BIT( IC_XDMGRPT );
+    if (mcic & MCIC_W)
+        bits |= BIT( IC_WARNING );
+
+    return bits;
+
+} /* end function mck_subclass */
+
+
+/*-------------------------------------------------------------------*/
+/* Make an injected machine check pending on a CPU                   */
+/*                                                                   */
+/* The condition is presented when the CPU is next enabled for its   */
+/* subclass.  An exigent condition arriving while an operating CPU   */
+/* is disabled for machine checks puts it in the check-stop state.   */
+/*                                                                   */
+/* This routine must be called with the sysblk.intlock held          */
+/*-------------------------------------------------------------------*/
+void mck_make_pending( REGS* regs, U64 mcic, U32 xdmg, RADR fsta )
+{
+U32 bits = mck_subclass( mcic );
+
+    regs->mckcode |= mcic;
+    regs->mckxdmg |= xdmg;
+    if (mcic & MCIC_FA)
+        regs->mckfsta = fsta;
+
+    // "Processor %s%02X: machine check code %16.16"PRIX64" made pending"
+    WRMSG( HHC17021, "I", PTYPSTR( regs->cpuad ), regs->cpuad, regs->mckcode );
+
+    if ((bits & BIT( IC_MCKEXIG )) && !MACHMASK( &regs->psw )
+     && regs->cpustate == CPUSTATE_STARTED)
+    {
+        regs->checkstop = 1;
+        regs->cpustate  = CPUSTATE_STOPPING;
+        ON_IC_INTERRUPT( regs );
+        WAKEUP_CPU( regs );
+
+        // "Processor %s%02X: check-stopped by exigent machine check ..."
+        WRMSG( HHC17022, "W", PTYPSTR( regs->cpuad ), regs->cpuad );
+        return;
+    }
+
+    ON_IC_MCK( regs, bits );
+    WAKEUP_CPU( regs );
+
+} /* end function mck_make_pending */
+
 #endif /* _MACHCHK_C */
 
 
+/*-------------------------------------------------------------------*/
+/* Return the register validity bits of a machine check code         */
+/*-------------------------------------------------------------------*/
+U64 ARCH_DEP( mck_validity )( void )
+{
+    return MCIC_WP |
+           MCIC_MS |
+           MCIC_PM |
+           MCIC_IA |
+#ifdef FEATURE_HEXADECIMAL_FLOATING_POINT
+           MCIC_FP |
+#endif /*FEATURE_HEXADECIMAL_FLOATING_POINT*/
+           MCIC_GR |
+           MCIC_CR |
+           MCIC_ST |
+#ifdef FEATURE_ACCESS_REGISTERS
+           MCIC_AR |
+#endif /*FEATURE_ACCESS_REGISTERS*/
+#if defined(FEATURE_001_ZARCH_INSTALLED_FACILITY) && defined(FEATURE_EXTENDED_TOD_CLOCK)
+           MCIC_PR |
+#endif /*defined(FEATURE_001_ZARCH_INSTALLED_FACILITY) && defined(FEATURE_EXTENDED_TOD_CLOCK)*/
+#if defined(FEATURE_BINARY_FLOATING_POINT)
+           MCIC_XF |
+#endif /*defined(FEATURE_BINARY_FLOATING_POINT)*/
+           MCIC_CT |
+           MCIC_CC ;
+
+} /* end function mck_validity */
+
+
 /*-------------------------------------------------------------------*/
 /* Present Machine Check Interrupt                                   */
 /* Input:                                                            */
@@ -255,8 +350,9 @@ U32 crw = 0;
 /* Return code:                                                      */
 /*      0=No machine check, 1=Machine check presented                */
 /*                                                                   */
-/* Generic machine check function.  At the momement the only         */
-/* supported machine check is the channel report.                    */
+/* Generic machine check function.  Conditions made pending by the   */
+/* mck command or by a machine check injection frame are presented   */
+/* first, then the channel report.                                   */
 /*                                                                   */
 /* This routine must be called with the sysblk.intlock held          */
 /*-------------------------------------------------------------------*/
@@ -264,39 +360,29 @@ int ARCH_DEP(present_mck_interrupt)(REGS *regs, U64 *mcic, U32 *xdmg, RADR *fsta
 {
 int rc = 0;
 
-    UNREFERENCED_370(regs);
-    UNREFERENCED_370(mcic);
-    UNREFERENCED_370(xdmg);
-    UNREFERENCED_370(fsta);
+    /* Present an injected machine check if we are enabled for
+       any of its interrupt subclasses */
+    if (regs->mckcode
+     && (regs->ints_state & regs->ints_mask & mck_subclass( regs->mckcode )))
+    {
+        *mcic = regs->mckcode;
+        *xdmg = regs->mckxdmg;
+        *fsta = regs->mckfsta;
+        regs->mckcode = 0;
+        regs->mckxdmg = 0;
+        regs->mckfsta = 0;
+        OFF_IC_MCK( regs );
+        return 1;
+    }
 
 #ifdef FEATURE_CHANNEL_SUBSYSTEM
     /* If there is a crw pending and we are enabled for the channel
        report interrupt subclass then process the interrupt */
     if( OPEN_IC_CHANRPT(regs) )
     {
-        *mcic =  MCIC_CP |
-               MCIC_WP |
-               MCIC_MS |
-               MCIC_PM |
-               MCIC_IA |
-#ifdef FEATURE_HEXADECIMAL_FLOATING_POINT
-               MCIC_FP |
-#endif /*FEATURE_HEXADECIMAL_FLOATING_POINT*/
-               MCIC_GR |
-               MCIC_CR |
-               MCIC_ST |
-#ifdef FEATURE_ACCESS_REGISTERS
-               MCIC_AR |
-#endif /*FEATURE_ACCESS_REGISTERS*/
-#if defined(FEATURE_001_ZARCH_INSTALLED_FACILITY) && defined(FEATURE_EXTENDED_TOD_CLOCK)
-               MCIC_PR |
-#endif /*defined(FEATURE_001_ZARCH_INSTALLED_FACILITY) && defined(FEATURE_EXTENDED_TOD_CLOCK)*/
-#if defined(FEATURE_BINARY_FLOATING_POINT)
-               MCIC_XF |
-#endif /*defined(FEATURE_BINARY_FLOATING_POINT)*/
-               MCIC_AP |
-               MCIC_CT |
-               MCIC_CC ;
+        *mcic = MCIC_CP |
+                ARCH_DEP( mck_validity )() |
+                MCIC_AP ;
         *xdmg = 0;
         *fsta = 0;
         OFF_IC_CHANRPT;
@@ -311,6 +397,83 @@ int rc = 0;
 } /* end function present_mck_interrupt */
 
 
+/*-------------------------------------------------------------------*/
+/* Mark or unmark a machine check injection frame                    */
+/*                                                                   */
+/* The frame is flagged with the internal STORKEY_BADFRM bit and any */
+/* TLB entries for it are invalidated so that the next reference to  */
+/* it by any CPU goes through full address translation again.        */
+/*                                                                   */
+/* This routine must be called with the sysblk.intlock held          */
+/*-------------------------------------------------------------------*/
+void ARCH_DEP( mck_mark_frame )( RADR aaddr, bool bad )
+{
+REGS   *cregs;                          /* CPU being examined        */
+int     cpu;
+
+    aaddr &= STORAGE_KEY_PAGEMASK;
+
+    if (bad)
+        ARCH_DEP( _or_storage_key )(  aaddr, STORKEY_BADFRM, SKEY_K );
+    else
+        ARCH_DEP( _and_storage_key )( aaddr, STORKEY_BADFRM, SKEY_K );
+
+    for (cpu=0; cpu < sysblk.hicpu; cpu++)
+    {
+        if (!IS_CPU_ONLINE( cpu ))
+            continue;
+
+        cregs = sysblk.regs[ cpu ];
+
+        /* A waiting CPU can be done right now, otherwise the CPU
+           does it itself when it next checks for interrupts */
+        if (sysblk.waiting_mask & CPU_BIT( cpu ))
+            ARCH_DEP( invalidate_tlbe )( cregs,
+                cregs->mainstor + (aaddr & PAGEFRAME_PAGEMASK) );
+        else
+        {
+            ON_IC_INTERRUPT( cregs );
+
+            if (!cregs->invalidate)
+            {
+                cregs->invalidate = 1;
+                cregs->invalidate_main = cregs->mainstor
+                                       + (aaddr & PAGEFRAME_PAGEMASK);
+            }
+            else
+                cregs->invalidate_main = NULL;
+        }
+    }
+
+} /* end function mck_mark_frame */
+
+
+/*-------------------------------------------------------------------*/
+/* Reference to a frame marked unusable: machine check if a rule     */
+/* for the frame calls for one.  Otherwise returns to the caller     */
+/* and the reference proceeds normally.                              */
+/*-------------------------------------------------------------------*/
+void ARCH_DEP( mck_bad_frame )( REGS* regs, RADR aaddr )
+{
+U64     mcic;                           /* Mach.check interrupt code */
+U32     xdmg;                           /* External damage code      */
+
+    if (regs->ghostregs || !mck_frame_hit( regs, aaddr, &mcic, &xdmg ))
+        return;
+
+    OBTAIN_INTLOCK( regs );
+    {
+        mck_make_pending( regs, mcic, xdmg, aaddr );
+    }
+    RELEASE_INTLOCK( regs );
+
+    /* Abandon the instruction; the machine check is taken (or the
+       CPU check-stopped) before the next instruction is executed */
+    longjmp( regs->progjmp, SIE_NO_INTERCEPT );
+
+} /* end function mck_bad_frame */
+
+
 /*-------------------------------------------------------------------*/
 /*         (all ARCH_DEP code should precede this point)             */
 /*-------------------------------------------------------------------*/
@@ -332,4 +495,210 @@ int rc = 0;
 /*           (only NON-arch_dep code after this point)               */
 /*-------------------------------------------------------------------*/
 
+/*-------------------------------------------------------------------*/
+/*                MACHINE CHECK INJECTION                            */
+/*-------------------------------------------------------------------*/
+/* Rules set by the mck command mark a frame of main storage as      */
+/* unusable.  A CPU referencing the frame through address            */
+/* translation takes the rule's machine check instead, with the      */
+/* failing storage address set to the referenced location, until the */
+/* rule's limit (if any) is reached.  A CPU only has one injected    */
+/* machine check outstanding at a time, so a reference made while    */
+/* the CPU is disabled for the condition proceeds normally.          */
+/*-------------------------------------------------------------------*/
+static LOCK     mck_lock;               /* Protects the rule chain   */
+static bool     mck_inited = false;
+static MCKRULE* mck_rules  = NULL;      /* Chain of rules            */
+static int      mck_nextid = 1;         /* Next rule number          */
+
+/*-------------------------------------------------------------------*/
+/* Register validity bits for the current architecture mode          */
+/*-------------------------------------------------------------------*/
+U64 mck_validity()
+{
+    switch (sysblk.arch_mode)
+    {
+#if defined( _370 )
+    case ARCH_370_IDX: return s370_mck_validity();
+#endif
+#if defined( _390 )
+    case ARCH_390_IDX: return s390_mck_validity();
+#endif
+#if defined( _900 )
+    case ARCH_900_IDX: return z900_mck_validity();
+#endif
+    default: CRASH();
+    }
+    UNREACHABLE_CODE( return 0 );
+}
+
+/* Mark or unmark a frame for the current architecture mode */
+static void mck_mark( RADR aaddr, bool bad )
+{
+    switch (sysblk.arch_mode)
+    {
+#if defined( _370 )
+    case ARCH_370_IDX: s370_mck_mark_frame( aaddr, bad ); break;
+#endif
+#if defined( _390 )
+    case ARCH_390_IDX: s390_mck_mark_frame( aaddr, bad ); break;
+#endif
+#if defined( _900 )
+    case ARCH_900_IDX: z900_mck_mark_frame( aaddr, bad ); break;
+#endif
+    default: CRASH();
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/* Make a machine check pending on a CPU now; returns 0, or -1 if    */
+/* the CPU is not online                                             */
+/*-------------------------------------------------------------------*/
+int mck_inject( int cpu, U64 mcic, U32 xdmg, RADR fsta )
+{
+    OBTAIN_INTLOCK( NULL );
+    {
+        if (cpu < 0 || cpu >= sysblk.maxcpu || !IS_CPU_ONLINE( cpu ))
+        {
+            RELEASE_INTLOCK( NULL );
+            return -1;
+        }
+        mck_make_pending( sysblk.regs[ cpu ], mcic, xdmg, fsta );
+    }
+    RELEASE_INTLOCK( NULL );
+
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Add a machine check rule and mark its frame; returns the rule     */
+/* number                                                            */
+/*-------------------------------------------------------------------*/
+int mck_add( const MCKRULE* rule )
+{
+    MCKRULE  *new, **pp;
+    int       id;
+
+    if (!mck_inited)
+    {
+        initialize_lock( &mck_lock );
+        mck_inited = true;
+    }
+
+    if (!(new = malloc( sizeof( MCKRULE ))))
+        return -1;
+
+    *new = *rule;
+    new->next     = NULL;
+    new->frame   &= STORAGE_KEY_PAGEMASK;
+    new->injected = 0;
+
+    OBTAIN_INTLOCK( NULL );
+    obtain_lock( &mck_lock );
+    {
+        id = new->id = mck_nextid++;
+        for (pp = &mck_rules; *pp; pp = &(*pp)->next);
+        *pp = new;
+        mck_mark( new->frame, true );
+        sysblk.mckframes++;
+    }
+    release_lock( &mck_lock );
+    RELEASE_INTLOCK( NULL );
+
+    return id;
+}
+
+/*-------------------------------------------------------------------*/
+/* Delete a machine check rule (id 0 = all) and unmark its frame     */
+/* unless another rule still uses it; returns the number deleted     */
+/*-------------------------------------------------------------------*/
+int mck_del( int id )
+{
+    MCKRULE  *rule, *other, **pp;
+    int       n = 0;
+
+    if (!mck_inited)
+        return 0;
+
+    OBTAIN_INTLOCK( NULL );
+    obtain_lock( &mck_lock );
+    {
+        for (pp = &mck_rules; (rule = *pp); )
+        {
+            if (!id || rule->id == id)
+            {
+                *pp = rule->next;
+                for (other = mck_rules; other; other = other->next)
+                    if (other->frame == rule->frame)
+                        break;
+                if (!other)
+                    mck_mark( rule->frame, false );
+                sysblk.mckframes--;
+                free( rule );
+                n++;
+            }
+            else
+                pp = &rule->next;
+        }
+    }
+    release_lock( &mck_lock );
+    RELEASE_INTLOCK( NULL );
+
+    return n;
+}
+
+/*-------------------------------------------------------------------*/
+/* Copy the nth (from zero) machine check rule; false if none        */
+/*-------------------------------------------------------------------*/
+bool mck_query( int n, MCKRULE* copy )
+{
+    MCKRULE  *rule = NULL;
+
+    if (!mck_inited)
+        return false;
+
+    obtain_lock( &mck_lock );
+    {
+        for (rule = mck_rules; rule && n > 0; rule = rule->next, n--);
+        if (rule)
+            *copy = *rule;
+    }
+    release_lock( &mck_lock );
+
+    return rule != NULL;
+}
+
+/*-------------------------------------------------------------------*/
+/* Find the rule for a CPU referencing a marked frame.  Returns true */
+/* with the machine check to be made pending if a rule applies.      */
+/*-------------------------------------------------------------------*/
+bool mck_frame_hit( REGS* regs, RADR aaddr, U64* mcic, U32* xdmg )
+{
+    MCKRULE  *rule;
+    bool      hit = false;
+
+    /* Only one injected machine check at a time per CPU */
+    if (!mck_inited || regs->mckcode)
+        return false;
+
+    obtain_lock( &mck_lock );
+    for (rule = mck_rules; rule && !hit; rule = rule->next)
+    {
+        if (0
+            || rule->frame != (aaddr & STORAGE_KEY_PAGEMASK)
+            || (rule->cpu >= 0 && rule->cpu != regs->cpuad)
+            || (rule->limit && rule->injected >= rule->limit)
+        )
+            continue;
+
+        rule->injected++;
+        *mcic = rule->mcic | MCIC_FA;
+        *xdmg = rule->xdmg;
+        hit = true;
+    }
+    release_lock( &mck_lock );
+
+    return hit;
+}
+
 #endif /* !defined( _GEN_ARCH ) */
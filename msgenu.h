@@ -1114,7 +1114,10 @@ LOGM_DLL_IMPORT int  panel_command_capture( char* cmd, char** resp, bool quiet )
 #define HHC01493 "Codepage: Tables are transparent"
 #define HHC01494 "Crypto: '%s' failed: %s"
 #define HHC01495 "Crypto: **WARNING** Default insecure 'rand()' API being used"
-//efine HHC01496 - HHC01499 (available)
+#define HHC01496 "Codepage: Error loading %s line %d: %s"
+#define HHC01497 "Codepage: %s loaded from %s: %d single byte and %d double byte mappings"
+#define HHC01498 "Codepage: Host encoding is %s"
+//efine HHC01499 (available)
 
 // reserve 015xx for Hercules dynamic loader
 #define HHC01500 "HDL: begin shutdown sequence"
@@ -1296,7 +1299,16 @@ LOGM_DLL_IMPORT int  panel_command_capture( char* cmd, char** resp, bool quiet )
 #define HHC02020 "SR: value error, incorrect length"
 #define HHC02021 "SR: string error, incorrect length"
 #define HHC02022 "SR: error loading CRW queue: not enough memory for %d CRWs"
-//efine HHC02023 - HHC02099 (available)
+#define HHC02023 "SR: migration %s %s"
+#define HHC02024 "SR: migration pass %d: %"PRIu64" pages sent, %s change tracking"
+#define HHC02025 "SR: migration to %s complete: %"PRIu64" pages sent, downtime %"PRIu64" ms"
+#define HHC02026 "SR: migration from %s complete; guest resumed"
+#define HHC02027 "SR: migration failed: %s"
+#define HHC02028 "SR: migration to %s not confirmed; processors left stopped"
+#define HHC02029 "SR: clone snapshot written to %s; guest stopped for %"PRIu64" ms"
+#define HHC02030 "SR: resumed as clone %d of %s"
+#define HHC02031 "SR: clone failed: %s"
+//efine HHC02032 - HHC02099 (available)
 
 // reserve 021xx: misc
 #define HHC02100 "Logger: log not active"
@@ -1463,7 +1475,15 @@ LOGM_DLL_IMPORT int  panel_command_capture( char* cmd, char** resp, bool quiet )
 #define HHC02347 "No %s devices found"
 //efine HHC02348 (available)
 //efine HHC02349 (available)
-//efine HHC02350 - HHC02359 (available)
+#define HHC02350 "%1d:%04X service time model: %s"
+#define HHC02351 "%1d:%04X programs %"PRIu64", average modelled %"PRIu64" us, actual %"PRIu64" us, CU queuing %"PRIu64" us"
+#define HHC02352 "CHPID %02X bandwidth %s"
+#define HHC02353 "No device service time models are set"
+#define HHC02354 "%1d:%04X fault %d injected %s: sequence %"PRIu64", ccw %02X, position %u, match %u"
+#define HHC02355 "Fault %d: %1d:%04X %s; matched %u, injected %u"
+#define HHC02356 "No fault rules are defined"
+#define HHC02357 "%d fault rule(s) deleted"
+//efine HHC02358 - HHC02359 (available)
 //efine HHC02360 - HHC02369 (available)
 #define HHC02370 "Automatic tracing started at instrcount %"PRIu64" (BEG+%"PRIu64")"
 #define HHC02371 "Automatic tracing stopped at instrcount %"PRIu64" (AMT+%"PRIu64")"
@@ -2325,7 +2345,13 @@ LOGM_DLL_IMPORT int  panel_command_capture( char* cmd, char** resp, bool quiet )
 #define HHC03811 "%1d:%04X %s: %s: Output dropped: %s"
 //efine HHC03812 - HHC03849 (available)
 
-//efine HHC03850 - HHC03899 (available)
+// reserve 0385x-0389x for zfcp related messages
+#define HHC03850 "%1d:%04X %s: LUN %16.16"PRIX64" on WWPN %16.16"PRIX64": %s%s, %"PRIu64" blocks of %u bytes"
+#define HHC03851 "%1d:%04X %s: Error in function %s for file %s: %s"
+#define HHC03852 "%1d:%04X %s: Invalid %s"
+#define HHC03853 "%1d:%04X %s: Too many target ports; WWPN %16.16"PRIX64" ignored"
+#define HHC03854 "%1d:%04X %s: I/O error on LUN %16.16"PRIX64": %s"
+//efine HHC03855 - HHC03899 (available)
 
 // reserve 039xx for ptp related messages
 #define HHC03901 "%1d:%04X PTP: Guest and driver IP addresses are the same"
@@ -2478,7 +2504,14 @@ LOGM_DLL_IMPORT int  panel_command_capture( char* cmd, char** resp, bool quiet )
 #define HHC17013 "Process ID = %d"
 #define HHC17014 "%s value is invalid; valid range is %d - %d"
 #define HHC17015 "%s support not included in this engine build"
-//efine HHC17016 - HHC17099 (available)
+#define HHC17016 "CMMA %s; %s of unused frames, %s returned to the host, host RSS %s"
+#define HHC17017 "Page sharing %s; %s of zero frames returned to the host, %s merged by the host, host RSS %s"
+#define HHC17018 "Machine check rule %d: CPU %s, code %16.16"PRIX64", frame %16.16"PRIX64", limit %u; injected %u"
+#define HHC17019 "No machine check rules are defined"
+#define HHC17020 "%d machine check rule(s) deleted"
+#define HHC17021 "Processor %s%02X: machine check code %16.16"PRIX64" made pending"
+#define HHC17022 "Processor %s%02X: check-stopped by exigent machine check while machine checks are disabled"
+//efine HHC17023 - HHC17099 (available)
 
 //efine HHC17100 - HHC17198 (available)
 #define HHC17199 "%.4s %s"
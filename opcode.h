@@ -1950,6 +1950,7 @@ int  ARCH_DEP( syncgen_io )        (     int r1, int r2, REGS *regs);
 void ARCH_DEP( extid_call )        (     int r1, int r2, REGS *regs);
 int  ARCH_DEP( cpcmd_call )        (     int r1, int r2, REGS *regs);
 int  ARCH_DEP( diag_ppagerel )     (     int r1, int r2, REGS *regs);
+void ARCH_DEP( diag_release_pages )(     int r1, int r2, REGS *regs);
 void ARCH_DEP( vm_info )           (     int r1, int r2, REGS *regs);
 int  ARCH_DEP( device_info )       (     int r1, int r2, REGS *regs);
 void ARCH_DEP( access_reipl_data ) (     int r1, int r2, REGS *regs);
@@ -2036,7 +2037,18 @@ int lddev_cmd (int, char **, char *);
 
 /* Functions in module machchk.c */
 int  ARCH_DEP( present_mck_interrupt ) (REGS *regs, U64 *mcic, U32 *xdmg, RADR *fsta);
+U64  ARCH_DEP( mck_validity ) (void);
+void ARCH_DEP( mck_mark_frame ) (RADR aaddr, bool bad);
+void ARCH_DEP( mck_bad_frame ) (REGS *regs, RADR aaddr);
 void machine_check_crwpend (void);
+U32  mck_subclass (U64 mcic);
+void mck_make_pending (REGS *regs, U64 mcic, U32 xdmg, RADR fsta);
+bool mck_frame_hit (REGS *regs, RADR aaddr, U64 *mcic, U32 *xdmg);
+U64  mck_validity (void);
+int  mck_inject (int cpu, U64 mcic, U32 xdmg, RADR fsta);
+int  mck_add (const MCKRULE *rule);
+int  mck_del (int id);
+bool mck_query (int n, MCKRULE *rule);
 void build_attach_chrpt( DEVBLK *dev );
 void build_detach_chrpt( DEVBLK *dev );
 void build_chp_reset_chrpt( BYTE chpid, int solicited, int found );
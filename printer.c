@@ -273,6 +273,37 @@ int rc;
     return 0;   /* Successful completion */
 }
 
+/*-------------------------------------------------------------------*/
+/*   write_utf8_line          Return 0 if successful, else unitstat. */
+/*-------------------------------------------------------------------*/
+/* Writes the first 'len' print positions in UTF-8. The guest bytes  */
+/* are taken from the PLB so that DBCS (SO/SI) data is converted as  */
+/* a whole; positions that print as blanks are sent as guest blanks. */
+/*-------------------------------------------------------------------*/
+static BYTE write_utf8_line( DEVBLK* dev, U32 len, BYTE* unitstat )
+{
+BYTE     guest[ BUFF_SIZE ];            /* Guest print line          */
+BYTE     line[ BUFF_SIZE * 3 + 1 ];     /* UTF-8 print line          */
+CPSTATE  cps = {0};                     /* DBCS shift state          */
+BYTE     blank = host_to_guest( SPACE );
+size_t   n;
+U32      i;
+
+    for (i=0; i < len; i++)
+        guest[i] = (i < MAX_PLBSIZE && dev->buf[i] != SPACE) ?
+                   dev->plb[i] : blank;
+
+    n = cp_guest_to_host( &cps, guest, len, line, sizeof( line ), 0 );
+
+    /* Fold only the single byte characters */
+    if (dev->fold)
+        for (i=0; i < n; i++)
+            if (line[i] < 0x80)
+                line[i] = toupper( line[i] );
+
+    return write_buffer( dev, (char*) line, (int) n, unitstat );
+}
+
 /*-------------------------------------------------------------------*/
 /*          SpaceLines        Return 0 if successful, else unitstat. */
 /*-------------------------------------------------------------------*/
@@ -379,24 +410,29 @@ static BYTE WriteLine
     */
     i = (U32) ((dev->index < 0 && dev->devtype != 0x3203) ?
                -dev->index : 0); /* Chop if requested */
-    for (; i < num; i++)
+    if (i < num)
     {
         /* Copy print line to PLB */
-        dev->plb[ dev->bufoff ] = iobuf[i];
+        memcpy( &dev->plb[ dev->bufoff ], &iobuf[i], num - i );
 
         /* Translate EBCDIC to ASCII */
-        c = guest_to_host( dev->plb[ dev->bufoff ] );
+        buf_guest_to_host( &iobuf[i], &dev->buf[ dev->bufoff ], num - i );
+
+        for (; i < num; i++)
+        {
+            c = dev->buf[ dev->bufoff ];
 
-        if (!c)
-            c = SPACE;
-        else if (dev->fold)
-            c = toupper(c);
+            if (!c)
+                c = SPACE;
+            else if (dev->fold)
+                c = toupper(c);
 
-        /* Copy to device output buffer */
-        dev->buf[ dev->bufoff ] = c;
+            /* Copy to device output buffer */
+            dev->buf[ dev->bufoff ] = c;
 
-        dev->bufoff++;
-        dev->bufres--;
+            dev->bufoff++;
+            dev->bufres--;
+        }
     }
 
     /* Perform end of record processing if not data-chaining */
@@ -417,7 +453,12 @@ static BYTE WriteLine
         if (code != 0x05)    /* If NOT diagnostic write... */
         {
             /* Write print line... */
-            if (write_buffer( dev, (char*) dev->buf, i, unitstat ) != 0)
+            if (codepage_utf8())
+            {
+                if (write_utf8_line( dev, i, unitstat ) != 0)
+                    return *unitstat; /* (I/O error) */
+            }
+            else if (write_buffer( dev, (char*) dev->buf, i, unitstat ) != 0)
                 return *unitstat; /* (I/O error) */
 
             if (dev->crlf)
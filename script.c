@@ -44,6 +44,7 @@
 /*-------------------------------------------------------------------*/
 struct SCRCTL {                         /* Script control structure  */
     LIST_ENTRY link;                    /* Just a link in the chain  */
+    LIST_ENTRY explink;                 /* Link in expect list chain */
     TID     scr_tid;                    /* Script thread id. If zero
                                            then entry is not active. */
     int     scr_id;                     /* Script identification no. */
@@ -55,14 +56,37 @@ struct SCRCTL {                         /* Script control structure  */
     #define SCR_ABORT      0x40         /* Script abort requested    */
     #define SCR_CANCELED   0x20         /* Script has been canceled  */
     #define SCR_ABORTED    0x10         /* Script has been aborted   */
+    #define SCR_RETURN     0x08         /* Script return requested   */
+    int     scr_rc;                     /* Script 'return' code      */
+    int     scr_matched;                /* Last 'expect' was matched */
+    char*   scr_expbuf;                 /* Log output for 'expect'   */
+    int     scr_explen;                 /* Length of scr_expbuf data */
+    int     scr_expscan;                /* Length already scanned    */
 };
 typedef struct SCRCTL SCRCTL;           /* typedef is easier to use  */
 static LIST_ENTRY scrlist = {0,0};      /* Script list anchor entry  */
+static LIST_ENTRY explist = {0,0};      /* Expect list anchor entry  */
 static int scrid = 0;                   /* Script identification no. */
 
+/*-------------------------------------------------------------------*/
+/*       Script if/else/endif and while/endwhile block control       */
+/*-------------------------------------------------------------------*/
+struct SCRBLK {                         /* Script block structure    */
+    int     blk_type;                   /* Type of block             */
+    #define SCRBLK_IF      1            /* if/else/endif block       */
+    #define SCRBLK_WHILE   2            /* while/endwhile block      */
+    bool    blk_exec;                   /* Statements are executed   */
+    bool    blk_done;                   /* if: branch already taken  */
+    long    blk_pos;                    /* while: stmt file position */
+    int     blk_stmtnum;                /* Block's stmt line number  */
+};
+typedef struct SCRBLK SCRBLK;           /* typedef is easier to use  */
+
 /* Forward declarations:                                             */
 static int do_special(char *fname, int *inc_stmtnum, SCRCTL *pCtl, char *p);
 static int set_restart(const char * s);
+static int do_script_stmt( SCRCTL* pCtl, FILE* fp, long stmtpos,
+                           int* stmtnum, SCRBLK* blks, int* nblks, char* p );
 /* End of forward declarations.                                      */
 
 /*-------------------------------------------------------------------*/
@@ -448,6 +472,58 @@ rexx_done:
 
 } /* end function process_config */
 
+/*-------------------------------------------------------------------*/
+/* Log stream hook - save log output for 'expect' stmts   (internal) */
+/*-------------------------------------------------------------------*/
+/* Called by the logger thread for each new chunk of log data. The   */
+/* data is appended to the expect buffer of every script so that a   */
+/* message issued before the 'expect' statement that waits for it is */
+/* not missed. When a buffer fills up the oldest lines are discarded. */
+/*-------------------------------------------------------------------*/
+static void script_log_hook( const char* msg, int msglen )
+{
+    LIST_ENTRY*  pLink;
+    SCRCTL*      pCtl;
+    char*        pNL;
+    int          drop;
+
+    if (msglen > MAX_EXPECT_BUF)
+    {
+        msg    += msglen - MAX_EXPECT_BUF;
+        msglen  = MAX_EXPECT_BUF;
+    }
+
+    obtain_lock( &sysblk.explock );
+
+    for (pLink = explist.Flink; pLink != &explist; pLink = pLink->Flink)
+    {
+        pCtl = CONTAINING_RECORD( pLink, SCRCTL, explink );
+
+        if (!pCtl->scr_expbuf && !(pCtl->scr_expbuf = malloc( MAX_EXPECT_BUF )))
+            continue;
+
+        /* Discard the oldest complete lines to make room */
+        if ((drop = pCtl->scr_explen + msglen - MAX_EXPECT_BUF) > 0)
+        {
+            if (drop < pCtl->scr_explen && (pNL = memchr( pCtl->scr_expbuf + drop,
+                '\n', pCtl->scr_explen - drop )))
+                drop = (int)(pNL + 1 - pCtl->scr_expbuf);
+            else
+                drop = pCtl->scr_explen;
+
+            pCtl->scr_explen -= drop;
+            memmove( pCtl->scr_expbuf, pCtl->scr_expbuf + drop, pCtl->scr_explen );
+            pCtl->scr_expscan = MAX( 0, pCtl->scr_expscan - drop );
+        }
+
+        memcpy( pCtl->scr_expbuf + pCtl->scr_explen, msg, msglen );
+        pCtl->scr_explen += msglen;
+    }
+
+    broadcast_condition( &sysblk.expcond );
+    release_lock( &sysblk.explock );
+}
+
 /*-------------------------------------------------------------------*/
 /* Create new SCRCTL entry - lock must *NOT* be held      (internal) */
 /*-------------------------------------------------------------------*/
@@ -484,6 +560,15 @@ SCRCTL* NewSCRCTL( TID tid, const char* script_name )
     InsertListTail( &scrlist, &pCtl->link );
     release_lock( &sysblk.scrlock );
 
+    /* Start saving log output for any 'expect' statements */
+    obtain_lock( &sysblk.explock );
+    if (!explist.Flink)
+        InitializeListHead( &explist );
+    InsertListTail( &explist, &pCtl->explink );
+    release_lock( &sysblk.explock );
+
+    log_hook_add( script_log_hook );
+
     return pCtl;
 }
 
@@ -512,7 +597,13 @@ void FreeSCRCTL( SCRCTL* pCtl )
     RemoveListEntry( &pCtl->link );
     release_lock( &sysblk.scrlock );
 
+    obtain_lock( &sysblk.explock );
+    RemoveListEntry( &pCtl->explink );
+    release_lock( &sysblk.explock );
+
     /* Free list entry and return */
+    if (pCtl->scr_expbuf)
+        free( pCtl->scr_expbuf );
     if (pCtl->scr_name)
         free( pCtl->scr_name );
     if (pCtl->scr_cmdline)
@@ -593,6 +684,16 @@ static void ListScriptsIds()
     release_lock( &sysblk.scrlock );
 }
 
+/*-------------------------------------------------------------------*/
+/* Wake up any scripts waiting in an 'expect' statement   (internal) */
+/*-------------------------------------------------------------------*/
+static void wakeup_expect()
+{
+    obtain_lock( &sysblk.explock );
+    broadcast_condition( &sysblk.expcond );
+    release_lock( &sysblk.explock );
+}
+
 /*-------------------------------------------------------------------*/
 /* cscript command - cancel a running script(s)           (external) */
 /*-------------------------------------------------------------------*/
@@ -669,6 +770,7 @@ int cscript_cmd( int argc, char *argv[], char *cmdline )
             pCtl->scr_flags |= SCR_CANCEL;
             broadcast_condition( &sysblk.scrcond );
             release_lock( &sysblk.scrlock );
+            wakeup_expect();
             return 0;
         }
         else if (all)
@@ -689,7 +791,9 @@ int cscript_cmd( int argc, char *argv[], char *cmdline )
 
     release_lock( &sysblk.scrlock );
 
-    if (!count)
+    if (count)
+        wakeup_expect();
+    else
     {
         // "Script %s not found"
         WRMSG( HHC02316, "E", argv[1] );
@@ -732,6 +836,9 @@ char    stmt[ MAX_SCRIPT_STMT ];        /* script statement buffer   */
 int     stmtlen     = 0;                /* Length of current stmt    */
 int     stmtnum     = 0;                /* Current stmt line number  */
 TID     tid         = thread_id();      /* Our thread Id             */
+long    stmtpos     = 0;                /* File position of stmt     */
+SCRBLK  blks[ MAX_SCRIPT_BLOCKS ];      /* if/while block stack      */
+int     nblks       = 0;                /* Number of blocks stacked  */
 char   *p;                              /* (work)                    */
 int     rc;                             /* (work)                    */
 
@@ -798,8 +905,10 @@ int     rc;                             /* (work)                    */
     }
 
     pCtl->scr_recursion++;
+    rc = 0;
 
     /* Read the first line into our statement buffer */
+    stmtpos = ftell( fp );
     if (!script_abort( pCtl ) && !fgets( stmt, MAX_SCRIPT_STMT, fp ))
     {
         // "Script %d: begin processing file '%s'"
@@ -839,6 +948,14 @@ int     rc;                             /* (work)                    */
         for (stmtlen = (int)strlen(p); stmtlen && isspace(p[stmtlen-1]); stmtlen--);
         p[stmtlen] = 0;
 
+        /* Script statements and if/while block processing */
+        if (do_script_stmt( pCtl, fp, stmtpos, &stmtnum, blks, &nblks, p ))
+            continue;
+
+        /* Skip statements within a block not being executed */
+        if (nblks && !blks[ nblks-1 ].blk_exec)
+            continue;
+
         /* Special handling for 'pause' and other statements */
         if (do_special(NULL, NULL, pCtl, p))
             continue;
@@ -846,15 +963,33 @@ int     rc;                             /* (work)                    */
         /* Process statement as command */
         panel_command( p );
     }
-    while (!script_abort( pCtl ) && fgets( stmt, MAX_SCRIPT_STMT, fp ));
+    while (1
+        && !script_abort( pCtl )
+        && !(pCtl->scr_flags & SCR_RETURN)
+        && (stmtpos = ftell( fp ), fgets( stmt, MAX_SCRIPT_STMT, fp ))
+    );
 
 script_end:
 
     /* Issue termination message and close file */
     if (fp)
     {
-        if (feof( fp ))
+        if (pCtl->scr_flags & SCR_RETURN)
         {
+            rc = pCtl->scr_rc;
+            pCtl->scr_flags &= ~SCR_RETURN;
+            // "Script %d: file %s returned %d"
+            WRMSG( HHC02365, "I", pCtl->scr_id, script_path, rc );
+        }
+        else if (feof( fp ))
+        {
+            if (nblks)
+            {
+                // "Script %d: line %d: %s without matching %s"
+                WRMSG( HHC02364, "E", pCtl->scr_id, blks[ nblks-1 ].blk_stmtnum,
+                    blks[ nblks-1 ].blk_type == SCRBLK_IF ? "if" : "while",
+                    blks[ nblks-1 ].blk_type == SCRBLK_IF ? "endif" : "endwhile" );
+            }
             // "Script %d: file '%s' processing ended"
             WRMSG( HHC02264, "I", pCtl->scr_id, script_path );
         }
@@ -879,7 +1014,7 @@ script_end:
 
     pCtl->scr_recursion--;
     free( scrname );
-    return 0;
+    return rc;
 }
 /* end process_script_file */
 
@@ -1373,4 +1508,409 @@ do_special(char *fname, int *inc_stmtnum, SCRCTL *pCtl, char *p)
     return TRUE;
 }
 
+/*-------------------------------------------------------------------*/
+/* expect script statement - wait for a matching log message         */
+/*-------------------------------------------------------------------*/
+/* Syntax:  expect  <timeout>  <regular expression>                  */
+/*                                                                   */
+/* Waits until a line of log output matches the extended regular    */
+/* expression or the timeout expires. The log output is saved from   */
+/* the moment the script was started, so a message issued before     */
+/* this statement is reached will still be found. All output up to   */
+/* and including the matching line is then discarded. The matched    */
+/* string and up to EXPECT_MAXCAPT parenthesized subexpressions are  */
+/* returned in symbols MATCH0 through MATCH9.                        */
+/*-------------------------------------------------------------------*/
+static void do_expect( SCRCTL* pCtl, int stmtnum, char* stmt, char* args )
+{
+#if defined( HAVE_REGEX_H ) || defined( HAVE_PCRE )
+
+    struct timeval beg, now, dur;   /* To calculate remaining time   */
+    double      secs;               /* Seconds to wait for message   */
+    U32         msecs;              /* Same thing in milliseconds    */
+    U32         elapsed_usecs;      /* To calculate remaining time   */
+    regex_t     regex;              /* Compiled regular expression   */
+    regmatch_t  rm[ EXPECT_MAXCAPT + 1 ];   /* Subexpression offsets */
+    char*       caps[ EXPECT_MAXCAPT + 1 ] = {0};   /* Captured text */
+    char        symname[ 16 ];      /* MATCHn symbol name            */
+    char        errbuf[ 80 ];       /* regerror message text         */
+    char*       p2;                 /* Resolved symbol string        */
+    char*       pRegex;             /* Regular expression            */
+    char*       pLine;              /* Start of log output line      */
+    char*       pNL;                /* End of log output line        */
+    char*       pEnd;               /* End of line without CR        */
+    char        c;                  /* Character at pEnd             */
+    int         rc, i, len;
+
+    pCtl->scr_matched = FALSE;
+
+    if ((p2 = resolve_symbol_string( args )))
+        args = p2;
+
+    /* Parse the timeout and the regular expression */
+    secs = strtod( args, &pRegex );
+
+    if (0
+        || pRegex == args
+        || !isspace( *pRegex )
+        || secs < MIN_PAUSE_TIMEOUT
+        || secs > MAX_PAUSE_TIMEOUT
+    )
+    {
+        // "Script %d: syntax error; statement ignored: %s"
+        WRMSG( HHC02261, "E", pCtl->scr_id, stmt );
+        free( p2 );
+        return;
+    }
+
+    while (isspace( *pRegex ))
+        pRegex++;
+
+    if ((rc = regcomp( &regex, pRegex, REG_EXTENDED )) != 0)
+    {
+        regerror( rc, &regex, errbuf, sizeof( errbuf ));
+        // "Script %d: line %d: invalid regular expression: %s"
+        WRMSG( HHC02363, "E", pCtl->scr_id, stmtnum, errbuf );
+        free( p2 );
+        return;
+    }
+    free( p2 );
+
+    /* Apply adjustment factor */
+    if (sysblk.scrfactor)
+        secs *= sysblk.scrfactor;
+
+    msecs = (U32) (secs * 1000.0);
+
+    if (MLVL( VERBOSE ))
+        // "Script %d: line %d: waiting up to %d milliseconds for expected message"
+        WRMSG( HHC02360, "I", pCtl->scr_id, stmtnum, msecs );
+
+    gettimeofday( &beg, NULL );
+
+    obtain_lock( &sysblk.explock );
+    pCtl->scr_expscan = 0;
+    for (rc = REG_NOMATCH;;)
+    {
+        /* Check each complete line of log output not yet scanned */
+        while (1
+            && rc == REG_NOMATCH
+            && pCtl->scr_expbuf
+            && (pNL = memchr( pCtl->scr_expbuf + pCtl->scr_expscan, '\n',
+                              pCtl->scr_explen - pCtl->scr_expscan ))
+        )
+        {
+            pLine = pCtl->scr_expbuf + pCtl->scr_expscan;
+            pEnd  = (pNL > pLine && pNL[-1] == '\r') ? pNL - 1 : pNL;
+            c = *pEnd;
+            *pEnd = 0;
+
+            if ((rc = regexec( &regex, pLine, EXPECT_MAXCAPT + 1, rm, 0 )) == 0)
+            {
+                for (i=0; i <= EXPECT_MAXCAPT; i++)
+                {
+                    if (rm[i].rm_so < 0 || !(caps[i] = malloc( (len = (int)(rm[i].rm_eo - rm[i].rm_so)) + 1 )))
+                        continue;
+                    memcpy( caps[i], pLine + rm[i].rm_so, len );
+                    caps[i][ len ] = 0;
+                }
+            }
+
+            *pEnd = c;
+            pCtl->scr_expscan = (int)(pNL + 1 - pCtl->scr_expbuf);
+        }
+
+        /* Discard all output up to and including the matched line */
+        if (rc == 0)
+        {
+            pCtl->scr_explen -= pCtl->scr_expscan;
+            memmove( pCtl->scr_expbuf, pCtl->scr_expbuf + pCtl->scr_expscan, pCtl->scr_explen );
+            pCtl->scr_expscan = 0;
+            break;
+        }
+
+        /* Check for cancelled script (message issued further below) */
+        if (pCtl->scr_flags & (SCR_CANCEL | SCR_ABORT))
+            break;
+
+        /* Is there any time remaining on the clock? */
+        gettimeofday( &now, NULL );
+        timeval_subtract( &beg, &now, &dur );
+        elapsed_usecs = (dur.tv_sec * 1000000) + dur.tv_usec;
+
+        if (elapsed_usecs >= (msecs * 1000))
+        {
+            rc = ETIMEDOUT;
+            break;
+        }
+
+        /* Sleep until more log output arrives or we run out of time */
+        timed_wait_condition_relative_usecs( &sysblk.expcond,
+            &sysblk.explock, (msecs * 1000) - elapsed_usecs, NULL );
+    }
+    release_lock( &sysblk.explock );
+
+    regfree( &regex );
+
+    if (rc == 0)
+    {
+        pCtl->scr_matched = TRUE;
+
+        for (i=0; i <= EXPECT_MAXCAPT; i++)
+        {
+            MSGBUF( symname, "MATCH%d", i );
+            set_symbol( symname, caps[i] ? caps[i] : "" );
+            if (caps[i])
+                free( caps[i] );
+        }
+
+        if (MLVL( VERBOSE ))
+            // "Script %d: line %d: expected message found"
+            WRMSG( HHC02361, "I", pCtl->scr_id, stmtnum );
+    }
+    else if (rc == ETIMEDOUT)
+    {
+        // "Script %d: line %d: timeout waiting for expected message"
+        WRMSG( HHC02362, "W", pCtl->scr_id, stmtnum );
+    }
+    else
+        script_abort( pCtl );
+
+#else // !defined( HAVE_REGEX_H ) && !defined( HAVE_PCRE )
+
+    UNREFERENCED( stmt );
+    UNREFERENCED( args );
+
+    pCtl->scr_matched = FALSE;
+
+    // "Script %d: line %d: %s statement is not supported %s"
+    WRMSG( HHC02366, "E", pCtl->scr_id, stmtnum, "expect", "in this build" );
+
+#endif // defined( HAVE_REGEX_H ) || defined( HAVE_PCRE )
+}
+
+/*-------------------------------------------------------------------*/
+/* Evaluate an if or while condition     (internal)                  */
+/*-------------------------------------------------------------------*/
+/* Syntax:  [NOT] MATCHED  |  [NOT] <string> == | != <string>        */
+/*                                                                   */
+/* MATCHED is true if the most recent 'expect' statement found its   */
+/* message. Strings are compared after symbol substitution and with  */
+/* leading and trailing blanks removed.                              */
+/*                                                                   */
+/* returns: TRUE, FALSE or -1 if the condition is not valid          */
+/*-------------------------------------------------------------------*/
+static int script_cond( SCRCTL* pCtl, const char* cond )
+{
+    char*  p2;                      /* Resolved symbol string        */
+    char*  p;                       /* (work)                        */
+    char*  op;                      /* Comparison operator           */
+    bool   negate = false;          /* NOT was specified             */
+    int    rc     = -1;             /* Result of the condition       */
+
+    if (!(p2 = resolve_symbol_string( cond )) && !(p2 = strdup( cond )))
+        return -1;
+
+    for (p = p2; isspace( *p ); p++);
+
+    if (strncasecmp( p, "not", 3 ) == 0 && isspace( p[3] ))
+    {
+        negate = true;
+        for (p += 3; isspace( *p ); p++);
+    }
+
+    if (strcasecmp( p, "matched" ) == 0)
+        rc = pCtl->scr_matched ? TRUE : FALSE;
+
+    else if ((op = strstr( p, "==" )) || (op = strstr( p, "!=" )))
+    {
+        bool equal = (op[0] == '=');
+
+        /* Isolate both operands */
+        *op = 0;
+        RTRIM( p );
+        for (op += 2; isspace( *op ); op++);
+
+        rc = ((strcmp( p, op ) == 0) == equal) ? TRUE : FALSE;
+    }
+
+    if (rc >= 0 && negate)
+        rc = !rc;
+
+    free( p2 );
+    return rc;
+}
+
+/*-------------------------------------------------------------------*/
+/* Script-only statements and if/while block processing              */
+/*-------------------------------------------------------------------*/
+/*   expect  <timeout>  <regular expression>                         */
+/*   send    <command>                                               */
+/*   return  [<rc>]                                                  */
+/*   if      <condition>  ...  [else  ...]  endif                    */
+/*   while   <condition>  ...  endwhile                              */
+/*                                                                   */
+/* Block statements are always processed so that nesting is tracked */
+/* even within a block whose statements are being skipped.           */
+/*                                                                   */
+/* returns:  TRUE == stmt processed,   FALSE == stmt NOT processed   */
+/*-------------------------------------------------------------------*/
+static int do_script_stmt( SCRCTL* pCtl, FILE* fp, long stmtpos,
+                           int* stmtnum, SCRBLK* blks, int* nblks, char* p )
+{
+    SCRBLK* blk  = *nblks ? &blks[ *nblks-1 ] : NULL;
+    bool    exec = !blk || blk->blk_exec;   /* Executing statements  */
+    char*   args;                           /* Statement arguments   */
+    int     kwlen;                          /* Statement keyword len */
+    int     cond;                           /* Condition result      */
+
+    /* Isolate the statement keyword and its arguments */
+    for (args = p; *args && !isspace( *args ); args++);
+    kwlen = (int)(args - p);
+    while (isspace( *args ))
+        args++;
+
+#define IS_STMT( kw )  (kwlen == (int)strlen( kw ) && strncasecmp( p, kw, kwlen ) == 0)
+
+    if (IS_STMT( "if" ) || IS_STMT( "while" ))
+    {
+        bool is_while = IS_STMT( "while" );
+
+        if (*nblks >= MAX_SCRIPT_BLOCKS)
+        {
+            // "Script %d: line %d: if/while nesting exceeds %d levels"
+            WRMSG( HHC02367, "E", pCtl->scr_id, *stmtnum, MAX_SCRIPT_BLOCKS );
+            pCtl->scr_flags |= SCR_ABORT;
+            return TRUE;
+        }
+
+        if (is_while && exec && stmtpos < 0)
+        {
+            // "Script %d: line %d: %s statement is not supported %s"
+            WRMSG( HHC02366, "E", pCtl->scr_id, *stmtnum, "while", "for this input" );
+            pCtl->scr_flags |= SCR_ABORT;
+            return TRUE;
+        }
+
+        cond = FALSE;
+        if (exec && (cond = script_cond( pCtl, args )) < 0)
+        {
+            // "Script %d: syntax error; statement ignored: %s"
+            WRMSG( HHC02261, "E", pCtl->scr_id, p );
+            cond = FALSE;
+        }
+
+        blk = &blks[ (*nblks)++ ];
+        blk->blk_type    = is_while ? SCRBLK_WHILE : SCRBLK_IF;
+        blk->blk_exec    = exec && cond;
+        blk->blk_done    = !exec || cond;
+        blk->blk_pos     = stmtpos;
+        blk->blk_stmtnum = *stmtnum;
+        return TRUE;
+    }
+
+    if (IS_STMT( "else" ))
+    {
+        if (!blk || blk->blk_type != SCRBLK_IF)
+            // "Script %d: line %d: %s without matching %s"
+            WRMSG( HHC02364, "E", pCtl->scr_id, *stmtnum, "else", "if" );
+        else
+        {
+            blk->blk_exec = !blk->blk_done;
+            blk->blk_done = true;
+        }
+        return TRUE;
+    }
+
+    if (IS_STMT( "endif" ))
+    {
+        if (!blk || blk->blk_type != SCRBLK_IF)
+            // "Script %d: line %d: %s without matching %s"
+            WRMSG( HHC02364, "E", pCtl->scr_id, *stmtnum, "endif", "if" );
+        else
+            (*nblks)--;
+        return TRUE;
+    }
+
+    if (IS_STMT( "endwhile" ))
+    {
+        if (!blk || blk->blk_type != SCRBLK_WHILE)
+        {
+            // "Script %d: line %d: %s without matching %s"
+            WRMSG( HHC02364, "E", pCtl->scr_id, *stmtnum, "endwhile", "while" );
+            return TRUE;
+        }
+
+        (*nblks)--;
+
+        /* Go back to the while statement to test its condition again */
+        if (blk->blk_exec)
+        {
+            if (fseek( fp, blk->blk_pos, SEEK_SET ) != 0)
+            {
+                // "Error in function '%s': '%s'"
+                WRMSG( HHC02219, "E", "fseek()", strerror( errno ));
+                pCtl->scr_flags |= SCR_ABORT;
+            }
+            else
+                *stmtnum = blk->blk_stmtnum - 1;
+        }
+        return TRUE;
+    }
+
+    if (IS_STMT( "expect" ))
+    {
+        if (exec)
+            do_expect( pCtl, *stmtnum, p, args );
+        return TRUE;
+    }
+
+    if (IS_STMT( "send" ))
+    {
+        if (exec)
+        {
+            char cmd[ MAX_SCRIPT_STMT + 1 ];
+
+            if (!*args)
+                // "Script %d: syntax error; statement ignored: %s"
+                WRMSG( HHC02261, "E", pCtl->scr_id, p );
+
+            /* Pass command to the SCP unless already prefixed */
+            else if (*args == '.' || *args == '!')
+                panel_command( args );
+            else
+            {
+                MSGBUF( cmd, ".%s", args );
+                panel_command( cmd );
+            }
+        }
+        return TRUE;
+    }
+
+    if (IS_STMT( "return" ))
+    {
+        if (exec)
+        {
+            char* p2 = resolve_symbol_string( args );
+            char* pEnd;
+            long  rc = strtol( p2 ? p2 : args, &pEnd, 10 );
+
+            if (*pEnd)
+                // "Script %d: syntax error; statement ignored: %s"
+                WRMSG( HHC02261, "E", pCtl->scr_id, p );
+            else
+            {
+                pCtl->scr_rc     = (int) rc;
+                pCtl->scr_flags |= SCR_RETURN;
+            }
+            free( p2 );
+        }
+        return TRUE;
+    }
+
+#undef IS_STMT
+
+    return FALSE;
+}
+
 #endif /*!defined(_GEN_ARCH)*/
@@ -261,6 +261,8 @@ U16 sccb_len;
 U16 evd_len;
 int event_msglen;
 int i;
+BYTE cmd[ sizeof(servc_scpcmdstr) * 2 ];
+CPSTATE cps = {0};
 
 SCCB_EVD_HDR *evd_hdr = (SCCB_EVD_HDR*)(sccb+1);
 SCCB_EVD_BK *evd_bk = (SCCB_EVD_BK*)(evd_hdr+1);
@@ -269,8 +271,10 @@ BYTE *event_msg = (BYTE*)(evd_bk+1);
     /* Get SCCB length */
     FETCH_HW(sccb_len, sccb->length);
 
-    /* Command length */
-    event_msglen = (int)strlen(servc_scpcmdstr);
+    /* Translate command; its length may change for UTF-8 and DBCS */
+    event_msglen = (int) cp_host_to_guest( &cps, (BYTE*) servc_scpcmdstr,
+                                           strlen( servc_scpcmdstr ),
+                                           cmd, sizeof(cmd), 0 );
 
     /* Calculate required EVD length */
     evd_len = event_msglen + (int)sizeof(SCCB_EVD_HDR) + (int)sizeof(SCCB_EVD_BK);
@@ -320,9 +324,8 @@ BYTE *event_msg = (BYTE*)(evd_bk+1);
     evd_bk->tmlen = i;
     evd_bk->const5 = const5_template;
 
-    /* Copy and translate command */
-    for (i = 0; i < event_msglen; i++)
-            event_msg[i] = host_to_guest(servc_scpcmdstr[i]);
+    /* Copy translated command */
+    memcpy( event_msg, cmd, event_msglen );
 
     /* Set response code X'0020' in SCCB header */
     sccb->reas = SCCB_REAS_NONE;
@@ -1587,12 +1590,9 @@ docheckstop:
                         /* Print line unless it is a response prompt */
                         if (!(mto_bk->ltflag[0] & SCCB_MTO_LTFLG0_PROMPT))
                         {
-                            for (i = 0; i < event_msglen; i++)
-                            {
-                                message[i] = isprint(guest_to_host(event_msg[i])) ?
-                                    guest_to_host(event_msg[i]) : 0x20;
-                            }
-                            message[i] = '\0';
+                            CPSTATE cps = {0};
+                            cp_guest_to_host( &cps, event_msg, event_msglen,
+                                              message, sizeof(message), CP_CTL_SPACE );
                             LOGMSG("%s\n",message);
                         }
                     }
@@ -1596,7 +1596,7 @@ void ARCH_DEP( sie_exit )( REGS* regs, int icode )
            transaction was aborted as a result of this intercepted
            program interrupt. For safety, return a "NULL" (empty)
            Interception TDB instead. (Sorry Dan! Could not locate
-           Claudia Schiffers phone number!)
+           Claudia Schiffer�s phone number!)
         */
         memset( HOSTREGS->mainstor + itdba, 0, sizeof( TDB ));
     }
@@ -2025,15 +2025,37 @@ DEF_INST( store_hypervisor_information )
 /* only be used (executed) by guests running under z/VM via z/VM     */
 /* instruction interception and simulation. An operation execption   */
 /* program interrupt will always occur if this instruction is not    */
-/* intercepted by z/VM.                                              */ 
+/* intercepted by z/VM.                                              */
 /* Ref: page 870 of SC24-6272-03 "zVM 7.1 CP Programming Services"   */
+/*                                                                   */
+/* When CMMA is enabled ('cmma on') Hercules itself plays the part   */
+/* of z/VM for guests that are not running under SIE: the usage      */
+/* state of each frame is tracked and unused frames are returned to  */
+/* the host (see cmma_essa in config.c).                             */
 /*-------------------------------------------------------------------*/
 DEF_INST( extract_and_set_storage_attributes )
 {
-    int r1, r2, m3;
+int     r1, r2, m3;                     /* Values of R and M fields  */
+RADR    aaddr;                          /* Absolute frame address    */
+
     RRF_M( inst, regs, r1, r2, m3 );
     SIE_INTERCEPT( regs );
-    ARCH_DEP( program_interrupt )( regs, PGM_OPERATION_EXCEPTION );
+
+    if (!sysblk.cmma)
+        ARCH_DEP( program_interrupt )( regs, PGM_OPERATION_EXCEPTION );
+
+    PRIV_CHECK( regs );
+
+    if (m3 > ESSA_SET_STABLE_IF_RESIDENT)
+        ARCH_DEP( program_interrupt )( regs, PGM_SPECIFICATION_EXCEPTION );
+
+    /* R2 contains the real address of the frame */
+    aaddr = APPLY_PREFIXING( regs->GR_G( r2 ), regs->PX ) & PAGEFRAME_PAGEMASK;
+    if (aaddr > regs->mainlim)
+        ARCH_DEP( program_interrupt )( regs, PGM_ADDRESSING_EXCEPTION );
+
+    /* R1 receives the state of the frame before the operation */
+    regs->GR_G( r1 ) = cmma_essa( aaddr >> PAGEFRAME_PAGESHIFT, m3 );
 }
 #endif
 #endif /* defined( FEATURE_SIE ) */
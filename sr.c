@@ -13,6 +13,7 @@
 
 #include "hercules.h"
 #include "opcode.h"
+#include "cckddasd.h"
 
 //#define SR_DEBUG    // #define to enable TRACE stmts
 
@@ -65,45 +66,17 @@ DEVBLK *dev;
     return NULL;
 }
 
-int suspend_cmd(int argc, char *argv[],char *cmdline)
+/*-------------------------------------------------------------------*/
+/* Stop all CPUs, returning the mask of those that were started      */
+/*-------------------------------------------------------------------*/
+void sr_stop_cpus( CPU_BITMAP* started_mask )
 {
-char    *fn = SR_DEFAULT_FILENAME;
-SR_FILE  file;
-CPU_BITMAP started_mask;
-struct   timeval tv;
-time_t   tt;
-int      i, j, rc;
-REGS    *regs;
-DEVBLK  *dev;
-IOINT   *ioq;
-BYTE     psw[16];
-
-    UNREFERENCED(cmdline);
-
-    if (argc > 2)
-    {
-        // "SR: too many arguments"
-        WRMSG(HHC02000, "E");
-        return -1;
-    }
-
-    if (argc == 2)
-        fn = argv[1];
-
-    file = SR_OPEN (fn, "wb");
-    if (file == NULL)
-    {
-        // "SR: error in function '%s': '%s'"
-        WRMSG(HHC02001, "E","open()",strerror(errno));
-        return -1;
-    }
-
-    TRACE("SR: Begin Suspend Processing...\n");
+int      i;
 
     /* Save CPU state and stop all CPU's */
     TRACE("SR: Stopping All CPUs...\n");
     OBTAIN_INTLOCK(NULL);
-    started_mask = sysblk.started_mask;
+    *started_mask = sysblk.started_mask;
     while (sysblk.started_mask)
     {
         for (i = 0; i < sysblk.maxcpu; i++)
@@ -120,6 +93,17 @@ BYTE     psw[16];
         OBTAIN_INTLOCK(NULL);
     }
     RELEASE_INTLOCK(NULL);
+}
+
+/*-------------------------------------------------------------------*/
+/* Stop all CPUs and wait for the I/O subsystem to become idle       */
+/*-------------------------------------------------------------------*/
+static void sr_quiesce( CPU_BITMAP* started_mask )
+{
+int      i;
+DEVBLK  *dev;
+
+    sr_stop_cpus( started_mask );
 
     /* Wait for I/O queue to clear out */
     TRACE("SR: Waiting for I/O Queue to clear...\n");
@@ -150,6 +134,35 @@ BYTE     psw[16];
         // "SR: device %04X still busy, proceeding anyway"
         WRMSG(HHC02003, "W",dev->devnum);
     }
+}
+
+/*-------------------------------------------------------------------*/
+/* Restart the CPUs that were started when the state was saved       */
+/*-------------------------------------------------------------------*/
+void sr_start_cpus( CPU_BITMAP started_mask )
+{
+int      i;
+
+    OBTAIN_INTLOCK(NULL);
+    ON_IC_IOPENDING;
+    for (i = 0; i < sysblk.maxcpu; i++)
+        if (IS_CPU_ONLINE(i) && (started_mask & CPU_BIT(i)))
+        {
+            sysblk.regs[i]->opinterv = 0;
+            sysblk.regs[i]->cpustate = CPUSTATE_STARTED;
+            sysblk.regs[i]->checkstop = 0;
+            WAKEUP_CPU(sysblk.regs[i]);
+        }
+    RELEASE_INTLOCK(NULL);
+}
+
+/*-------------------------------------------------------------------*/
+/* Write the file header                                             */
+/*-------------------------------------------------------------------*/
+static int sr_write_header( SR_FILE file )
+{
+struct   timeval tv;
+time_t   tt;
 
     /* Write header */
     TRACE("SR: Writing File Header...\n");
@@ -158,13 +171,27 @@ BYTE     psw[16];
     gettimeofday(&tv, NULL); tt = tv.tv_sec;
     SR_WRITE_STRING(file, SR_HDR_DATE, ctime(&tt));
 
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Write system, service console and clock state                     */
+/*-------------------------------------------------------------------*/
+static int sr_write_system( SR_FILE file, CPU_BITMAP started_mask,
+                            int mainstor )
+{
+IOINT   *ioq;
+
     /* Write system data */
     TRACE("SR: Saving System Data...\n");
     SR_WRITE_STRING(file,SR_SYS_ARCH_NAME, get_arch_name( NULL ));
     SR_WRITE_VALUE (file,SR_SYS_STARTED_MASK,started_mask,sizeof(started_mask));
     SR_WRITE_VALUE (file,SR_SYS_MAINSIZE,sysblk.mainsize,sizeof(sysblk.mainsize));
-    TRACE("SR: Saving MAINSTOR...\n");
-    SR_WRITE_BUF   (file,SR_SYS_MAINSTOR,sysblk.mainstor,sysblk.mainsize);
+    if (mainstor)
+    {
+        TRACE("SR: Saving MAINSTOR...\n");
+        SR_WRITE_BUF(file,SR_SYS_MAINSTOR,sysblk.mainstor,sysblk.mainsize);
+    }
     SR_WRITE_VALUE (file,SR_SYS_SKEYSIZE,(sysblk.mainsize/_STORKEY_ARRAY_UNITSIZE),sizeof(U32));
     TRACE("SR: Saving Storage Keys...\n");
     SR_WRITE_BUF   (file,SR_SYS_STORKEYS,sysblk.storkeys,sysblk.mainsize/_STORKEY_ARRAY_UNITSIZE);
@@ -230,6 +257,18 @@ BYTE     psw[16];
     clock_hsuspend(file);
     SR_WRITE_HDR(file, SR_DELIMITER, 0);
 
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Write the state of every online CPU                               */
+/*-------------------------------------------------------------------*/
+static int sr_write_cpus( SR_FILE file )
+{
+int      i, j;
+REGS    *regs;
+BYTE     psw[16];
+
     /* Write CPU data */
     for (i = 0; i < sysblk.maxcpu; i++)
     {
@@ -282,6 +321,22 @@ BYTE     psw[16];
         SR_WRITE_HDR(file, SR_DELIMITER, 0);
     }
 
+    return 0;
+}
+
+/* Current shadow file level of a compressed disk                    */
+#define SR_CCKD_SFN( _dev )                                    \
+    ((_dev)->cckd64 ? ((CCKD64_EXT*)(_dev)->cckd_ext)->sfn     \
+                    : ((CCKD_EXT*)  (_dev)->cckd_ext)->sfn)
+
+/*-------------------------------------------------------------------*/
+/* Write the state of every valid device                             */
+/*-------------------------------------------------------------------*/
+static int sr_write_devices( SR_FILE file, int clone )
+{
+int      i, rc;
+DEVBLK  *dev;
+
     /* Write Device data */
     for (dev = sysblk.firstdev; dev; dev = dev->nextdev)
     {
@@ -303,6 +358,31 @@ BYTE     psw[16];
                 SR_WRITE_STRING(file, SR_DEV_ARGV, "");
             }
         SR_WRITE_VALUE(file, SR_DEV_NUMCONFDEV, dev->numconfdev, sizeof(dev->numconfdev));
+
+#if !defined( _MSVC_ )
+        /* Shadow files frozen for clones (all but the active one) */
+        if (clone && dev->cckd_ext)
+        {
+            char  sfn[MAX_PATH];
+            char  path[PATH_MAX];
+            int   sfcount;
+
+            sfcount = SR_CCKD_SFN( dev ) - 1;
+            SR_WRITE_VALUE(file, SR_DEV_SFCOUNT, sfcount, sizeof(sfcount));
+            for (i = 1; i <= sfcount; i++)
+            {
+                /* (see cckd_sf_name) */
+                STRLCPY( sfn, dev->dasdsfn );
+                sfn[ dev->dasdsfx - dev->dasdsfn ] = '0' + i;
+                if (realpath( sfn, path ))
+                    STRLCPY( sfn, path );
+                SR_WRITE_STRING(file, SR_DEV_SFNAME, sfn);
+            }
+        }
+#else
+        UNREFERENCED( clone );
+#endif
+
         SR_WRITE_STRING(file, SR_DEV_TYPNAME, dev->typname);
 
         /* Common device fields */
@@ -336,11 +416,52 @@ BYTE     psw[16];
         if (dev->hnd->hsuspend)
         {
             rc = (dev->hnd->hsuspend) (dev, file);
-            if (rc < 0) goto sr_error_exit;
+            if (rc < 0) return -1;
         }
         SR_WRITE_HDR(file, SR_DELIMITER, 0);
     }
 
+    return 0;
+}
+
+int suspend_cmd(int argc, char *argv[],char *cmdline)
+{
+char    *fn = SR_DEFAULT_FILENAME;
+SR_FILE  file;
+CPU_BITMAP started_mask;
+
+    UNREFERENCED(cmdline);
+
+    if (argc > 2)
+    {
+        // "SR: too many arguments"
+        WRMSG(HHC02000, "E");
+        return -1;
+    }
+
+    if (argc == 2)
+        fn = argv[1];
+
+    file = SR_OPEN (fn, "wb");
+    if (file == NULL)
+    {
+        // "SR: error in function '%s': '%s'"
+        WRMSG(HHC02001, "E","open()",strerror(errno));
+        return -1;
+    }
+
+    TRACE("SR: Begin Suspend Processing...\n");
+
+    sr_quiesce( &started_mask );
+
+    if (0
+        || sr_write_header( file ) < 0
+        || sr_write_system( file, started_mask, 1 ) < 0
+        || sr_write_cpus( file ) < 0
+        || sr_write_devices( file, 0 ) < 0
+    )
+        goto sr_error_exit;
+
     TRACE("SR: Writing EOF\n");
 
     SR_WRITE_HDR(file, SR_EOF, 0);
@@ -362,14 +483,119 @@ sr_error_exit:
 
 #define SR_NULL_REGS_CHECK(_regs)  if ((_regs) == NULL) goto sr_null_regs_exit;
 
-int resume_cmd(int argc, char *argv[],char *cmdline)
+/*-------------------------------------------------------------------*/
+/* Clone being resumed (NULL for resume and migrate)                 */
+/*-------------------------------------------------------------------*/
+struct CLONECTL
+{
+    const char*  dir;                   /* Snapshot directory        */
+    int          num;                   /* Clone number              */
+};
+
+#if !defined( _MSVC_ )
+/*-------------------------------------------------------------------*/
+/* Give a clone its own MAC address by adding the clone number to    */
+/* the last byte of any argument (or argument value) that is one     */
+/*-------------------------------------------------------------------*/
+static void sr_clone_mac( char* arg, int num )
+{
+char    *p;
+int      i;
+BYTE     b;
+
+    p = strchr( arg, '=' );
+    p = p ? p + 1 : arg;
+
+    if (strlen( p ) != 17)
+        return;
+    for (i = 0; i < 17; i++)
+        if (i % 3 == 2 ? (p[i] != ':' && p[i] != '-') : !isxdigit( p[i] ))
+            return;
+
+    sscanf( p + 15, "%2hhx", &b );
+    snprintf( p + 15, 3, islower( p[15] ) || islower( p[16] ) ? "%02x" : "%02X",
+              (BYTE)(b + num) );
+}
+
+/*-------------------------------------------------------------------*/
+/* Adjust the arguments of a device being attached in a clone.       */
+/* A cckd disk gets a shadow file of its own in the clone's          */
+/* directory, stacked on links to the shadow files that were frozen  */
+/* when the snapshot was taken.                                      */
+/*-------------------------------------------------------------------*/
+static int sr_clone_args( const struct CLONECTL* clone, U16 lcss,
+                          U16 devnum, int* argc, char* argv[], int maxargc,
+                          int sfcount, char* sfname[] )
+{
+char     dir[MAX_PATH];
+char     sfn[MAX_PATH];
+int      i, j;
+
+    for (i = 0; i < *argc; i++)
+        if (argv[i])
+            sr_clone_mac( argv[i], clone->num );
+
+    if (sfcount < 0)
+        return 0;
+
+    MSGBUF( dir, "%s/clone%d", clone->dir, clone->num );
+    if (mkdir( dir, S_IRWXU | S_IRGRP | S_IXGRP ) < 0 && errno != EEXIST)
+    {
+        MSGBUF( sfn, "mkdir( %s ): %s", dir, strerror( errno ));
+        // "SR: clone failed: %s"
+        WRMSG( HHC02031, "E", sfn );
+        return -1;
+    }
+
+    /* Links from an earlier run of the same clone are replaced */
+    for (i = 1; i <= CCKD_MAX_SF; i++)
+    {
+        MSGBUF( sfn, "%s/%1d_%04X_%d.shd", dir, lcss, devnum, i );
+        unlink( sfn );
+        if (i <= sfcount && symlink( sfname[i-1], sfn ) < 0)
+        {
+            MSGBUF( dir, "symlink( %s ): %s", sfn, strerror( errno ));
+            // "SR: clone failed: %s"
+            WRMSG( HHC02031, "E", dir );
+            return -1;
+        }
+    }
+
+    /* Replace the shadow file options */
+    for (i = j = 0; i < *argc; i++)
+    {
+        if (argv[i] && (strncasecmp( argv[i], "sf=", 3 ) == 0
+                     || strcasecmp ( argv[i], "sfnew" ) == 0))
+            free( argv[i] );
+        else
+            argv[j++] = argv[i];
+    }
+    if (j + 2 > maxargc)
+    {
+        // "SR: clone failed: %s"
+        WRMSG( HHC02031, "E", "too many device arguments" );
+        *argc = j;
+        return -1;
+    }
+    MSGBUF( sfn, "sf=%s/%1d_%04X_0.shd", dir, lcss, devnum );
+    argv[j++] = strdup( sfn );
+    argv[j++] = strdup( "sfnew" );
+    *argc = j;
+
+    return 0;
+}
+#endif /* !defined( _MSVC_ ) */
+
+/*-------------------------------------------------------------------*/
+/* Process state records up to and including SR_EOF                  */
+/*-------------------------------------------------------------------*/
+static int sr_resume_records( SR_FILE file, const char* fn,
+                              CPU_BITMAP* started_mask,
+                              const struct CLONECTL* clone )
 {
-char    *fn = SR_DEFAULT_FILENAME;
-SR_FILE  file;
 U32      key = 0, len = 0;
 U64      mainsize = 0;
 U64      xpndsize = 0;
-CPU_BITMAP started_mask = 0;
 int      i, rc = -1;
 REGS    *regs = NULL;
 U16      devnum=0;
@@ -384,61 +610,14 @@ char     buf[SR_MAX_STRING_LENGTH+1];
 char     zeros[16];
 S64      dreg;
 int      numconfdev=0;
+int      sfcount=-1;
+char    *sfname[CCKD_MAX_SF];
+int      sfx=0;
 
-    UNREFERENCED(cmdline);
-
-    if (argc > 2)
-    {
-        // "SR: too many arguments"
-        WRMSG(HHC02000, "E");
-        return -1;
-    }
-
-    if (argc == 2)
-        fn = argv[1];
+    UNREFERENCED(clone);
 
     memset (zeros, 0, sizeof(zeros));
 
-    TRACE("SR: Begin Resume Processing...\n");
-
-    /* Make sure all CPUs are deconfigured or stopped */
-    TRACE("SR: Waiting for CPUs to stop...\n");
-    if (!are_all_cpus_stopped())
-    {
-        // "SR: all processors must be stopped to resume"
-        WRMSG(HHC02005, "E");
-        return -1;
-    }
-
-    file = SR_OPEN (fn, "rb");
-    if (file == NULL)
-    {
-        // "SR: error in function '%s': '%s'"
-        WRMSG(HHC02001, "E", "open()",strerror(errno));
-        return -1;
-    }
-
-    /* First key must be SR_HDR_ID and string must match SR_ID */
-    TRACE("SR: Reading File Header...\n");
-    SR_READ_HDR(file, key, len);
-    if (key == SR_HDR_ID) SR_READ_STRING(file, buf, len);
-    if (key != SR_HDR_ID || strcmp(buf, SR_ID))
-    {
-        // "SR: file identifier error"
-        WRMSG(HHC02006, "E");
-        goto sr_error_exit;
-    }
-
-    /* Deconfigure all CPUs */
-    TRACE("SR: Deconfiguring all CPUs...\n");
-    OBTAIN_INTLOCK(NULL);
-    for (i = 0; i < sysblk.maxcpu; i++)
-        if (IS_CPU_ONLINE(i))
-            deconfigure_cpu(i);
-    RELEASE_INTLOCK(NULL);
-
-    TRACE("SR: Processing Resume File...\n");
-
     while (key != SR_EOF)
     {
         SR_READ_HDR(file, key, len);
@@ -458,7 +637,7 @@ int      numconfdev=0;
             break;
 
         case SR_SYS_STARTED_MASK:
-            SR_READ_VALUE(file, len, &started_mask, sizeof(started_mask));
+            SR_READ_VALUE(file, len, started_mask, sizeof(*started_mask));
             break;
 
         case SR_SYS_ARCH_NAME:
@@ -489,6 +668,7 @@ int      numconfdev=0;
 
         case SR_SYS_MAINSIZE:
             SR_READ_VALUE(file, len, &mainsize, sizeof(mainsize));
+            mainshare_reset();
             if (mainsize > sysblk.mainsize)
             {
                 char buf1[20];
@@ -506,6 +686,38 @@ int      numconfdev=0;
             SR_READ_BUF(file, sysblk.mainstor, mainsize);
             break;
 
+        case SR_SYS_MIGPAGE:
+        {
+            BYTE  addr[8];
+            U64   abs;
+
+            if (len != sizeof(addr) + STORAGE_KEY_4K_PAGESIZE)
+            {
+                char buf1[20];
+                char buf2[20];
+                MSGBUF(buf1, "%u", len);
+                MSGBUF(buf2, "%u", (U32)(sizeof(addr) + STORAGE_KEY_4K_PAGESIZE));
+                // "SR: mismatch in '%s': '%s' found, '%s' expected"
+                WRMSG(HHC02009, "E", "page size", buf1, buf2);
+                goto sr_error_exit;
+            }
+            SR_READ_BUF(file, addr, sizeof(addr));
+            abs = fetch_dw(addr);
+            if ((abs & STORAGE_KEY_4K_BYTEMASK)
+                || abs + STORAGE_KEY_4K_PAGESIZE > sysblk.mainsize)
+            {
+                char buf1[20];
+                char buf2[20];
+                MSGBUF(buf1, "%"PRIX64, abs);
+                MSGBUF(buf2, "<%"PRIX64, (U64)sysblk.mainsize);
+                // "SR: mismatch in '%s': '%s' found, '%s' expected"
+                WRMSG(HHC02009, "E", "page address", buf1, buf2);
+                goto sr_error_exit;
+            }
+            SR_READ_BUF(file, sysblk.mainstor + abs, STORAGE_KEY_4K_PAGESIZE);
+        }
+        break;
+
         case SR_SYS_SKEYSIZE:
             SR_READ_VALUE(file, len, &len, sizeof(len));
             if (len > (U32)(sysblk.mainsize/_STORKEY_ARRAY_UNITSIZE))
@@ -751,6 +963,7 @@ int      numconfdev=0;
         case SR_CPU_PX:
             SR_NULL_REGS_CHECK(regs);
             SR_READ_VALUE(file, len, &regs->px, sizeof(regs->px));
+            storshm_cpu( regs->cpuad );
             break;
 
         case SR_CPU_PSW:
@@ -1103,9 +1316,43 @@ int      numconfdev=0;
             if (devargx < devargc) devargv[devargx++] = strdup(buf);
             break;
 
+        case SR_DEV_SFCOUNT:
+            SR_READ_VALUE(file, len, &sfcount, sizeof(sfcount));
+            if (sfcount > CCKD_MAX_SF) sfcount = CCKD_MAX_SF;
+            sfx = 0;
+            break;
+
+        case SR_DEV_SFNAME:
+            SR_READ_STRING(file, buf, len);
+            if (sfx < sfcount) sfname[sfx++] = strdup(buf);
+            break;
+
         case SR_DEV_TYPNAME:
             SR_READ_STRING(file, buf, len);
             dev = find_device_by_devnum(lcss,devnum);
+#if !defined( _MSVC_ )
+            /* A clone attaches every device with its own arguments */
+            if (clone)
+            {
+                if (dev != NULL)
+                {
+                    detach_device(lcss, devnum);
+                    dev = NULL;
+                }
+                devargc = devargx;
+                if (sfx < sfcount) sfcount = sfx;
+                rc = sr_clone_args(clone, lcss, devnum, &devargc, devargv,
+                                   (int) _countof(devargv), sfcount, sfname);
+                devargx = devargc;
+                if (rc < 0)
+                    goto sr_error_exit;
+                rc = -1;
+            }
+#endif
+            for (i = 0; i < sfx; i++)
+                free(sfname[i]);
+            sfcount = -1;
+            sfx = 0;
             if (dev == NULL)
             {
                 if (numconfdev == 0) numconfdev = 1;
@@ -1396,21 +1643,6 @@ int      numconfdev=0;
 #endif
     machine_check_crwpend();
 
-    /* Start the CPUs */
-    TRACE("SR: Resuming CPUs...\n");
-    OBTAIN_INTLOCK(NULL);
-    ON_IC_IOPENDING;
-    for (i = 0; i < sysblk.maxcpu; i++)
-        if (IS_CPU_ONLINE(i) && (started_mask & CPU_BIT(i)))
-        {
-            sysblk.regs[i]->opinterv = 0;
-            sysblk.regs[i]->cpustate = CPUSTATE_STARTED;
-            sysblk.regs[i]->checkstop = 0;
-            WAKEUP_CPU(sysblk.regs[i]);
-        }
-    RELEASE_INTLOCK(NULL);
-
-    TRACE("SR: Resume Complete; System Resumed.\n");
     return 0;
 
 sr_null_regs_exit:
@@ -1420,10 +1652,962 @@ sr_null_regs_exit:
 sr_error_exit:
     // "SR: error processing file '%s'"
     WRMSG(HHC02004, "E", fn);
-    SR_CLOSE (file);
     return -1;
 }
 
+/*-------------------------------------------------------------------*/
+/* Check the file header, then restore the saved state               */
+/*-------------------------------------------------------------------*/
+static int sr_resume_file( SR_FILE file, const char* fn,
+                           CPU_BITMAP* started_mask,
+                           const struct CLONECTL* clone )
+{
+U32      key = 0, len = 0;
+int      i;
+char     buf[SR_MAX_STRING_LENGTH+1];
+
+    /* First key must be SR_HDR_ID and string must match SR_ID */
+    TRACE("SR: Reading File Header...\n");
+    SR_READ_HDR(file, key, len);
+    if (key == SR_HDR_ID) SR_READ_STRING(file, buf, len);
+    if (key != SR_HDR_ID || strcmp(buf, SR_ID))
+    {
+        // "SR: file identifier error"
+        WRMSG(HHC02006, "E");
+        goto sr_error_exit;
+    }
+
+    /* Deconfigure all CPUs */
+    TRACE("SR: Deconfiguring all CPUs...\n");
+    OBTAIN_INTLOCK(NULL);
+    for (i = 0; i < sysblk.maxcpu; i++)
+        if (IS_CPU_ONLINE(i))
+            deconfigure_cpu(i);
+    RELEASE_INTLOCK(NULL);
+
+    TRACE("SR: Processing Resume File...\n");
+    return sr_resume_records( file, fn, started_mask, clone );
+
+sr_error_exit:
+    // "SR: error processing file '%s'"
+    WRMSG(HHC02004, "E", fn);
+    return -1;
+}
+
+int resume_cmd(int argc, char *argv[],char *cmdline)
+{
+char    *fn = SR_DEFAULT_FILENAME;
+SR_FILE  file;
+CPU_BITMAP started_mask = 0;
+int      rc;
+
+    UNREFERENCED(cmdline);
+
+    if (argc > 2)
+    {
+        // "SR: too many arguments"
+        WRMSG(HHC02000, "E");
+        return -1;
+    }
+
+    if (argc == 2)
+        fn = argv[1];
+
+    TRACE("SR: Begin Resume Processing...\n");
+
+    /* Make sure all CPUs are deconfigured or stopped */
+    TRACE("SR: Waiting for CPUs to stop...\n");
+    if (!are_all_cpus_stopped())
+    {
+        // "SR: all processors must be stopped to resume"
+        WRMSG(HHC02005, "E");
+        return -1;
+    }
+
+    file = SR_OPEN (fn, "rb");
+    if (file == NULL)
+    {
+        // "SR: error in function '%s': '%s'"
+        WRMSG(HHC02001, "E", "open()",strerror(errno));
+        return -1;
+    }
+
+    rc = sr_resume_file( file, fn, &started_mask, NULL );
+    SR_CLOSE (file);
+    if (rc < 0)
+        return -1;
+
+    /* Start the CPUs */
+    TRACE("SR: Resuming CPUs...\n");
+    sr_start_cpus( started_mask );
+
+    TRACE("SR: Resume Complete; System Resumed.\n");
+    return 0;
+}
+
+#if !defined( _MSVC_ )
+/*-------------------------------------------------------------------*/
+/*                         Live migration                            */
+/*-------------------------------------------------------------------*/
+/* The source sends main storage to the target over a TCP connection */
+/* while the guest keeps running, and keeps resending the pages that */
+/* changed until their number stops shrinking.  Changed pages are    */
+/* found using the host kernel's soft-dirty page bits when these are */
+/* available, and otherwise by comparing a digest of each page with  */
+/* the digest of the copy that was last sent.  The guest's own       */
+/* storage key change bits are not used: resetting them would be     */
+/* visible to the guest.                                             */
+/*                                                                   */
+/* The CPUs are then stopped and every page whose digest differs is  */
+/* sent, followed by the usual suspend records.  The device records  */
+/* are only sent after the devices were detached, so that the target */
+/* never opens an image file that the source still has open.  The    */
+/* target replies MIG_ACK and starts the guest, leaving the source   */
+/* stopped, or replies MIG_NAK in which case the source reattaches   */
+/* its devices from the same records and restarts its CPUs.          */
+/*-------------------------------------------------------------------*/
+
+#define MIG_PAGESIZE        STORAGE_KEY_4K_PAGESIZE
+#define MIG_MAXPASS         30      /* Maximum pre-copy passes       */
+#define MIG_MINPAGES        64      /* Few enough to stop and copy   */
+#define MIG_CONNECT_SECS    30      /* Wait for target to listen     */
+#define MIG_ACCEPT_SECS     60      /* Wait for source to connect    */
+#define MIG_IDLE_SECS       120     /* Wait for source to send data  */
+#define MIG_REPLY_SECS      60      /* Wait for target to resume     */
+#define MIG_ACK             'A'     /* Target resumed the guest      */
+#define MIG_NAK             'N'     /* Target rejected the state     */
+#define MIG_SOFTDIRTY       0x0080000000000000ULL /* pagemap bit 55  */
+
+typedef struct MIGCTL MIGCTL;
+struct MIGCTL
+{
+    SR_FILE  file;                      /* Stream to the target      */
+    U64      npages;                    /* Number of main stor pages */
+    U64      sent;                      /* Total pages sent          */
+    U64     *digest;                    /* Digest of page last sent  */
+    BYTE    *dirty;                     /* Soft-dirty page candidate */
+    int      pagemap;                   /* /proc/self/pagemap or -1  */
+    BYTE     page[8+MIG_PAGESIZE];      /* SR_SYS_MIGPAGE text unit  */
+};
+
+/*-------------------------------------------------------------------*/
+/* Page digest.  Each step is a bijection of the running value, so a */
+/* change confined to a single doubleword always changes the digest. */
+/*-------------------------------------------------------------------*/
+static U64 mig_digest( const BYTE* page )
+{
+U64      h = 0xcbf29ce484222325ULL;
+U64      w;
+int      i;
+
+    for (i = 0; i < MIG_PAGESIZE; i += sizeof(w))
+    {
+        memcpy( &w, page + i, sizeof(w) );
+        h = (h ^ w) * 0x00000100000001b3ULL;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+/*-------------------------------------------------------------------*/
+/* Reset the soft-dirty bits of every page of this process           */
+/*-------------------------------------------------------------------*/
+static int mig_clear_softdirty()
+{
+int      fd, rc;
+
+    if ((fd = open( "/proc/self/clear_refs", O_WRONLY )) < 0)
+        return -1;
+    rc = write( fd, "4", 1 );
+    close( fd );
+    return (rc == 1) ? 0 : -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return the soft-dirty bit of the host page containing 'addr'      */
+/*-------------------------------------------------------------------*/
+static int mig_softdirty( int pagemap, const void* addr )
+{
+U64      ent;
+off_t    off;
+
+    off = (off_t)((uintptr_t) addr / getpagesize()) * sizeof(ent);
+    if (pread( pagemap, &ent, sizeof(ent), off ) != sizeof(ent))
+        return -1;
+    return (ent & MIG_SOFTDIRTY) ? 1 : 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Open the pagemap if the host kernel tracks soft-dirty pages.      */
+/* The probe page must become dirty when stored into and clean when  */
+/* reset, otherwise -1 is returned and digests are used instead.     */
+/*-------------------------------------------------------------------*/
+static int mig_softdirty_open( volatile BYTE* probe )
+{
+int      fd;
+
+    if ((fd = open( "/proc/self/pagemap", O_RDONLY )) < 0)
+        return -1;
+
+    if (mig_clear_softdirty() == 0)
+    {
+        *probe = 1;
+        if (mig_softdirty( fd, (void*) probe ) == 1
+            && mig_clear_softdirty() == 0
+            && mig_softdirty( fd, (void*) probe ) == 0)
+            return fd;
+    }
+    close( fd );
+    return -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Mark the main storage pages whose host page is soft-dirty         */
+/*-------------------------------------------------------------------*/
+static int mig_scan_softdirty( MIGCTL* mig )
+{
+U64       ent[512];                     /* pagemap entries           */
+uintptr_t base = (uintptr_t) sysblk.mainstor;
+uintptr_t end  = base + sysblk.mainsize;
+uintptr_t hpsz = getpagesize();         /* Host page size            */
+uintptr_t hp, lo, hi, a;
+size_t    n, i;
+
+    for (hp = base / hpsz; hp * hpsz < end; hp += n)
+    {
+        n = MIN( _countof( ent ), (end - 1) / hpsz - hp + 1 );
+        if (pread( mig->pagemap, ent, n * sizeof(ent[0]),
+                   (off_t)(hp * sizeof(ent[0])) ) != (ssize_t)(n * sizeof(ent[0])))
+            return -1;
+
+        for (i = 0; i < n; i++)
+        {
+            if (!(ent[i] & MIG_SOFTDIRTY))
+                continue;
+            lo = MAX( (hp + i) * hpsz, base ) - base;
+            hi = MIN( (hp + i + 1) * hpsz, end ) - base;
+            for (a = lo & ~(uintptr_t)(MIG_PAGESIZE-1); a < hi; a += MIG_PAGESIZE)
+                mig->dirty[ a / MIG_PAGESIZE ] = 1;
+        }
+    }
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Send the pages whose digest differs from the one last sent, or    */
+/* every page if 'force'.  Only soft-dirty candidates are examined   */
+/* unless 'all'.  Returns the number of pages sent or -1 on error.   */
+/*-------------------------------------------------------------------*/
+static S64 mig_send_pages( MIGCTL* mig, int all, int force )
+{
+U64      i, h;
+S64      n = 0;
+
+    for (i = 0; i < mig->npages; i++)
+    {
+        if (!all && !mig->dirty[i])
+            continue;
+        mig->dirty[i] = 0;
+
+        /* Digest a private copy so that what is sent matches it */
+        memcpy( mig->page + 8, sysblk.mainstor + i * MIG_PAGESIZE, MIG_PAGESIZE );
+        h = mig_digest( mig->page + 8 );
+        if (!force && h == mig->digest[i])
+            continue;
+
+        mig->digest[i] = h;
+        store_dw( mig->page, i * MIG_PAGESIZE );
+        SR_WRITE_BUF( mig->file, SR_SYS_MIGPAGE, mig->page, sizeof(mig->page) );
+        n++;
+    }
+    mig->sent += n;
+    return n;
+}
+
+/*-------------------------------------------------------------------*/
+/* Pre-copy main storage until the number of changed pages converges */
+/*-------------------------------------------------------------------*/
+static int mig_precopy( MIGCTL* mig )
+{
+S64      n, prev = 0;
+int      pass, all;
+
+    for (pass = 0; pass < MIG_MAXPASS; pass++)
+    {
+        all = (pass == 0 || mig->pagemap < 0);
+
+        /* Collect the candidates, then reset the bits before copying */
+        if (mig->pagemap >= 0
+            && ((!all && mig_scan_softdirty( mig ) < 0)
+                || mig_clear_softdirty() < 0))
+        {
+            close( mig->pagemap );
+            mig->pagemap = -1;
+            all = 1;
+        }
+
+        if ((n = mig_send_pages( mig, all, pass == 0 )) < 0)
+            return -1;
+
+        // "SR: migration pass %d: %"PRIu64" pages sent, %s change tracking"
+        WRMSG( HHC02024, "I", pass, (U64) n,
+            mig->pagemap >= 0 ? "soft-dirty" : "digest" );
+
+        if (pass > 0 && (n <= MIG_MINPAGES || n >= prev))
+            break;
+        prev = n;
+    }
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Detach every valid device                                         */
+/*-------------------------------------------------------------------*/
+static void mig_detach_devices()
+{
+DEVBLK  *dev;
+
+    for (dev = sysblk.firstdev; dev; dev = dev->nextdev)
+        if (dev->allocated && (dev->pmcw.flag5 & PMCW5_V))
+            detach_device( SSID_TO_LCSS( dev->ssid ), dev->devnum );
+}
+
+/*-------------------------------------------------------------------*/
+/* Copy the contents of a file to the socket                         */
+/*-------------------------------------------------------------------*/
+static int mig_send_file( int sock, int fd, BYTE* buf, int bufsize )
+{
+int      n;
+
+    if (lseek( fd, 0, SEEK_SET ) < 0)
+        return -1;
+    while ((n = read( fd, buf, bufsize )) > 0)
+        if (write_socket( sock, buf, n ) != n)
+            return -1;
+    return n;
+}
+
+/*-------------------------------------------------------------------*/
+/* Convert "[host:]port" to a socket address                         */
+/*-------------------------------------------------------------------*/
+static int mig_sockspec( const char* spec, struct sockaddr_in* sin )
+{
+char     host[256];
+const char* port;
+struct hostent* he;
+
+    memset( sin, 0, sizeof(*sin) );
+    sin->sin_family      = AF_INET;
+    sin->sin_addr.s_addr = INADDR_ANY;
+
+    if ((port = strrchr( spec, ':' )))
+    {
+        if (port == spec || port - spec >= (int) sizeof(host))
+            return -1;
+        memcpy( host, spec, port - spec );
+        host[ port - spec ] = 0;
+        if (!(he = gethostbyname( host )))
+            return -1;
+        memcpy( &sin->sin_addr, *he->h_addr_list, sizeof(sin->sin_addr) );
+        port++;
+    }
+    else
+        port = spec;
+
+    if (!*port || strspn( port, "0123456789" ) != strlen( port )
+        || atoi( port ) < 1 || atoi( port ) > 65535)
+        return -1;
+    sin->sin_port = htons( (U16) atoi( port ));
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Wait until a socket is readable; returns > 0 if it is             */
+/*-------------------------------------------------------------------*/
+static int mig_wait( int sock, int secs )
+{
+fd_set   readset;
+struct timeval tv;
+int      rc;
+
+    tv.tv_sec  = secs;
+    tv.tv_usec = 0;
+    do
+    {
+        FD_ZERO( &readset );
+        FD_SET( sock, &readset );
+        rc = select( sock + 1, &readset, NULL, NULL, &tv );
+    }
+    while (rc < 0 && HSO_errno == HSO_EINTR);
+    return rc;
+}
+
+/*-------------------------------------------------------------------*/
+/* Source side: migrate the guest to the instance at 'spec'          */
+/*-------------------------------------------------------------------*/
+static int mig_outgoing( const char* spec )
+{
+struct sockaddr_in sin;
+MIGCTL  *mig = NULL;
+CPU_BITMAP started_mask = 0;
+SR_FILE  dfile;
+FILE    *tmp = NULL;
+TOD      tod = 0;
+char     msgbuf[256];
+int      sock = -1, rc = -1, err, i;
+BYTE     reply = 0;
+
+    if (mig_sockspec( spec, &sin ) < 0)
+    {
+        // "SR: migration failed: %s"
+        MSGBUF( msgbuf, "invalid address %s", spec );
+        WRMSG( HHC02027, "E", msgbuf );
+        return -1;
+    }
+
+    /* Connect, allowing the target some time to start listening */
+    for (i = 0; ; i++)
+    {
+        if ((sock = socket( AF_INET, SOCK_STREAM, 0 )) < 0)
+        {
+            MSGBUF( msgbuf, "socket(): %s", strerror( HSO_errno ));
+            goto mig_error;
+        }
+        if (connect( sock, (struct sockaddr*) &sin, sizeof(sin) ) == 0)
+            break;
+        err = HSO_errno;
+        close_socket( sock );
+        sock = -1;
+        if (err != HSO_ECONNREFUSED || i >= MIG_CONNECT_SECS)
+        {
+            MSGBUF( msgbuf, "connect(): %s", strerror( err ));
+            goto mig_error;
+        }
+        SLEEP( 1 );
+    }
+
+    // "SR: migration %s %s"
+    WRMSG( HHC02023, "I", "connected to", spec );
+
+    MSGBUF( msgbuf, "unable to send state to %s", spec );
+    if (0
+        || !(mig = calloc( 1, sizeof(MIGCTL) ))
+        || !(mig->digest = malloc( (sysblk.mainsize / MIG_PAGESIZE) * sizeof(U64) ))
+        || !(mig->dirty = calloc( sysblk.mainsize / MIG_PAGESIZE, 1 ))
+    )
+    {
+        MSGBUF( msgbuf, "malloc(): %s", strerror( errno ));
+        goto mig_error;
+    }
+    mig->npages  = sysblk.mainsize / MIG_PAGESIZE;
+    mig->pagemap = mig_softdirty_open( mig->page );
+
+    if (!(mig->file = SR_DOPEN( dup( sock ), SR_MIG_WMODE )))
+        goto mig_error;
+
+    /* Pre-copy main storage while the guest keeps running */
+    if (0
+        || sr_write_header( mig->file ) < 0
+        || sr_write_value( (FILE*) mig->file, SR_SYS_MAINSIZE,
+                           sysblk.mainsize, sizeof(sysblk.mainsize) ) != 0
+        || mig_precopy( mig ) < 0
+    )
+        goto mig_error;
+
+    /* Stop the guest and send what changed since, and all the rest */
+    tod = host_tod();
+    sr_quiesce( &started_mask );
+
+    if (0
+        || mig_send_pages( mig, 1, 0 ) < 0
+        || sr_write_system( mig->file, started_mask, 0 ) < 0
+        || sr_write_cpus( mig->file ) < 0
+    )
+        goto mig_stopped_error;
+
+    rc = SR_CLOSE( mig->file );
+    mig->file = NULL;
+    if (rc != 0)
+        goto mig_stopped_error;
+    rc = -1;
+
+    /* Save the device records, then release the devices */
+    if (!(tmp = tmpfile())
+        || !(dfile = SR_DOPEN( dup( fileno( tmp )), SR_MIG_WMODE )))
+        goto mig_stopped_error;
+    i = (sr_write_devices( dfile, 0 ) < 0
+         || sr_write_hdr( (FILE*) dfile, SR_EOF, 0 ) != 0);
+    if (SR_CLOSE( dfile ) != 0 || i)
+        goto mig_stopped_error;
+
+    mig_detach_devices();
+
+    if (mig_send_file( sock, fileno( tmp ), mig->page, sizeof(mig->page) ) < 0)
+        goto mig_detached_error;
+    shutdown( sock, SHUT_WR );
+
+    /* Wait for the target to resume the guest */
+    if (mig_wait( sock, MIG_REPLY_SECS ) <= 0
+        || read_socket( sock, &reply, 1 ) != 1)
+        reply = 0;
+
+    if (reply == MIG_NAK)
+    {
+        MSGBUF( msgbuf, "state rejected by %s", spec );
+        goto mig_detached_error;
+    }
+
+    if (reply != MIG_ACK)
+    {
+        /* The target may or may not be running the guest now */
+        // "SR: migration to %s not confirmed; processors left stopped"
+        WRMSG( HHC02028, "W", spec );
+        goto mig_exit;
+    }
+
+    // "SR: migration to %s complete: %"PRIu64" pages sent, downtime %"PRIu64" ms"
+    WRMSG( HHC02025, "I", spec, mig->sent,
+        (U64)((host_tod() - tod) / ETOD_USEC / 1000) );
+    rc = 0;
+    goto mig_exit;
+
+mig_detached_error:
+    /* Reattach the devices and restore their state */
+    lseek( fileno( tmp ), 0, SEEK_SET );
+    if ((dfile = SR_DOPEN( dup( fileno( tmp )), "rb" )))
+    {
+        CPU_BITMAP unused;
+        sr_resume_records( dfile, spec, &unused, NULL );
+        SR_CLOSE( dfile );
+    }
+    /* Fall through */
+mig_stopped_error:
+    sr_start_cpus( started_mask );
+    /* Fall through */
+mig_error:
+    // "SR: migration failed: %s"
+    WRMSG( HHC02027, "E", msgbuf );
+
+mig_exit:
+    if (tmp)
+        fclose( tmp );
+    if (mig)
+    {
+        if (mig->file)
+            SR_CLOSE( mig->file );
+        if (mig->pagemap >= 0)
+            close( mig->pagemap );
+        free( mig->digest );
+        free( mig->dirty );
+        free( mig );
+    }
+    if (sock >= 0)
+        close_socket( sock );
+    return rc;
+}
+
+/*-------------------------------------------------------------------*/
+/* Target side: accept a migration on 'spec' and resume the guest    */
+/*-------------------------------------------------------------------*/
+static int mig_incoming( const char* spec )
+{
+struct sockaddr_in sin;
+socklen_t  namelen = sizeof(sin);
+CPU_BITMAP started_mask = 0;
+SR_FILE  file;
+struct timeval tv;
+char     from[64];
+char     msgbuf[256];
+int      lsock, sock, optval = 1, rc;
+BYTE     reply;
+
+    /* Make sure no CPU is started (one that is stopping is fine) */
+    if (are_any_cpus_started())
+    {
+        // "SR: all processors must be stopped to resume"
+        WRMSG( HHC02005, "E" );
+        return -1;
+    }
+
+    if (mig_sockspec( spec, &sin ) < 0)
+    {
+        // "SR: migration failed: %s"
+        MSGBUF( msgbuf, "invalid address %s", spec );
+        WRMSG( HHC02027, "E", msgbuf );
+        return -1;
+    }
+
+    if ((lsock = socket( AF_INET, SOCK_STREAM, 0 )) < 0)
+    {
+        MSGBUF( msgbuf, "socket(): %s", strerror( HSO_errno ));
+        // "SR: migration failed: %s"
+        WRMSG( HHC02027, "E", msgbuf );
+        return -1;
+    }
+    setsockopt( lsock, SOL_SOCKET, SO_REUSEADDR,
+                (GETSET_SOCKOPT_T*) &optval, sizeof(optval) );
+
+    if (0
+        || bind( lsock, (struct sockaddr*) &sin, sizeof(sin) ) < 0
+        || listen( lsock, 1 ) < 0
+    )
+    {
+        MSGBUF( msgbuf, "bind(): %s", strerror( HSO_errno ));
+        // "SR: migration failed: %s"
+        WRMSG( HHC02027, "E", msgbuf );
+        close_socket( lsock );
+        return -1;
+    }
+
+    // "SR: migration %s %s"
+    WRMSG( HHC02023, "I", "waiting for connection on", spec );
+
+    if ((rc = mig_wait( lsock, MIG_ACCEPT_SECS )) > 0)
+        sock = accept( lsock, (struct sockaddr*) &sin, &namelen );
+    else
+        sock = -1;
+    if (sock < 0)
+    {
+        if (rc == 0)
+            MSGBUF( msgbuf, "no connection on %s", spec );
+        else
+            MSGBUF( msgbuf, "accept(): %s", strerror( HSO_errno ));
+        // "SR: migration failed: %s"
+        WRMSG( HHC02027, "E", msgbuf );
+        close_socket( lsock );
+        return -1;
+    }
+    close_socket( lsock );
+
+    MSGBUF( from, "%s:%d", inet_ntoa( sin.sin_addr ), ntohs( sin.sin_port ));
+    // "SR: migration %s %s"
+    WRMSG( HHC02023, "I", "connected from", from );
+
+    /* Don't wait forever for a source that went away */
+    tv.tv_sec  = MIG_IDLE_SECS;
+    tv.tv_usec = 0;
+    setsockopt( sock, SOL_SOCKET, SO_RCVTIMEO,
+                (GETSET_SOCKOPT_T*) &tv, sizeof(tv) );
+
+    rc = -1;
+    if ((file = SR_DOPEN( dup( sock ), "rb" )))
+    {
+        rc = sr_resume_file( file, from, &started_mask, NULL );
+        SR_CLOSE( file );
+    }
+
+    reply = (rc < 0) ? MIG_NAK : MIG_ACK;
+    write_socket( sock, &reply, 1 );
+    close_socket( sock );
+
+    if (rc < 0)
+    {
+        // "SR: migration failed: %s"
+        MSGBUF( msgbuf, "unable to resume state from %s", from );
+        WRMSG( HHC02027, "E", msgbuf );
+        return -1;
+    }
+
+    sr_start_cpus( started_mask );
+
+    // "SR: migration from %s complete; guest resumed"
+    WRMSG( HHC02026, "I", from );
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* migrate command                                                   */
+/*-------------------------------------------------------------------*/
+int migrate_cmd(int argc, char *argv[],char *cmdline)
+{
+    UNREFERENCED(cmdline);
+
+    if (argc == 3 && CMD( argv[1], INCOMING, 3 ))
+        return mig_incoming( argv[2] );
+
+    if (argc == 2)
+        return mig_outgoing( argv[1] );
+
+    // "Invalid command usage. Type 'help %s' for assistance."
+    WRMSG( HHC02299, "E", argv[0] );
+    return -1;
+}
+
+/*-------------------------------------------------------------------*/
+/*                          Machine clones                           */
+/*-------------------------------------------------------------------*/
+/* 'clone dir' writes main storage to an image file and the rest of  */
+/* the state to a suspend file.  Every compressed disk first gets a  */
+/* new shadow file, so the files it consisted of until then are     */
+/* never written again and can be shared by all the clones.          */
+/*                                                                   */
+/* 'clone resume dir n' maps the image copy-on-write over main       */
+/* storage, so resuming copies nothing and the clones share every    */
+/* page until they write it.  The devices are reattached by the      */
+/* suspend file with the adjustments made by sr_clone_args.          */
+/*-------------------------------------------------------------------*/
+
+#define CLONE_STORAGE       "storage.img"
+#define CLONE_STATE         "state.srf"
+#define CLONE_MAXNUM        255         /* (MAC address adjustment)  */
+
+/*-------------------------------------------------------------------*/
+/* Write the state of the machine except main storage                */
+/*-------------------------------------------------------------------*/
+static int clone_write_state( SR_FILE file, CPU_BITMAP started_mask )
+{
+    if (0
+        || sr_write_header( file ) < 0
+        || sr_write_system( file, started_mask, 0 ) < 0
+        || sr_write_cpus( file ) < 0
+        || sr_write_devices( file, 1 ) < 0
+    )
+        return -1;
+
+    SR_WRITE_HDR(file, SR_EOF, 0);
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Freeze the files of every compressed disk by adding a shadow file */
+/*-------------------------------------------------------------------*/
+static int clone_freeze_disks( const char* dir )
+{
+DEVBLK  *dev;
+char     sfn[MAX_PATH];
+char     msgbuf[64];
+int      level;
+
+    for (dev = sysblk.firstdev; dev; dev = dev->nextdev)
+    {
+        if (!dev->cckd_ext || !(dev->pmcw.flag5 & PMCW5_V)) continue;
+
+        /* A disk without shadow files gets them in the directory */
+        if (!dev->dasdsfn)
+        {
+            MSGBUF( sfn, "%s/%1d_%04X_0.shd", dir, LCSS_DEVNUM );
+            cckd_sf_parse_sfn( dev, sfn );
+        }
+
+        level = SR_CCKD_SFN( dev );
+        if (dev->cckd64)
+            cckd64_sf_add( dev );
+        else
+            cckd_sf_add( dev );
+
+        if (SR_CCKD_SFN( dev ) != level + 1)
+        {
+            MSGBUF( msgbuf, "unable to add a shadow file to %1d:%04X",
+                LCSS_DEVNUM );
+            // "SR: clone failed: %s"
+            WRMSG( HHC02031, "E", msgbuf );
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Write a snapshot of the running machine to directory 'dir'        */
+/*-------------------------------------------------------------------*/
+static int clone_snapshot( const char* dir )
+{
+CPU_BITMAP started_mask;
+SR_FILE  file;
+struct timeval beg, end;
+char     fn[MAX_PATH];
+char     msgbuf[MAX_PATH+64];
+BYTE    *p;
+U64      n;
+ssize_t  len;
+int      fd, rc;
+
+    if (mkdir( dir, S_IRWXU | S_IRGRP | S_IXGRP ) < 0 && errno != EEXIST)
+    {
+        MSGBUF( msgbuf, "mkdir( %s ): %s", dir, strerror( errno ));
+        // "SR: clone failed: %s"
+        WRMSG( HHC02031, "E", msgbuf );
+        return -1;
+    }
+
+    MSGBUF( fn, "%s/%s", dir, CLONE_STORAGE );
+    if ((fd = HOPEN( fn, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY,
+                         S_IRUSR | S_IWUSR | S_IRGRP )) < 0)
+    {
+        // "SR: error in function %s: %s"
+        WRMSG( HHC02001, "E", fn, strerror( errno ));
+        return -1;
+    }
+
+    MSGBUF( fn, "%s/%s", dir, CLONE_STATE );
+    if (!(file = SR_OPEN( fn, "wb" )))
+    {
+        // "SR: error in function %s: %s"
+        WRMSG( HHC02001, "E", fn, strerror( errno ));
+        close( fd );
+        return -1;
+    }
+
+    /* The guest is stopped from here until the snapshot is written */
+    gettimeofday( &beg, NULL );
+    sr_quiesce( &started_mask );
+
+    rc = clone_freeze_disks( dir );
+
+    for (p = sysblk.mainstor, n = sysblk.mainsize; rc == 0 && n; p += len, n -= len)
+    {
+        if ((len = write( fd, p, (size_t) MIN( n, SR_BUF_CHUNKSIZE ))) <= 0)
+        {
+            MSGBUF( msgbuf, "write( %s/%s ): %s", dir, CLONE_STORAGE,
+                len < 0 ? strerror( errno ) : "short write" );
+            // "SR: clone failed: %s"
+            WRMSG( HHC02031, "E", msgbuf );
+            rc = -1;
+            break;
+        }
+    }
+
+    if (rc == 0 && clone_write_state( file, started_mask ) < 0)
+    {
+        // "SR: error processing file %s"
+        WRMSG( HHC02004, "E", fn );
+        rc = -1;
+    }
+
+    SR_CLOSE( file );
+    if (close( fd ) < 0 && rc == 0)
+    {
+        MSGBUF( msgbuf, "close( %s/%s ): %s", dir, CLONE_STORAGE,
+            strerror( errno ));
+        // "SR: clone failed: %s"
+        WRMSG( HHC02031, "E", msgbuf );
+        rc = -1;
+    }
+
+    sr_start_cpus( started_mask );
+    gettimeofday( &end, NULL );
+
+    if (rc == 0)
+    {
+        // "SR: clone snapshot written to %s; guest stopped for %"PRIu64" ms"
+        WRMSG( HHC02029, "I", dir,
+            (U64) ((end.tv_sec  - beg.tv_sec)  * 1000
+                 + (end.tv_usec - beg.tv_usec) / 1000) );
+    }
+    return rc;
+}
+
+/*-------------------------------------------------------------------*/
+/* Resume the snapshot in directory 'dir' as clone number 'num'      */
+/*-------------------------------------------------------------------*/
+static int clone_resume( const char* dir, int num )
+{
+struct CLONECTL clone;
+CPU_BITMAP started_mask = 0;
+struct stat st;
+SR_FILE  file;
+char     fn[MAX_PATH];
+char     msgbuf[MAX_PATH+64];
+int      fd, rc;
+
+    /* Make sure no CPU is started (one that is stopping is fine) */
+    if (are_any_cpus_started())
+    {
+        // "SR: all processors must be stopped to resume"
+        WRMSG( HHC02005, "E" );
+        return -1;
+    }
+
+    MSGBUF( fn, "%s/%s", dir, CLONE_STORAGE );
+    if ((fd = HOPEN( fn, O_RDONLY | O_BINARY )) < 0)
+    {
+        // "SR: error in function %s: %s"
+        WRMSG( HHC02001, "E", fn, strerror( errno ));
+        return -1;
+    }
+
+    if (fstat( fd, &st ) < 0 || (U64) st.st_size > sysblk.mainsize)
+    {
+        char buf1[20];
+        char buf2[20];
+        MSGBUF( buf1, "%dM", (U32)(st.st_size / (1024*1024)) );
+        MSGBUF( buf2, "%dM", (U32)(sysblk.mainsize / (1024*1024)) );
+        // "SR: mismatch in '%s': '%s' found, '%s' expected"
+        WRMSG( HHC02009, "E", "mainsize", buf1, buf2 );
+        close( fd );
+        return -1;
+    }
+
+    /* Main storage becomes a private mapping of the image */
+    rc = configure_storage_image( fd, (U64) st.st_size );
+    if (rc)
+    {
+        MSGBUF( msgbuf, "unable to map %s: %s", fn,
+            rc == HERRCPUONL ? "processors started" : strerror( errno ));
+        // "SR: clone failed: %s"
+        WRMSG( HHC02031, "E", msgbuf );
+        close( fd );
+        return -1;
+    }
+    close( fd );
+
+    MSGBUF( fn, "%s/%s", dir, CLONE_STATE );
+    if (!(file = SR_OPEN( fn, "rb" )))
+    {
+        // "SR: error in function %s: %s"
+        WRMSG( HHC02001, "E", fn, strerror( errno ));
+        return -1;
+    }
+
+    clone.dir = dir;
+    clone.num = num;
+    rc = sr_resume_file( file, fn, &started_mask, &clone );
+    SR_CLOSE( file );
+    if (rc < 0)
+        return -1;
+
+    /* The clone's own processor serial number */
+    setAllCpuIds_lock( -1, -1, (S32)((sysblk.cpuserial + num) & 0xFFFFFF),
+                       -1, true );
+
+    sr_start_cpus( started_mask );
+
+    // "SR: resumed as clone %d of %s"
+    WRMSG( HHC02030, "I", num, dir );
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* clone command                                                     */
+/*-------------------------------------------------------------------*/
+int clone_cmd(int argc, char *argv[],char *cmdline)
+{
+int      num;
+char     c;
+
+    UNREFERENCED(cmdline);
+
+    if (argc == 4 && CMD( argv[1], RESUME, 3 ))
+    {
+        if (sscanf( argv[3], "%d%c", &num, &c ) != 1
+            || num < 1 || num > CLONE_MAXNUM)
+        {
+            // "Invalid argument %s%s"
+            WRMSG( HHC02205, "E", argv[3], "; clone number must be 1 to 255" );
+            return -1;
+        }
+        return clone_resume( argv[2], num );
+    }
+
+    if (argc == 2)
+        return clone_snapshot( argv[1] );
+
+    // "Invalid command usage. Type 'help %s' for assistance."
+    WRMSG( HHC02299, "E", argv[0] );
+    return -1;
+}
+#endif /* !defined( _MSVC_ ) */
+
 #if defined( _MSVC_ ) && defined( NO_SR_OPTIMIZE )
   #pragma optimize( "", on )            // restore previous settings
 #endif
@@ -41,6 +41,22 @@
  * Currently the vector facility state is not saved.
  * Also, the ecpsvm state is not currently saved.
  *
+ * Live migration
+ *
+ * The migrate command sends the same text units over a TCP
+ * connection instead of a file.  Main storage is sent while the
+ * guest keeps running as SR_SYS_MIGPAGE units, first every page
+ * and then only those pages that changed since they were sent.
+ * The remaining units follow once the CPUs have been stopped.
+ *
+ * Clones
+ *
+ * The clone command writes main storage to a separate image file
+ * which every clone maps copy-on-write, and the remaining state
+ * as text units.  The frozen cckd shadow files of each disk are
+ * listed in SR_DEV_SFCOUNT and SR_DEV_SFNAME units so that each
+ * clone can stack a shadow file of its own on top of them.
+ *
  * File Structure
  *
  * The suspend/resume file (.srf) contains some number of `text
@@ -193,6 +209,12 @@
 #define SR_SYS_CPUIDFMT         0xace10053
 #define SR_SYS_OPERATION_MODE   0xace10054
 
+ /*
+  * Live migration: one 4K main storage page, preceded
+  * by its 8 byte absolute address
+  */
+#define SR_SYS_MIGPAGE          0xace10060
+
 #define SR_SYS_SERVC            0xace11000
 
 #define SR_SYS_CLOCK            0xace12000
@@ -420,6 +442,12 @@
 #define SR_DEV_IDAWFMT          0xace3002a
 #define SR_DEV_CCWFMT           0xace3002b
 #define SR_DEV_CCWKEY           0xace3002c
+ /*
+  * Clone snapshots: the frozen cckd shadow files of
+  * the device (these must precede SR_DEV_TYPNAME)
+  */
+#define SR_DEV_SFCOUNT          0xace3002d
+#define SR_DEV_SFNAME           0xace3002e
 
 #define SR_DEV_MASK             0xfffff000
 #define SR_DEV_CKD              0xace31000
@@ -460,6 +488,9 @@
 #define SR_FILE gzFile
 #define SR_OPEN(_path, _mode) \
  gzopen((_path), (_mode))
+#define SR_DOPEN(_fd, _mode) \
+ gzdopen((_fd), (_mode))
+#define SR_MIG_WMODE "wb1"
 #define SR_READ(_ptr, _size, _nmemb, _stream) \
  gzread((gzFile)(_stream), (_ptr), (unsigned int)((_size) * (_nmemb)))
 #define SR_WRITE(_ptr, _size, _nmemb, _stream) \
@@ -473,6 +504,9 @@
 #define SR_FILE FILE *
 #define SR_OPEN(_path, _mode) \
  fopen((_path), (_mode))
+#define SR_DOPEN(_fd, _mode) \
+ fdopen((_fd), (_mode))
+#define SR_MIG_WMODE "wb"
 #define SR_READ(_ptr, _size, _nmemb, _stream) \
  fread((_ptr), (_size), (_nmemb), (_stream))
 #define SR_WRITE(_ptr, _size, _nmemb, _stream) \
@@ -0,0 +1,342 @@
+/* STORSHM.C    (C) Copyright The Hercules Project, 2026               */
+/*              Shared read-only view of main storage                */
+/*                                                                   */
+/*   Released under "The Q Public License Version 1"                 */
+/*   (http://www.hercules-390.org/herclic.html) as modifications to  */
+/*   Hercules.                                                       */
+
+/*-------------------------------------------------------------------*/
+/* This module lets tools outside of Hercules map the main storage   */
+/* of a running Hercules read-only (see storshm.h), read absolute    */
+/* storage and storage keys, and translate guest virtual addresses   */
+/* with a given address-space-control element (z/Architecture) or    */
+/* segment table designation (ESA/390).  It only depends on the C    */
+/* library so that it can be built into any tool.                    */
+/*-------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "storshm.h"
+
+/*-------------------------------------------------------------------*/
+/* Map a shared memory object read-only                              */
+/*-------------------------------------------------------------------*/
+int storshm_open( STORSHM* shm, const char* name )
+{
+    char         path[ 4096 ];
+    struct stat  st;
+    void*        p;
+    int          fd;
+    const STORSHM_HDR*  hdr;
+
+    memset( shm, 0, sizeof( *shm ));
+
+    if (storshm_path( path, sizeof( path ), name ) != 0)
+        return -1;
+
+    if ((fd = open( path, O_RDONLY )) < 0)
+        return -1;
+
+    if (fstat( fd, &st ) != 0)
+    {
+        close( fd );
+        return -1;
+    }
+
+    if ((size_t) st.st_size < sizeof( STORSHM_HDR ))
+    {
+        close( fd );
+        errno = EINVAL;
+        return -1;
+    }
+
+    p = mmap( NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+
+    if (p == MAP_FAILED)
+        return -1;
+
+    hdr = (const STORSHM_HDR*) p;
+
+    if (memcmp( hdr->eyecatcher, STORSHM_EYECATCHER, sizeof( hdr->eyecatcher )) != 0
+        || hdr->version    != STORSHM_VERSION
+        || hdr->keyunit    == 0
+        || hdr->mainoffset + hdr->mainsize > (uint64_t) st.st_size
+        || hdr->keyoffset  + hdr->mainsize / hdr->keyunit > hdr->mainoffset
+        || hdr->numcpu     >  STORSHM_MAXCPU)
+    {
+        munmap( p, (size_t) st.st_size );
+        errno = EINVAL;
+        return -1;
+    }
+
+    shm->hdr        = hdr;
+    shm->keys       = (const uint8_t*) p + hdr->keyoffset;
+    shm->mainstor   = (const uint8_t*) p + hdr->mainoffset;
+    shm->size       = (size_t) st.st_size;
+    shm->generation = hdr->generation;
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Unmap a shared memory object                                      */
+/*-------------------------------------------------------------------*/
+void storshm_close( STORSHM* shm )
+{
+    if (shm->hdr)
+        munmap( (void*) shm->hdr, shm->size );
+
+    memset( shm, 0, sizeof( *shm ));
+}
+
+/*-------------------------------------------------------------------*/
+/* Test whether storage was reset or reconfigured since it was       */
+/* opened (or is being changed right now).  Returns 2 if the object  */
+/* was retired and must be opened again, 1 if storage was reset.     */
+/*-------------------------------------------------------------------*/
+int storshm_changed( const STORSHM* shm )
+{
+    if (shm->hdr->retired)
+        return 2;
+
+    return shm->hdr->generation != shm->generation ? 1 : 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Copy absolute storage                                             */
+/*-------------------------------------------------------------------*/
+int storshm_read( const STORSHM* shm, uint64_t abs, void* buf, size_t len )
+{
+    if (abs > shm->hdr->mainsize || len > shm->hdr->mainsize - abs)
+        return STORSHM_ADDRESSING;
+
+    memcpy( buf, shm->mainstor + abs, len );
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return the storage key of an absolute address (or -1)             */
+/*-------------------------------------------------------------------*/
+int storshm_key( const STORSHM* shm, uint64_t abs )
+{
+    if (abs >= shm->hdr->mainsize)
+        return -1;
+
+    return shm->keys[ abs / shm->hdr->keyunit ];
+}
+
+/*-------------------------------------------------------------------*/
+/* Convert a real address into an absolute address                  */
+/*-------------------------------------------------------------------*/
+int storshm_absolute( const STORSHM* shm, int cpu, uint64_t real, uint64_t* abs )
+{
+    uint64_t  px, mask;
+
+    if (cpu < 0 || (uint32_t) cpu >= shm->hdr->numcpu)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    px   = shm->hdr->prefix[ cpu ];
+    mask = shm->hdr->archmode == 2 ? ~(uint64_t) 0x1FFF
+         : shm->hdr->archmode == 1 ? (uint64_t) 0x7FFFF000
+         :                           (uint64_t) 0x00FFF000;
+
+    /* Swap the prefix area with the first frames of storage */
+    if ((real & mask) == 0)
+        real |= px;
+    else if ((real & mask) == px)
+        real &= ~mask;
+
+    *abs = real;
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Fetch a big-endian table entry from real storage                  */
+/*-------------------------------------------------------------------*/
+static int fetch_entry( const STORSHM* shm, int cpu, uint64_t real,
+                        int len, uint64_t* entry )
+{
+    uint64_t  abs;
+    uint8_t   b[8];
+    int       i;
+
+    if (storshm_absolute( shm, cpu, real, &abs ) != 0
+        || storshm_read( shm, abs, b, (size_t) len ) != 0)
+        return STORSHM_ADDRESSING;
+
+    for (*entry = 0, i = 0; i < len; i++)
+        *entry = (*entry << 8) | b[i];
+
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* z/Architecture dynamic address translation                        */
+/*-------------------------------------------------------------------*/
+static int translate_z( const STORSHM* shm, int cpu, uint64_t asce,
+                        uint64_t vaddr, uint64_t* real )
+{
+    static const int  excp[4] = { STORSHM_SEGMENT_TRANS,
+                                  STORSHM_REGION_THIRD,
+                                  STORSHM_REGION_SECOND,
+                                  STORSHM_REGION_FIRST };
+    uint64_t  origin = asce & 0xFFFFFFFFFFFFF000ULL;
+    uint64_t  entry;
+    int       level  = (int)((asce & 0x0C) >> 2);
+    int       tf     = 0;
+    int       tl     = (int)(asce & 0x03);
+    int       index, rc;
+
+    /* Real space designation: virtual equals real */
+    if (asce & 0x20)
+    {
+        *real = vaddr;
+        return 0;
+    }
+
+    /* The address must be within the range of the first table */
+    if (level < 3 && (vaddr >> (31 + 11 * level)) != 0)
+        return STORSHM_ASCE_TYPE;
+
+    /* Region tables (level 3 to 1) and the segment table (level 0) */
+    for (; level >= 0; level--)
+    {
+        index = (int)((vaddr >> (20 + 11 * level)) & 0x7FF);
+
+        if ((index >> 9) < tf || (index >> 9) > tl)
+            return excp[ level ];
+
+        if ((rc = fetch_entry( shm, cpu, origin + index * 8, 8, &entry )) != 0)
+            return rc;
+
+        if (entry & 0x20)
+            return excp[ level ];
+
+        if ((int)((entry & 0x0C) >> 2) != level)
+            return STORSHM_TRANS_SPEC;
+
+        /* Large frames: 2G region-third entries, 1M segment entries */
+        if (entry & 0x400)
+        {
+            if (level == 1)
+            {
+                *real = (entry & 0xFFFFFFFF80000000ULL) | (vaddr & 0x7FFFFFFF);
+                return 0;
+            }
+            if (level == 0)
+            {
+                *real = (entry & 0xFFFFFFFFFFF00000ULL) | (vaddr & 0xFFFFF);
+                return 0;
+            }
+        }
+
+        origin = entry & (level ? 0xFFFFFFFFFFFFF000ULL : 0xFFFFFFFFFFFFF800ULL);
+        tf     = (int)((entry & 0xC0) >> 6);
+        tl     = (int)( entry & 0x03);
+    }
+
+    /* Page table */
+    index = (int)((vaddr >> 12) & 0xFF);
+
+    if ((rc = fetch_entry( shm, cpu, origin + index * 8, 8, &entry )) != 0)
+        return rc;
+
+    if (entry & 0x400)
+        return STORSHM_PAGE_TRANS;
+
+    if (entry & 0x800)
+        return STORSHM_TRANS_SPEC;
+
+    *real = (entry & 0xFFFFFFFFFFFFF000ULL) | (vaddr & 0xFFF);
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* ESA/390 dynamic address translation                               */
+/*-------------------------------------------------------------------*/
+static int translate_esa( const STORSHM* shm, int cpu, uint64_t std,
+                          uint64_t vaddr, uint64_t* real )
+{
+    uint64_t  entry;
+    int       sx = (int)((vaddr >> 20) & 0x7FF);
+    int       px = (int)((vaddr >> 12) & 0xFF);
+    int       rc;
+
+    if ((sx >> 4) > (int)(std & 0x7F))
+        return STORSHM_SEGMENT_TRANS;
+
+    if ((rc = fetch_entry( shm, cpu, (std & 0x7FFFF000) + sx * 4, 4, &entry )) != 0)
+        return rc;
+
+    if (entry & 0x20)
+        return STORSHM_SEGMENT_TRANS;
+
+    if ((px >> 4) > (int)(entry & 0x0F))
+        return STORSHM_PAGE_TRANS;
+
+    if ((rc = fetch_entry( shm, cpu, (entry & 0x7FFFFFC0) + px * 4, 4, &entry )) != 0)
+        return rc;
+
+    if (entry & 0x400)
+        return STORSHM_PAGE_TRANS;
+
+    if (entry & 0x900)
+        return STORSHM_TRANS_SPEC;
+
+    *real = (entry & 0x7FFFF000) | (vaddr & 0xFFF);
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* storshm_translate - translate a guest virtual address             */
+/*-------------------------------------------------------------------*/
+/* 'asce' is a z/Architecture address-space-control element or, in  */
+/* ESA/390 mode, a segment table designation, as found in a control  */
+/* register of the guest.  The tables are read from the storage as   */
+/* seen by CPU 'cpu'.  Returns 0 with the absolute address, -1 for   */
+/* an invalid CPU or else the program interruption code of the       */
+/* exception that the translation would cause.  S/370 translation   */
+/* is not supported.                                                 */
+/*-------------------------------------------------------------------*/
+int storshm_translate( const STORSHM* shm, int cpu, uint64_t asce,
+                       uint64_t vaddr, uint64_t* abs )
+{
+    uint64_t  real;
+    int       rc;
+
+    if (cpu < 0 || (uint32_t) cpu >= shm->hdr->numcpu)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    switch (shm->hdr->archmode)
+    {
+    case 2:
+        rc = translate_z( shm, cpu, asce, vaddr, &real );
+        break;
+
+    case 1:
+        rc = translate_esa( shm, cpu, asce, vaddr & 0x7FFFFFFF, &real );
+        break;
+
+    default:
+        return STORSHM_TRANS_SPEC;
+    }
+
+    if (rc != 0)
+        return rc;
+
+    storshm_absolute( shm, cpu, real, abs );
+
+    return *abs < shm->hdr->mainsize ? 0 : STORSHM_ADDRESSING;
+}
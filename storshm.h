@@ -0,0 +1,125 @@
+/* STORSHM.H    (C) Copyright The Hercules Project, 2026               */
+/*              Shared read-only view of main storage                */
+/*                                                                   */
+/*   Released under "The Q Public License Version 1"                 */
+/*   (http://www.hercules-390.org/herclic.html) as modifications to  */
+/*   Hercules.                                                       */
+
+/*
+ * When the 'storshm' statement names a shared memory object, Hercules
+ * allocates its storage key array and main storage in that object so
+ * that local tools can map it read-only and observe guest storage
+ * while the guest runs, without going through the command handler.
+ *
+ * The object is the file /dev/shm/<name> (or the named path if the
+ * name contains a '/') and is only accessible to the user running
+ * Hercules.  It starts with the header below, followed by the storage
+ * key array and main storage at the offsets given in the header.
+ *
+ * The generation count changes whenever the meaning of the storage
+ * changes: at every system reset and when the object is retired
+ * because main storage was reconfigured, after which the object must
+ * be opened again.  It is odd while the header is being changed.
+ *
+ * This file only uses standard C types so that it can be used by
+ * tools built outside of Hercules, together with storshm.c, which
+ * maps the object and translates guest virtual addresses.
+ */
+
+#ifndef _STORSHM_H_
+#define _STORSHM_H_
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define STORSHM_EYECATCHER  "HERCSTOR"      /* Header eyecatcher     */
+#define STORSHM_VERSION     1               /* Header version        */
+#define STORSHM_HDRSIZE     8192            /* Header area size      */
+#define STORSHM_MAXCPU      256             /* CPU array entries     */
+#define STORSHM_DIR         "/dev/shm/"     /* Directory of names    */
+
+/*-------------------------------------------------------------------*/
+/* Header at the start of the shared memory object                   */
+/*-------------------------------------------------------------------*/
+typedef struct STORSHM_HDR
+{
+    char      eyecatcher[8];            /* STORSHM_EYECATCHER        */
+    uint32_t  version;                  /* STORSHM_VERSION           */
+    uint32_t  hdrsize;                  /* STORSHM_HDRSIZE           */
+    volatile uint64_t  generation;      /* Changes on reset/retire   */
+    volatile uint32_t  retired;         /* 1=Storage reconfigured    */
+    volatile uint32_t  archmode;        /* 0=S/370 1=ESA/390 2=z/Arch*/
+    uint64_t  mainsize;                 /* Main storage size (bytes) */
+    uint64_t  mainoffset;               /* Offset of main storage    */
+    uint64_t  keyoffset;                /* Offset of storage keys    */
+    uint32_t  keyunit;                  /* Bytes of storage per key  */
+    uint32_t  numcpu;                   /* Entries used in the arrays*/
+    volatile uint64_t  prefix[ STORSHM_MAXCPU ];  /* Prefix registers*/
+    volatile uint8_t   online[ STORSHM_MAXCPU ];  /* 1=CPU online    */
+}
+STORSHM_HDR;
+
+/*-------------------------------------------------------------------*/
+/* Translation exceptions (the program interruption codes)           */
+/*-------------------------------------------------------------------*/
+#define STORSHM_ADDRESSING      0x05    /* Address beyond storage    */
+#define STORSHM_SEGMENT_TRANS   0x10    /* Segment entry invalid     */
+#define STORSHM_PAGE_TRANS      0x11    /* Page entry invalid        */
+#define STORSHM_TRANS_SPEC      0x12    /* Table entry format error  */
+#define STORSHM_ASCE_TYPE       0x38    /* Address beyond table type */
+#define STORSHM_REGION_FIRST    0x39    /* Region first entry invalid*/
+#define STORSHM_REGION_SECOND   0x3A    /* Region 2nd entry invalid  */
+#define STORSHM_REGION_THIRD    0x3B    /* Region 3rd entry invalid  */
+
+/*-------------------------------------------------------------------*/
+/* A mapped shared memory object                                     */
+/*-------------------------------------------------------------------*/
+typedef struct STORSHM
+{
+    const STORSHM_HDR*  hdr;            /* -> Header                 */
+    const uint8_t*      keys;           /* -> Storage key array      */
+    const uint8_t*      mainstor;       /* -> Main storage           */
+    size_t              size;           /* Size of the mapping       */
+    uint64_t            generation;     /* Generation when opened    */
+}
+STORSHM;
+
+/*-------------------------------------------------------------------*/
+/* Build the path of the shared memory object with the given name    */
+/*-------------------------------------------------------------------*/
+static inline int storshm_path( char* path, size_t size, const char* name )
+{
+    int  n;
+
+    if (strchr( name, '/' ))
+        n = snprintf( path, size, "%s", name );
+    else
+        n = snprintf( path, size, "%s%s", STORSHM_DIR, name );
+
+    if (n < 0 || (size_t) n >= size)
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Functions in storshm.c                                            */
+/*-------------------------------------------------------------------*/
+extern int  storshm_open     ( STORSHM* shm, const char* name );
+extern void storshm_close    ( STORSHM* shm );
+extern int  storshm_changed  ( const STORSHM* shm );
+extern int  storshm_read     ( const STORSHM* shm, uint64_t abs,
+                               void* buf, size_t len );
+extern int  storshm_key      ( const STORSHM* shm, uint64_t abs );
+extern int  storshm_absolute ( const STORSHM* shm, int cpu,
+                               uint64_t real, uint64_t* abs );
+extern int  storshm_translate( const STORSHM* shm, int cpu,
+                               uint64_t asce, uint64_t vaddr,
+                               uint64_t* abs );
+
+#endif /* _STORSHM_H_ */
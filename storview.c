@@ -0,0 +1,179 @@
+/* STORVIEW.C   (C) Copyright The Hercules Project, 2026               */
+/*              Example tool viewing shared main storage             */
+/*                                                                   */
+/*   Released under "The Q Public License Version 1"                 */
+/*   (http://www.hercules-390.org/herclic.html) as modifications to  */
+/*   Hercules.                                                       */
+
+/*-------------------------------------------------------------------*/
+/* storview maps the main storage of a running Hercules that was     */
+/* started with the 'storshm' statement and displays the header or   */
+/* copies absolute or virtual storage to a file.  It only uses the   */
+/* functions in storshm.c and serves as an example for other tools.  */
+/*                                                                   */
+/*   storview name                      display the header           */
+/*   storview name key  addr            display a storage key        */
+/*   storview name dump addr len file [asce [cpu]]                   */
+/*                                      copy storage to a file       */
+/*                                                                   */
+/* Addresses, lengths and ASCEs are hexadecimal.  With an ASCE (or   */
+/* ESA/390 STD) the address is virtual and translated page by page.  */
+/*-------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "storshm.h"
+
+#define UTILITY_NAME    "storview"
+
+/*-------------------------------------------------------------------*/
+/* Parse a hexadecimal argument                                      */
+/*-------------------------------------------------------------------*/
+static int hexarg( const char* arg, uint64_t* value )
+{
+    char  c;
+
+    return sscanf( arg, "%"SCNx64"%c", value, &c ) == 1 ? 0 : -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Display the header                                                */
+/*-------------------------------------------------------------------*/
+static void display( const STORSHM* shm )
+{
+    uint32_t  i;
+
+    printf( "mainsize   %"PRIX64"\n", shm->hdr->mainsize );
+    printf( "generation %"PRIu64"%s\n", shm->hdr->generation,
+            shm->hdr->retired ? " (retired)" : "" );
+    printf( "archmode   %s\n", shm->hdr->archmode == 2 ? "z/Arch"
+                             : shm->hdr->archmode == 1 ? "ESA/390" : "S/370" );
+
+    for (i = 0; i < shm->hdr->numcpu; i++)
+        if (shm->hdr->online[i])
+            printf( "CPU%02"PRIX32"      prefix %"PRIX64"\n", i, shm->hdr->prefix[i] );
+}
+
+/*-------------------------------------------------------------------*/
+/* Copy storage to a file                                            */
+/*-------------------------------------------------------------------*/
+static int dump( const STORSHM* shm, uint64_t addr, uint64_t len,
+                 const char* fname, int virt, uint64_t asce, int cpu )
+{
+    uint8_t   page[ 4096 ];
+    uint64_t  abs;
+    size_t    n;
+    FILE*     fp;
+    int       rc = 0;
+
+    if (!(fp = fopen( fname, "wb" )))
+    {
+        fprintf( stderr, UTILITY_NAME ": %s: %s\n", fname, strerror( errno ));
+        return -1;
+    }
+
+    /* One page at a time since pages need not be contiguous */
+    for (; len && rc == 0; addr += n, len -= n)
+    {
+        n = (size_t)(4096 - (addr & 0xFFF));
+        if (n > len)
+            n = (size_t) len;
+
+        abs = addr;
+        if (virt && (rc = storshm_translate( shm, cpu, asce, addr, &abs )) != 0)
+        {
+            if (rc < 0)
+                fprintf( stderr, UTILITY_NAME ": CPU %X: %s\n", cpu, strerror( errno ));
+            else
+                fprintf( stderr, UTILITY_NAME ": address %"PRIX64": "
+                         "translation exception %04X\n", addr, rc );
+            break;
+        }
+
+        if ((rc = storshm_read( shm, abs, page, n )) != 0)
+        {
+            fprintf( stderr, UTILITY_NAME ": address %"PRIX64": "
+                     "addressing exception\n", abs );
+            break;
+        }
+
+        if (fwrite( page, 1, n, fp ) != n)
+        {
+            fprintf( stderr, UTILITY_NAME ": %s: %s\n", fname, strerror( errno ));
+            rc = -1;
+        }
+    }
+
+    if (fclose( fp ) != 0 && rc == 0)
+    {
+        fprintf( stderr, UTILITY_NAME ": %s: %s\n", fname, strerror( errno ));
+        rc = -1;
+    }
+
+    /* The copy is only valid if storage was not reset meanwhile */
+    if (rc == 0 && storshm_changed( shm ))
+    {
+        fprintf( stderr, UTILITY_NAME ": storage was reset during the copy\n" );
+        rc = -1;
+    }
+
+    return rc;
+}
+
+int main( int argc, char* argv[] )
+{
+    STORSHM   shm;
+    uint64_t  addr, len, asce = 0, cpu = 0;
+    int       rc = 0;
+
+    if (argc < 2
+        || (argc > 2 && strcmp( argv[2], "key"  ) == 0 && argc != 4)
+        || (argc > 2 && strcmp( argv[2], "dump" ) == 0 && (argc < 6 || argc > 8))
+        || (argc > 2 && strcmp( argv[2], "key"  ) != 0 && strcmp( argv[2], "dump" ) != 0))
+    {
+        fprintf( stderr, "Usage: " UTILITY_NAME " name\n"
+                         "       " UTILITY_NAME " name key addr\n"
+                         "       " UTILITY_NAME " name dump addr len file [asce [cpu]]\n" );
+        return 1;
+    }
+
+    if (storshm_open( &shm, argv[1] ) != 0)
+    {
+        fprintf( stderr, UTILITY_NAME ": %s: %s\n", argv[1], strerror( errno ));
+        return 1;
+    }
+
+    if (argc == 2)
+        display( &shm );
+
+    else if (hexarg( argv[3], &addr ) != 0
+        || (argc > 4 && hexarg( argv[4], &len  ) != 0)
+        || (argc > 6 && hexarg( argv[6], &asce ) != 0)
+        || (argc > 7 && hexarg( argv[7], &cpu  ) != 0))
+    {
+        fprintf( stderr, UTILITY_NAME ": invalid hexadecimal argument\n" );
+        rc = -1;
+    }
+
+    else if (argv[2][0] == 'k')
+    {
+        if ((rc = storshm_key( &shm, addr )) < 0)
+            fprintf( stderr, UTILITY_NAME ": address %"PRIX64": "
+                     "addressing exception\n", addr );
+        else
+        {
+            printf( "%2.2X\n", rc );
+            rc = 0;
+        }
+    }
+
+    else
+        rc = dump( &shm, addr, len, argv[5], argc > 6, asce, (int) cpu );
+
+    storshm_close( &shm );
+    return rc ? 1 : 0;
+}
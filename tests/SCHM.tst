@@ -0,0 +1,67 @@
+*Testcase SCHM channel subsystem measurement blocks
+
+mainsize    1
+numcpu      1
+sysclear
+archlvl     z/Arch
+
+detach  000E
+attach  000E  1403  "SCHM.txt"  crlf
+
+r 1A0=00000001800000000000000000000200  # Restart New PSW
+r 1D0=0002000180000000000000000000DEAD  # Program Check New PSW
+r 1F0=00000001800000000000000000000280  # I/O Interrupt New PSW
+cr 6=FF000000               # Enable all I/O interruption subclasses
+
+r 200=A7180002              # LHI   R1,2           (M bit)
+r 204=A7281000              # LHI   R2,X'1000'     (MBO)
+r 208=B23C0000              # SCHM
+r 20C=58100580              # L     R1,=A(SID)
+r 210=B2340600              # STSCH SCHIB
+r 214=96900605              # OI    PMCW5,E+MBU
+r 218=B2320600              # MSCH  SCHIB
+r 21C=A7380800              # LHI   R3,IRB1
+r 220=A7480230              # LHI   R4,NEXT
+r 224=B2330700              # SSCH  ORB
+r 228=B2B20310              # LPSWE WAIT
+r 22C=07000700              # (padding)
+r 230=9606061B              # NEXT  OI PMCW27,F+X
+r 234=D20706280588          # MVC   SCHIB+40(8),=AD(MBA)
+r 23A=B2320600              # MSCH  SCHIB
+r 23E=A7380900              # LHI   R3,IRB2
+r 242=A7480252              # LHI   R4,DONE
+r 246=B2330700              # SSCH  ORB
+r 24A=B2B20310              # LPSWE WAIT
+r 24E=07000700              # (padding)
+r 252=B2B20300              # DONE  LPSWE EOJ
+
+r 280=B235300007F4          # TSCH  0(R3); BR R4   (I/O interrupt)
+
+r 300=00020001800000000000000000000000  # Test finished
+r 310=02020001800000000000000000000000  # Wait for I/O interrupt
+r 580=00010001              # Subchannel id of 000E
+r 588=0000000000001100      # Format-1 measurement block address
+
+r 700=123456780080FF0000000720          # ORB: format-1 CCWs
+r 720=0920000100000730      # Write, space 1, SLI
+r 730=C1
+
+r 840=FFFFFFFF              # Must not be stored without X bit
+
+runtest   0.5
+
+*Compare
+r 800.4
+*Want "IRB1 SCSW" 00804007
+r 840.4
+*Want "IRB1 no EMW" FFFFFFFF
+r 1000.4
+*Want "Format-0 SSCH/sample counts" 00010001
+r 1100.8
+*Want "Format-1 SSCH/sample counts" 0000000100000001
+r 95C.4
+*Want "EMW reserved word" 00000000
+
+detach    000E
+
+*Done
@@ -0,0 +1,54 @@
+*Testcase clone snapshot a running guest and resume it as two clones
+
+# The clones are resumed one after the other in this instance.  Each
+# must start from the snapshot: it sees neither what this instance
+# wrote after the snapshot nor what the previous clone wrote.  The
+# guest counts clock comparator interrupts so that it mostly waits.
+
+shcmdopt    enable
+sh rm -rf clonetst
+
+sysclear
+archlvl     z/Arch
+
+r 1A0=00000001800000000000000000000200  # Restart New PSW
+r 1B0=00000001800000000000000000000280  # External New PSW
+r 1D0=0002000180000000000000000000DEAD  # Program Check New PSW
+cr 0=800                    # Enable clock comparator interrupts
+
+r 200=B2050510              # ARM   STCK  NOW
+r 204=E31005100004          # LG    R1,NOW
+r 20A=C21A02710000          # ALGFI R1,10ms
+r 210=E31005180024          # STG   R1,CLKC
+r 216=B2060518              # SCKC  CLKC
+r 21A=B2B20310              # LPSWE WAIT
+
+r 280=58200500              # L     R2,COUNT        (external interrupt)
+r 284=A72A0001              # AHI   R2,1
+r 288=50200500              # ST    R2,COUNT
+r 28C=A7F4FFBA              # J     ARM
+
+r 310=01020001800000000000000000000000  # Wait for external interrupt
+r 520=AA                    # Seen by every clone
+
+restart
+pause       0.5
+clone       clonetst
+r 520=BB                    # Written after the snapshot
+stop
+clone       resume clonetst 1
+pause       0.2
+r 521=01                    # Written by clone 1
+stop
+clone       resume clonetst 2
+pause       0.2
+stop
+
+*Compare
+r 520.2
+*Want "Clone 2 sees only the snapshot" AA00
+
+sh rm -rf clonetst
+shcmdopt    disable
+
+*Done
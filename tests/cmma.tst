@@ -0,0 +1,46 @@
+*Testcase cmma DIAG X'010' and ESSA return frames to the host
+
+# DIAG X'010' releases two pages, which must then contain zeros.  ESSA
+# sets another frame unused and extracts its state; the 'cmma' command
+# returns the pending unused frame to the host, clearing it as well.
+
+sysclear
+archlvl     z/Arch
+cmma        on
+
+r 1A0=00000001800000000000000000000200  # Restart New PSW
+r 1D0=0002000180000000000000000000DEAD  # Program Check New PSW
+
+r 200=C01100010000          # LGFI  R1,X'10000'
+r 206=C02100011000          # LGFI  R2,X'11000'
+r 20C=83120010              # DIAG  R1,R2,X'010'    Release pages
+r 210=C03100020000          # LGFI  R3,X'20000'
+r 216=B9AB2043              # ESSA  R4,R3,2         Set unused
+r 21A=B9AB0053              # ESSA  R5,R3,0         Extract state
+r 21E=E34005000024          # STG   R4,X'500'
+r 224=E35005080024          # STG   R5,X'508'
+r 22A=B2B20300              # LPSWE EOJ
+
+r 300=00020001800000000000000000000000  # Test finished
+
+r 10000=1111111111111111    # Released by DIAG X'010'
+r 11000=2222222222222222
+r 20000=3333333333333333    # Set unused by ESSA
+
+restart
+pause       0.2
+cmma
+
+*Compare
+r 500.10
+*Want "ESSA states: stable, then unused" 00000000 00000000 00000000 00000004
+r 10000.8
+*Want "First released page" 00000000 00000000
+r 11000.8
+*Want "Last released page" 00000000 00000000
+r 20000.8
+*Want "Unused frame" 00000000 00000000
+
+cmma        off
+
+*Done
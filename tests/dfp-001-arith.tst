@@ -0,0 +1,121 @@
+# DFP long and extended arithmetic, compare and fixed-point conversion.
+# Expected results were computed with the decNumber library.
+
+*Testcase dfp-001-arith
+sysclear
+archlvl z
+r 1A0=00000001800000000000000000000200
+r 1C0=00020001800000000000000000000000
+r 1D0=0002000180000000000000000000DEAD
+r 200=B6000F0096040F01B7000F0068000800
+r 210=68100810B3D2104060400B00B2220050
+r 220=50500D006800082068100830B3D31040
+r 230=60400B10B222005050500D0468000840
+r 240=68100850B3D0104060400B2068000860
+r 250=68100870B3D1104060400B3068000880
+r 260=68100890B3F5104060400B40680008A0
+r 270=681008B0B3E40001B222005050500D14
+r 280=680008C0681008D0B3E00001B2220050
+r 290=50500D18E37008E00004B3F100476040
+r 2A0=0B7068000900B3E1B070E3700B800024
+r 2B0=B222005050500D206800092068200928
+r 2C0=6810093068300938B3DA104060400B90
+r 2D0=60600B98B222005050500D2468000940
+r 2E0=682009486810095068300958B3DB1040
+r 2F0=60400BA060600BA8B222005050500D28
+r 300=68000960682009686810097068300978
+r 310=B3D8104060400BB060600BB868000980
+r 320=682009886810099068300998B3D91040
+r 330=60400BC060600BC8680009A0682009A8
+r 340=681009B0683009B8B3FD104060400BD0
+r 350=60600BD8680009C0682009C8681009D0
+r 360=683009D8B3EC0001B222005050500D38
+r 370=680009E0682009E8681009F0683009F8
+r 380=B3E80001B222005050500D3CE3700A00
+r 390=0004B3F9004760400C0060600C086800
+r 3A0=0A2068200A28B3E90070E3700C100024
+r 3B0=B222005050500D440A00
+r 800=263934B9C1E28E56
+r 810=2234000000000007
+r 820=2234000000000015
+r 830=2230000000000175
+r 840=222C000001271778
+r 850=A22C000000000001
+r 860=2238000000000001
+r 870=2238000000000003
+r 880=222400000005C52E
+r 890=222C000000000001
+r 8A0=2234000000000010
+r 8B0=2230000000000080
+r 8C0=A238000000000005
+r 8D0=2238000000000003
+r 8E0=8000000000000000
+r 900=222C00000A395BCF0000000000000000
+r 920=2608134B9C1E28E56F3C127177823534
+r 930=2207C000000000000000000000000005
+r 940=00130000000000000000000000000001
+r 950=00130000000000000000000000000001
+r 960=6E060FF3FCFF3FCFF3FCFF3FCFF3FCFF
+r 970=A2080000000000000000000000000002
+r 980=22080000000000000000000000000002
+r 990=22080000000000000000000000000003
+r 9A0=2DFFCC1AEB53B3FBB4E262D0DAB5E683
+r 9B0=22070000000000000000000000000001
+r 9C0=F8000000000000000000000000000000
+r 9D0=22080000000000000000000000000005
+r 9E0=22080000000000000000000000000007
+r 9F0=22074000000000000000000000001C00
+r A00=7FFFFFFFFFFFFFFF
+r A20=A207C0000000000A395BCF049C5DE28D
+r A30=00000000000000000000000000000000
+runtest .1
+*Compare
+r B00.8
+*Want "adtr" 263934B9 C1E28E57
+r D00.4
+*Want "adtr cc" 20000000
+r B10.8
+*Want "sdtr" A2300000 000000A5
+r D04.4
+*Want "sdtr cc" 10000000
+r B20.8
+*Want "mdtr" A2200000 01271778
+r B30.8
+*Want "ddtr" 2DF9B36C DB36CDB3
+r B40.8
+*Want "qadtr" 222C0000 00000B98
+r D14.4
+*Want "cdtr cc" 00000000
+r D18.4
+*Want "kdtr cc" 10000000
+r B70.8
+*Want "cdgtr" EE45237C 836973F6
+r B80.8
+*Want "cgdtr" 00000000 0001E240
+r D20.4
+*Want "cgdtr cc" 20000000
+r B90.10
+*Want "axtr" 2608134B 9C1E28E5 6F3C1271 77823534
+r D24.4
+*Want "axtr cc" 20000000
+r BA0.10
+*Want "sxtr" 00130000 00000000 00000000 00000000
+r D28.4
+*Want "sxtr cc" 00000000
+r BB0.10
+*Want "mxtr" AA064000 00000000 00000000 00000000
+r BC0.10
+*Want "dxtr" 39FFB66D 9B66D9B6 6D9B66D9 B66D9B67
+r BD0.10
+*Want "qaxtr" 22070000 00000000 00000000 0000C616
+r D38.4
+*Want "cxtr cc" 10000000
+r D3C.4
+*Want "kxtr cc" 00000000
+r C00.10
+*Want "cxgtr" 22080000 00000000 948DF20D A5CFD70D
+r C10.8
+*Want "cgxtr" 80000000 00000000
+r D44.4
+*Want "cgxtr cc" 30000000
+*Done
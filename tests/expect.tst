@@ -0,0 +1,40 @@
+# Script expect, if/else/endif and while/endwhile statements.
+
+*Testcase expect capture
+sysclear
+archlvl z
+r 200=11223344
+expect 5 R:0*200 +([0-9A-F]{8})
+r 300=$(MATCH1)
+if matched
+r 308=AA
+else
+r 308=EE
+endif
+if $(MATCH1) != 11223344
+r 309=EE
+endif
+*Compare
+r 300.4
+*Want "captured" 11223344
+r 308.2
+*Want "if matched" AA00
+*Done nowait
+
+*Testcase expect timeout
+*Timeout
+expect 0.1 ^No such message$
+if not matched
+r 310=01
+endif
+while not matched
+r 311=02
+expect 5 R:0*311 +(02)
+endwhile
+if $(MATCH1) == 02
+r 312=03
+endif
+*Compare
+r 310.3
+*Want "while loop" 010203
+*Done nowait
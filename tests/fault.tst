@@ -0,0 +1,72 @@
+*Testcase fault device fault injection
+
+mainsize    1
+numcpu      1
+sysclear
+archlvl     z/Arch
+
+detach  000E
+attach  000E  1403  "fault.txt"  crlf
+fault   000E  UC=10 CCW=09 NTH=1
+fault   000E  NOINTR CCW=09 NTH=1
+
+r 1A0=00000001800000000000000000000200  # Restart New PSW
+r 1D0=0002000180000000000000000000DEAD  # Program Check New PSW
+r 1F0=000000018000000000000000000002C0  # I/O Interrupt New PSW
+cr 6=FF000000               # Enable all I/O interruption subclasses
+
+r 200=58100580              # L     R1,=A(SID)
+r 204=B2340600              # STSCH SCHIB
+r 208=96800605              # OI    PMCW5,E        (enable subchannel)
+r 20C=B2320600              # MSCH  SCHIB
+r 210=A7380800              # LHI   R3,IRB1
+r 214=A7480230              # LHI   R4,SENSE
+r 218=B2330700              # SSCH  WRITE          (unit check)
+r 21C=B2B20310              # LPSWE WAIT
+r 230=A7380880              # SENSE LHI   R3,IRB2
+r 234=A7480250              # LHI   R4,DROP
+r 238=B2330740              # SSCH  SENSEORB
+r 23C=B2B20310              # LPSWE WAIT
+r 250=B2330700              # DROP  SSCH  WRITE    (interrupt dropped)
+r 254=C06101000000          # LGFI  R6,X'1000000'
+r 25A=A7660000              # BRCT  R6,*
+r 25E=B2350900              # TSCH  IRB3           (nothing pending)
+r 262=B2220070              # IPM   R7
+r 266=50700520              # ST    R7,TSCHCC
+r 26A=B2300000              # CSCH                 (missing interrupt)
+r 26E=A7380980              # LHI   R3,IRB4
+r 272=A7480280              # LHI   R4,DONE
+r 276=B2B20310              # LPSWE WAIT
+r 280=B2B20300              # DONE  LPSWE EOJ
+
+r 2C0=B235300007F4          # TSCH  0(R3); BR R4   (I/O interrupt)
+
+r 300=00020001800000000000000000000000  # Test finished
+r 310=02020001800000000000000000000000  # Wait for I/O interrupt
+r 580=00010001              # Subchannel id of 000E
+
+r 700=123456780080FF0000000720          # ORB: write
+r 720=0920000100000730      # Write, space 1, SLI
+r 730=C1
+r 740=123456780080FF0000000750          # ORB: sense
+r 750=0420000100000760      # Sense, SLI
+
+runtest   1
+
+*Compare
+r 808.4
+*Want "Injected unit check" 0E000000
+r 760.1
+*Want "Injected sense" 10
+r 888.4
+*Want "Sense status" 0C000000
+r 520.4
+*Want "Dropped interrupt" 10000000
+r 980.4
+*Want "Clear function" 00001001
+
+fault
+fault   DELETE  ALL
+detach    000E
+
+*Done
@@ -0,0 +1,33 @@
+*Testcase mainshare System reset clear gives storage back to the host
+
+# With page sharing on, a system reset clear returns main storage to
+# the host instead of clearing it, so it must read as zeros afterwards.
+# A scan request must leave nonzero storage alone.
+
+sysclear
+archlvl     z/Arch
+mainshare   on 0
+
+r 1000=1111111111111111
+r 1FF8=2222222222222222
+r 3000=3333333333333333
+
+mainshare   scan
+
+*Compare
+r 3000.8
+*Want "Nonzero frame after scan" 33333333 33333333
+
+sysclear
+
+*Compare
+r 1000.8
+*Want "First cleared frame" 00000000 00000000
+r 1FF8.8
+*Want "End of cleared frame" 00000000 00000000
+r 3000.8
+*Want "Second cleared frame" 00000000 00000000
+
+mainshare   off
+
+*Done
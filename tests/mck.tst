@@ -0,0 +1,38 @@
+# Machine check injection: a machine check made pending by the mck
+# command, and one raised by a reference to a machine check frame.
+
+*Testcase mck immediate
+sysclear
+archlvl z
+r 1A0=00040001800000000000000000000200
+r 1E0=0002000180000000000000000000DEAD
+r 200=A7F40000
+mck P,SE ADDR=2000 INVALID=FP
+runtest .1
+*Compare
+r E8.8
+*Want "mcic" 40008F8D 40330000
+r F8.8
+*Want "fsta" 00000000 00002000
+r 160.10
+*Want "mck old psw" 00040001 80000000 00000000 00000200
+*Done
+
+*Testcase mck frame
+sysclear
+archlvl z
+r 1A0=00040001800000000000000000000200
+r 1E0=0002000180000000000000000000DEAD
+r 200=A72830005810200092FF0300B2B20310
+r 310=0002000180000000000000000000BAD1
+mck P FRAME=3000 LIMIT=1
+runtest .1
+*Compare
+r E8.8
+*Want "mcic" 40000F9D 40330000
+r F8.8
+*Want "fsta" 00000000 00003000
+r 300.1
+*Want "no store" 00
+mck del all
+*Done
@@ -0,0 +1,51 @@
+*Testcase migrate live migration to a second instance and back
+
+# A second instance runs migrate.subtst in the background.  It takes
+# over the running guest, sets the flag that ends the guest's loop,
+# and migrates the guest back to this instance to finish.  The guest
+# counts clock comparator interrupts so that it mostly waits.
+
+shcmdopt    enable          # (the trailing '&' runs 'sh' in the background)
+sh ./hercules -p .libs -f "$(testpath)/tests.conf" -r "$(testpath)/migrate.subtst" -d >/dev/null 2>&1 &
+
+sysclear
+archlvl     z/Arch
+
+r 1A0=00000001800000000000000000000200  # Restart New PSW
+r 1B0=00000001800000000000000000000280  # External New PSW
+r 1D0=0002000180000000000000000000DEAD  # Program Check New PSW
+cr 0=800                    # Enable clock comparator interrupts
+
+r 200=B2050510              # ARM   STCK  NOW
+r 204=E31005100004          # LG    R1,NOW
+r 20A=C21A02710000          # ALGFI R1,10ms
+r 210=E31005180024          # STG   R1,CLKC
+r 216=B2060518              # SCKC  CLKC
+r 21A=B2B20310              # LPSWE WAIT
+
+r 280=58200500              # L     R2,COUNT        (external interrupt)
+r 284=A72A0001              # AHI   R2,1
+r 288=50200500              # ST    R2,COUNT
+r 28C=95AA0520              # CLI   FLAG,X'AA'      (set on the target)
+r 290=A7840004              # JE    DONE
+r 294=A7F4FFB6              # J     ARM
+r 298=50200508              # DONE  ST    R2,FINAL
+r 29C=92010521              # MVI   RESULT,X'01'
+r 2A0=B2B20300              # LPSWE EOJ
+
+r 300=00020001800000000000000000000000  # Test finished
+r 310=01020001800000000000000000000000  # Wait for external interrupt
+
+pause       2               # Let the second instance start listening
+restart
+pause       0.5
+migrate     127.0.0.1:41061
+migrate     incoming 127.0.0.1:41062
+pause       0.5
+shcmdopt    disable
+
+*Compare
+r 520.2
+*Want "Guest finished after migrating back" AA01
+
+*Done
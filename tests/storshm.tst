@@ -0,0 +1,38 @@
+*Testcase storshm view main storage from another process with storview
+
+# Main storage is allocated in a shared memory object (a file in the
+# test directory here) and storview copies absolute and then virtual
+# storage from it.  The virtual copy crosses a page boundary onto a
+# page that is not contiguous in real storage.  Both copies are loaded
+# back into storage elsewhere and compared with the originals.
+
+shcmdopt    enable
+sh rm -f storshmtst.*
+
+sysclear
+archlvl     z/Arch
+storshm     ./storshmtst.shm
+
+r 20FF0=00112233445566778899AABBCCDDEEFF
+r 22000=FFEEDDCCBBAA99887766554433221100
+r 10000=0000000000011000                    # Segment table: page table 11000
+r 11000=00000000000200000000000000022000    # Page table: pages 20000, 22000
+
+sh ./storview ./storshmtst.shm dump 20FF0 10 storshmtst.abs
+sh ./storview ./storshmtst.shm dump FF0 20 storshmtst.virt 10000
+loadcore    storshmtst.abs  30000
+loadcore    storshmtst.virt 30100
+
+*Compare
+r 30000.10
+*Want "Absolute copy" 00112233 44556677 8899AABB CCDDEEFF
+r 30100.10
+*Want "Virtual copy, first page" 00112233 44556677 8899AABB CCDDEEFF
+r 30110.10
+*Want "Virtual copy, second page" FFEEDDCC BBAA9988 77665544 33221100
+
+storshm     off
+sh rm -f storshmtst.*
+shcmdopt    disable
+
+*Done
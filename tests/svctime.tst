@@ -0,0 +1,60 @@
+*Testcase svctime device service time model
+
+mainsize    1
+numcpu      1
+sysclear
+archlvl     z/Arch
+
+detach  000E
+attach  000E  1403  "svctime.txt"  crlf
+svctime 000E  overhead=20000 cu=01,1
+
+r 1A0=00000001800000000000000000000200  # Restart New PSW
+r 1D0=0002000180000000000000000000DEAD  # Program Check New PSW
+r 1F0=00000001800000000000000000000280  # I/O Interrupt New PSW
+cr 6=FF000000               # Enable all I/O interruption subclasses
+
+r 200=58100580              # L     R1,=A(SID)
+r 204=B2340600              # STSCH SCHIB
+r 208=96800605              # OI    PMCW5,E        (enable subchannel)
+r 20C=B2320600              # MSCH  SCHIB
+r 210=A7380800              # LHI   R3,IRB
+r 214=A7480230              # LHI   R4,NEXT
+r 218=B2050500              # STCK  START
+r 21C=B2330700              # SSCH  ORB
+r 220=B2B20310              # LPSWE WAIT
+r 224=07000700              # (padding)
+r 230=B2050508              # NEXT  STCK  END
+r 234=E35005080004          # LG    R5,END
+r 23A=E35005000009          # SG    R5,START
+r 240=EB55000C000C          # SRLG  R5,R5,12       (microseconds)
+r 246=E35005100024          # STG   R5,ELAPSED
+r 24C=C25E00004E20          # CLGFI R5,20000       (at least 20ms)
+r 252=A7440009              # JL    DONE
+r 256=C25E0007A120          # CLGFI R5,500000      (but not 500ms)
+r 25C=A7240004              # JH    DONE
+r 260=92010520              # MVI   RESULT,X'01'
+r 264=B2B20300              # DONE  LPSWE EOJ
+
+r 280=B235300007F4          # TSCH  0(R3); BR R4   (I/O interrupt)
+
+r 300=00020001800000000000000000000000  # Test finished
+r 310=02020001800000000000000000000000  # Wait for I/O interrupt
+r 580=00010001              # Subchannel id of 000E
+
+r 700=123456780080FF0000000720          # ORB: format-1 CCWs
+r 720=0920000100000730      # Write, space 1, SLI
+r 730=C1
+
+runtest   1
+
+*Compare
+r 800.4
+*Want "SCSW" 00804007
+r 520.1
+*Want "Modelled service time" 01
+
+svctime 000E  off
+detach    000E
+
+*Done
@@ -1678,6 +1678,55 @@ BYTE    func;                           /* Function code...          */
 
 } /* end function diag_ppagerel */
 
+/*-------------------------------------------------------------------*/
+/* Release Pages (Function code 0x010)                               */
+/*-------------------------------------------------------------------*/
+/* R1 and R2 contain the real addresses of the first and the last    */
+/* page to be released.  The pages are returned to the host and      */
+/* contain zeros when they are next referenced.                      */
+/*-------------------------------------------------------------------*/
+void ARCH_DEP(diag_release_pages) (int r1, int r2, REGS *regs)
+{
+RADR    raddr, start, end;              /* Real page addresses       */
+RADR    aaddr;                          /* Absolute page address     */
+RADR    runbeg = 0, runend = 0;         /* Absolute pages to release */
+
+    /* Obtain the first and last page addresses */
+    start = GR_A(r1, regs);
+    end = GR_A(r2, regs);
+
+    /* Program check if the addresses are not on page boundaries
+       or if the first page follows the last */
+    if ((start & ~PAGEFRAME_PAGEMASK)
+        || (end & ~PAGEFRAME_PAGEMASK)
+        || start > end)
+    {
+        ARCH_DEP(program_interrupt) (regs, PGM_SPECIFICATION_EXCEPTION);
+    }
+
+    /* Program check if the last page is outside main storage */
+    if (end > regs->mainlim)
+    {
+        ARCH_DEP(program_interrupt) (regs, PGM_ADDRESSING_EXCEPTION);
+    }
+
+    /* Release runs of contiguous absolute pages; prefixing breaks
+       the range at the prefix area and at absolute page zero */
+    for (raddr = start; raddr <= end; raddr += PAGEFRAME_PAGESIZE)
+    {
+        aaddr = APPLY_PREFIXING( raddr, regs->PX );
+        if (aaddr != runend)
+        {
+            if (runend > runbeg)
+                release_storage( runbeg, runend - runbeg );
+            runbeg = aaddr;
+        }
+        runend = aaddr + PAGEFRAME_PAGESIZE;
+    }
+    release_storage( runbeg, runend - runbeg );
+
+} /* end function diag_release_pages */
+
 
 /*-------------------------------------------------------------------*/
 /* B2F0 IUCV  - Inter User Communications Vehicle                [S] */
@@ -6,8 +6,8 @@
 /*   Hercules.                                                       */
 
 /* This module contains device handling functions for the            */
-/* ZFCP Fibre Channel Protocol interface, and will translate all     */
-/* ZFCP requests to iSCSI requests                                   */
+/* ZFCP Fibre Channel Protocol interface. FSF requests are executed  */
+/* against emulated SCSI disks which are backed by host image files  */
 /*                                                                   */
 /* This implementation is based on the S/390 Linux implementation    */
 /*                                                                   */
@@ -17,8 +17,18 @@
 /*   0C00-0C02 ZFCP <optional parameters>                            */
 /* Parameters:                                                       */
 /* Optional parms:                                                   */
+/*   portname <wwpn>       adapter WWPN (default derived from devnum)*/
+/*   blksize <n>           block size of subsequently defined disks  */
+/*                         (512, 1024, 2048 or 4096, default 512)    */
+/*   disk <wwpn> <lun> <filename>                                    */
+/*                         attach image file as LUN of target WWPN   */
+/*   rodisk <wwpn> <lun> <filename>                                  */
+/*                         attach image file as read-only LUN        */
+/*   workers <n>           FSF request worker threads (default 4)    */
+/*   chpid <xx>            channel path id                           */
 /*                                                                   */
-/*                                                                   */
+/* Example:                                                          */
+/*   0C00 ZFCP disk 500507630300C562 4010400000000000 /img/lnx.img   */
 /*                                                                   */
 /* Related commands:                                                 */
 /*                                                                   */
@@ -101,138 +111,1385 @@ static const BYTE sense_id_bytes[] =
 };
 
 
-static BYTE zfcp_immed_commands [256] =
-{
-/* 0 1 2 3 4 5 6 7 8 9 A B C D E F */
-   0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0, /* 00 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1, /* 10 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 20 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 30 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 40 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 50 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 60 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 70 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 80 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 90 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* A0 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* B0 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* C0 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* D0 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* E0 */
-   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0  /* F0 */
-};
+static BYTE zfcp_immed_commands [256] =
+{
+/* 0 1 2 3 4 5 6 7 8 9 A B C D E F */
+   0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0, /* 00 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1, /* 10 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 20 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 30 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 40 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 50 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 60 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 70 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 80 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 90 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* A0 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* B0 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* C0 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* D0 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* E0 */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0  /* F0 */
+};
+
+
+/*-------------------------------------------------------------------*/
+/*   STORCHK  --  check storage access & update ref & change bits    */
+/*-------------------------------------------------------------------*/
+/*  Returns 0 if successful or CSW_PROGC or CSW_PROTC if error.      */
+/*  Storage key ref & change bits are only updated if successful.    */
+/*-------------------------------------------------------------------*/
+BYTE STORCHK
+(
+    U64      addr,              /* Storage address being accessed    */
+    size_t   len,               /* Length of storage being accessed  */
+    BYTE     key,               /* Storage access key                */
+    BYTE     acc,               /* Access type (STORKEY_REF/_CHANGE) */
+    DEVBLK*  dev                /* Pointer to device block           */
+)
+{
+    /* Validate address limits */
+    if (0
+        || (addr + len) > dev->mainlim   // (outside main storage)
+        || (dev->orb.flag5 & ORB5_A      // (or outside address limits)
+            && ((dev->pmcw.flag5 & PMCW5_LM_LOW  && (addr +  0 ) < sysblk.addrlimval) ||
+                (dev->pmcw.flag5 & PMCW5_LM_HIGH && (addr + len) > sysblk.addrlimval)))
+    )
+        return CSW_PROGC;
+
+    /* Validate keyed access */
+    if (key && key != (ARCH_DEP( get_dev_4K_storage_key )( dev, addr ) & STORKEY_KEY) // (key doesn't match)
+        && (0
+            || ARCH_DEP( get_dev_4K_storage_key )( dev, addr ) & STORKEY_FETCH        // (and fetch protected)
+            || acc == STORKEY_CHANGE                                                  // (or trying to update)
+           )
+    )
+        return CSW_PROTC;
+
+    if (STORKEY_CHANGE == acc)
+        ARCH_DEP( or_dev_4K_storage_key )( dev, addr, (STORKEY_REF | STORKEY_CHANGE) );
+    else
+        ARCH_DEP( or_dev_4K_storage_key )( dev, addr, STORKEY_REF );
+
+    return 0;  // (0 == success)
+}
+
+
+#if defined( ZFCP_DEBUG )
+#define DBGTRC( _dev, ... )                             \
+do {                                                    \
+  if (((ZFCP_GRP*)((_dev)->group->grp_data))->debug)    \
+        TRACE( __VA_ARGS__ );                           \
+} while(0)
+#else
+ #define DBGTRC( _dev, ... )
+#endif
+
+
+#if defined(_FEATURE_QDIO_THININT)
+/*-------------------------------------------------------------------*/
+/* Set Adapter Local Summary Indicator bits                          */
+/*-------------------------------------------------------------------*/
+static inline void set_alsi(DEVBLK *dev, BYTE bits)
+{
+    if(dev->qdio.alsi)
+    {
+    BYTE *alsi = dev->mainstor + dev->qdio.alsi;
+
+        obtain_lock(&sysblk.mainlock);
+        *alsi |= bits;
+        ARCH_DEP( or_dev_4K_storage_key )( dev, dev->qdio.alsi, (STORKEY_REF | STORKEY_CHANGE) );
+        release_lock(&sysblk.mainlock);
+    }
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Set Device State Change Indicator bits                            */
+/*-------------------------------------------------------------------*/
+static inline void set_dsci(DEVBLK *dev, BYTE bits)
+{
+    if(dev->qdio.dsci)
+    {
+    BYTE *dsci = dev->mainstor + dev->qdio.dsci;
+    BYTE *alsi = dev->mainstor + dev->qdio.alsi;
+
+        obtain_lock(&sysblk.mainlock);
+        *dsci |= bits;
+        ARCH_DEP( or_dev_4K_storage_key )( dev, dev->qdio.dsci, (STORKEY_REF | STORKEY_CHANGE) );
+        *alsi |= bits;
+        ARCH_DEP( or_dev_4K_storage_key )( dev, dev->qdio.alsi, (STORKEY_REF | STORKEY_CHANGE) );
+        release_lock(&sysblk.mainlock);
+    }
+}
+#endif /*defined(_FEATURE_QDIO_THININT)*/
+
+
+/*-------------------------------------------------------------------*/
+/* Raise Adapter Interrupt                                           */
+/*-------------------------------------------------------------------*/
+static void raise_adapter_interrupt(DEVBLK *dev)
+{
+    DBGTRC( dev, "Adapter Interrupt dev(%4.4x)\n", dev->devnum );
+
+    obtain_lock(&dev->lock);
+    dev->pciscsw.flag2 |= SCSW2_Q | SCSW2_FC_START;
+    dev->pciscsw.flag3 |= SCSW3_SC_INTER | SCSW3_SC_PEND;
+    dev->pciscsw.chanstat = CSW_PCI;
+    QUEUE_IO_INTERRUPT(&dev->pciioint,FALSE);
+    release_lock (&dev->lock);
+
+    /* Update interrupt status */
+    OBTAIN_INTLOCK( NULL );
+    UPDATE_IC_IOPENDING();
+    RELEASE_INTLOCK( NULL );
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Check and mark every 4K frame of a guest storage area             */
+/*-------------------------------------------------------------------*/
+static BYTE zfcp_storchk_range( U64 addr, U32 len, BYTE key, BYTE acc, DEVBLK* dev )
+{
+    U64  page;
+    BYTE rc;
+
+    if (!len)
+        return 0;
+
+    for (page = addr & ~((U64)_4K - 1); page < addr + len; page += _4K)
+    {
+        U64 beg = page < addr ? addr : page;
+        U64 end = (page + _4K) < (addr + len) ? (page + _4K) : (addr + len);
+
+        if ((rc = STORCHK( beg, (size_t)(end - beg - 1), key, acc, dev )))
+            return rc;
+    }
+
+    return 0;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Copy between a host buffer and the data segments of a request     */
+/*-------------------------------------------------------------------*/
+/* Returns the number of bytes actually copied, which is less than   */
+/* the requested length if the data segments are too short or if an  */
+/* addressing or protection exception was found.                     */
+/*-------------------------------------------------------------------*/
+static U32 zfcp_copy_data( DEVBLK* dev, ZFCP_REQ* req, U32 off,
+                           BYTE* buf, U32 len, int to_guest )
+{
+    U32 done = 0;
+    int i;
+
+    for (i = 0; i < req->nseg && done < len; i++)
+    {
+        U32 seglen = req->seg[i].len;
+        U32 num;
+
+        if (off >= seglen)
+        {
+            off -= seglen;
+            continue;
+        }
+
+        num = seglen - off;
+        if (num > len - done)
+            num = len - done;
+
+        if (zfcp_storchk_range( req->seg[i].addr + off, num, req->key,
+                                to_guest ? STORKEY_CHANGE : STORKEY_REF, dev ))
+            break;
+
+        if (to_guest)
+            memcpy( dev->mainstor + req->seg[i].addr + off, buf + done, num );
+        else
+            memcpy( buf + done, dev->mainstor + req->seg[i].addr + off, num );
+
+        done += num;
+        off = 0;
+    }
+
+    return done;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Total length of the data segments of a request                    */
+/*-------------------------------------------------------------------*/
+static U32 zfcp_data_length( ZFCP_REQ* req )
+{
+    U64 total = 0;
+    int i;
+
+    for (i = 0; i < req->nseg; i++)
+        total += req->seg[i].len;
+
+    return total > ZFCP_MAX_XFER ? ZFCP_MAX_XFER : (U32) total;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Transfer logical blocks between an image file and guest storage   */
+/*-------------------------------------------------------------------*/
+/* The image file is read or written directly into or out of guest   */
+/* main storage, one data segment at a time, without an intermediate */
+/* buffer. Returns the number of bytes transferred or -1 on error.   */
+/*-------------------------------------------------------------------*/
+static S64 zfcp_disk_io( DEVBLK* dev, ZFCP_REQ* req, ZFCP_LUN* disk,
+                         U64 lba, U32 len, int wr )
+{
+    off_t  pos = (off_t)(lba * disk->blksize);
+    U32    done = 0;
+    int    i;
+    int    rc = 0;
+
+    obtain_lock( &disk->lock );
+
+    if (lseek( disk->fd, pos, SEEK_SET ) < 0)
+    {
+        release_lock( &disk->lock );
+        return -1;
+    }
+
+    for (i = 0; i < req->nseg && done < len; i++)
+    {
+        U32   num = req->seg[i].len;
+        BYTE* p;
+
+        if (num > len - done)
+            num = len - done;
+
+        if (zfcp_storchk_range( req->seg[i].addr, num, req->key,
+                                wr ? STORKEY_REF : STORKEY_CHANGE, dev ))
+            break;
+
+        p = dev->mainstor + req->seg[i].addr;
+
+        if (wr)
+            rc = write( disk->fd, p, num );
+        else
+        {
+            rc = read( disk->fd, p, num );
+
+            /* Reading beyond end of a sparse image returns zeros */
+            if (rc >= 0 && (U32) rc < num)
+            {
+                memset( p + rc, 0, num - rc );
+                rc = num;
+            }
+        }
+
+        if (rc < 0 || (U32) rc != num)
+            break;
+
+        done += num;
+    }
+
+    if (wr)
+        disk->writes++;
+    else
+        disk->reads++;
+
+    release_lock( &disk->lock );
+
+    return rc < 0 ? -1 : (S64) done;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Release logical blocks of an image file (UNMAP)                   */
+/*-------------------------------------------------------------------*/
+static int zfcp_disk_unmap( ZFCP_LUN* disk, U64 lba, U32 nblks )
+{
+    off_t  pos = (off_t)(lba * disk->blksize);
+    U64    len = (U64) nblks * disk->blksize;
+    int    rc  = 0;
+
+    obtain_lock( &disk->lock );
+
+#if defined( FALLOC_FL_PUNCH_HOLE ) && defined( FALLOC_FL_KEEP_SIZE )
+    if (disk->unmap)
+        rc = fallocate( disk->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, pos, (off_t) len );
+    else
+#endif
+    {
+        /* No hole punching support: overwrite the range with zeros */
+        static const BYTE zeros[ 4096 ] = {0};
+
+        if (lseek( disk->fd, pos, SEEK_SET ) < 0)
+            rc = -1;
+
+        while (!rc && len)
+        {
+            U32 num = len > sizeof( zeros ) ? (U32) sizeof( zeros ) : (U32) len;
+            if (write( disk->fd, zeros, num ) != (int) num)
+                rc = -1;
+            len -= num;
+        }
+    }
+
+    release_lock( &disk->lock );
+
+    return rc;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Set SCSI CHECK CONDITION status with fixed format sense data      */
+/*-------------------------------------------------------------------*/
+static void zfcp_check_condition( FCP_RSP* rsp, BYTE key, BYTE asc, BYTE ascq )
+{
+    BYTE* sense = rsp->fr_sense;
+
+    memset( sense, 0, SCSI_SENSE_LEN );
+    sense[0]  = 0x70;                   /* Current error, fixed fmt  */
+    sense[2]  = key;                    /* Sense key                 */
+    sense[7]  = SCSI_SENSE_LEN - 8;     /* Additional sense length   */
+    sense[12] = asc;                    /* Additional sense code     */
+    sense[13] = ascq;                   /* Additional sense qualifier*/
+
+    rsp->fr_status = SCSI_STATUS_CHECK_CONDITION;
+    rsp->fr_flags |= FCP_SNS_LEN_VAL;
+    STORE_FW( rsp->fr_sns_len, SCSI_SENSE_LEN );
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Build SCSI standard INQUIRY or vital product data                 */
+/*-------------------------------------------------------------------*/
+static int zfcp_inquiry( ZFCP_GRP* grp, ZFCP_LUNH* lh, BYTE* cdb, BYTE* buf )
+{
+    ZFCP_LUN* disk = lh->disk;
+    char      serial[ 33 ];
+    int       len;
+
+    memset( buf, 0, 256 );
+
+    if (!disk)
+    {
+        /* Peripheral qualifier 3: no logical unit at this LUN */
+        buf[0] = 0x7F;
+        buf[2] = 0x06;
+        buf[3] = 0x02;
+        buf[4] = 31;
+        return (cdb[1] & 0x01) ? 4 : 36;
+    }
+
+    snprintf( serial, sizeof( serial ), "%16.16"PRIX64"%16.16"PRIX64,
+              disk->wwpn, disk->lun );
+
+    if (!(cdb[1] & 0x01))
+    {
+        /* Standard inquiry data */
+        buf[0] = 0x00;                      /* Direct access block   */
+        buf[2] = 0x06;                      /* SPC-4                 */
+        buf[3] = 0x02;                      /* Response data format  */
+        buf[4] = 96 - 5;                    /* Additional length     */
+        buf[7] = 0x02;                      /* CMDQUE                */
+        memcpy( buf +  8, "HERCULES",         8 );
+        memcpy( buf + 16, "FCP DISK        ", 16 );
+        memcpy( buf + 32, "0001",             4 );
+        memcpy( buf + 36, serial, 20 );
+        return 96;
+    }
+
+    buf[1] = cdb[2];                        /* Page code             */
+
+    switch (cdb[2])
+    {
+    case 0x00:                              /* Supported VPD pages   */
+        buf[4] = 0x00;
+        buf[5] = 0x80;
+        buf[6] = 0x83;
+        buf[7] = 0xB0;
+        buf[8] = 0xB1;
+        buf[9] = 0xB2;
+        len = 6;
+        break;
+
+    case 0x80:                              /* Unit serial number    */
+        len = (int) strlen( serial );
+        memcpy( buf + 4, serial, len );
+        break;
+
+    case 0x83:                              /* Device identification */
+        /* NAA IEEE Registered Extended designator */
+        buf[4]  = 0x01;                     /* Binary code set       */
+        buf[5]  = 0x03;                     /* LU assoc, NAA type    */
+        buf[7]  = 16;
+        STORE_DW( buf +  8, (disk->wwpn & 0x0FFFFFFFFFFFFFFFULL) | 0x6000000000000000ULL );
+        STORE_DW( buf + 16, disk->lun );
+        /* T10 vendor identification designator */
+        buf[24] = 0x02;                     /* ASCII code set        */
+        buf[25] = 0x01;                     /* LU assoc, T10 type    */
+        buf[27] = 8 + 32;
+        memcpy( buf + 28, "HERCULES", 8 );
+        memcpy( buf + 36, serial, 32 );
+        len = 64;
+        break;
+
+    case 0xB0:                              /* Block limits          */
+        buf[3] = 0x3C;
+        STORE_FW( buf +  8, ZFCP_MAX_XFER / disk->blksize );  /* max xfer  */
+        STORE_FW( buf + 12, ZFCP_MAX_XFER / disk->blksize );  /* opt xfer  */
+        if (!disk->rdonly)
+        {
+            STORE_FW( buf + 20, 0xFFFFFFFF );   /* Max unmap LBA count   */
+            STORE_FW( buf + 24, 64 );           /* Max unmap descriptors */
+            STORE_FW( buf + 28, 1 );            /* Unmap granularity     */
+        }
+        return 64;
+
+    case 0xB1:                              /* Block device chars    */
+        buf[3] = 0x3C;
+        buf[5] = 0x01;                      /* Non-rotating medium   */
+        return 64;
+
+    case 0xB2:                              /* Logical block provis. */
+        buf[3] = 0x04;
+        if (!disk->rdonly)
+            buf[5] = 0x80 | (disk->unmap ? 0x04 : 0x00);   /* LBPU, LBPRZ */
+        buf[6] = 0x02;                      /* Thin provisioned      */
+        return 8;
+
+    default:
+        return -1;
+    }
+
+    STORE_HW( buf + 2, (U16) len );
+    UNREFERENCED( grp );
+    return len + 4;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Build SCSI MODE SENSE data                                        */
+/*-------------------------------------------------------------------*/
+static int zfcp_mode_sense( ZFCP_LUN* disk, BYTE* cdb, BYTE* buf )
+{
+    int  ten  = (cdb[0] == SCSI_MODE_SENSE_10);
+    int  hlen = ten ? 8 : 4;
+    int  page = cdb[2] & 0x3F;
+    int  len  = hlen;
+    BYTE* p;
+
+    memset( buf, 0, 256 );
+
+    /* Device specific parameter: write protect and DPOFUA */
+    buf[ ten ? 3 : 2 ] = (disk->rdonly ? 0x80 : 0x00) | 0x10;
+
+    /* Block descriptor unless disabled */
+    if (!(cdb[1] & 0x08))
+    {
+        p = buf + len;
+        STORE_FW( p, disk->nblks > 0xFFFFFF ? 0xFFFFFF : (U32) disk->nblks );
+        p[0] = 0;
+        STORE_FW( p + 4, disk->blksize & 0xFFFFFF );
+        len += 8;
+        buf[ ten ? 7 : 3 ] = 8;
+    }
+
+    if (page == 0x08 || page == 0x3F)
+    {
+        /* Caching mode page: write cache enabled */
+        p = buf + len;
+        p[0] = 0x08;
+        p[1] = 0x12;
+        p[2] = 0x04;
+        len += 20;
+    }
+
+    if (page == 0x0A || page == 0x3F)
+    {
+        /* Control mode page */
+        p = buf + len;
+        p[0] = 0x0A;
+        p[1] = 0x0A;
+        p[3] = 0x10;                        /* Unrestricted reorder  */
+        len += 12;
+    }
+
+    if (len == hlen + buf[ ten ? 7 : 3 ] && page != 0x00)
+        return -1;
+
+    if (ten)
+        STORE_HW( buf, (U16)(len - 2) );
+    else
+        buf[0] = (BYTE)(len - 1);
+
+    return len;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Execute a SCSI command against an emulated logical unit           */
+/*-------------------------------------------------------------------*/
+static void zfcp_scsi_command( DEVBLK* dev, ZFCP_REQ* req, ZFCP_LUNH* lh, FSF_QTCB* qtcb )
+{
+ZFCP_GRP* grp  = (ZFCP_GRP*)dev->group->grp_data;
+FCP_CMND* cmnd = (FCP_CMND*) qtcb->bottom.io.fcp_cmnd;
+FCP_RSP*  rsp  = (FCP_RSP*)  qtcb->bottom.io.fcp_rsp;
+ZFCP_LUN* disk = lh->disk;
+BYTE*     cdb  = cmnd->fc_cdb;
+BYTE      buf[ 512 ];                   /* Non-media response data   */
+U32       dl;                           /* FCP data length           */
+U32       xfer = 0;                     /* Bytes transferred         */
+int       len  = -1;                    /* Response data length      */
+U64       lba;
+U32       nblks;
+S64       rc;
+
+    memset( rsp, 0, sizeof( FCP_RSP ));
+
+    FETCH_FW( dl, cmnd->fc_dl );
+    if (dl > zfcp_data_length( req ))
+        dl = zfcp_data_length( req );
+
+    DBGTRC( dev, "SCSI CDB %2.2X lun(%16.16"PRIx64") dl(%u)\n", cdb[0], lh->lun, dl );
+
+    /* Commands accepted whether or not a unit exists at this LUN */
+    switch (cdb[0])
+    {
+    case SCSI_INQUIRY:
+        len = zfcp_inquiry( grp, lh, cdb, buf );
+        if (len < 0)
+        {
+            zfcp_check_condition( rsp, SCSI_SENSE_ILLEGAL_REQUEST, 0x24, 0x00 );
+            goto done;
+        }
+        if (len > (int) fetch_hw( cdb + 3 ))
+            len = fetch_hw( cdb + 3 );
+        goto xfer_in;
+
+    case SCSI_REPORT_LUNS:
+    {
+        ZFCP_PORT* port = &grp->port[ lh->port_handle - ZFCP_PORT_HANDLE_BASE ];
+        ZFCP_LUN*  l;
+        int n = 0;
+
+        memset( buf, 0, sizeof( buf ));
+        for (l = grp->luns; l && (8 + (n+1) * 8) <= (int) sizeof( buf ); l = l->next)
+            if (l->wwpn == port->wwpn)
+                STORE_DW( buf + 8 + 8 * n++, l->lun );
+        STORE_FW( buf, n * 8 );
+        len = 8 + n * 8;
+        if (len > (int) fetch_fw( cdb + 6 ))
+            len = fetch_fw( cdb + 6 );
+        goto xfer_in;
+    }
+
+    case SCSI_REQUEST_SENSE:
+        memset( buf, 0, SCSI_SENSE_LEN );
+        buf[0] = 0x70;
+        buf[7] = SCSI_SENSE_LEN - 8;
+        len = SCSI_SENSE_LEN < cdb[4] ? SCSI_SENSE_LEN : cdb[4];
+        goto xfer_in;
+    }
+
+    if (!disk)
+    {
+        zfcp_check_condition( rsp, SCSI_SENSE_ILLEGAL_REQUEST, 0x25, 0x00 );
+        goto done;
+    }
+
+    switch (cdb[0])
+    {
+    case SCSI_TEST_UNIT_READY:
+    case SCSI_START_STOP_UNIT:
+    case SCSI_VERIFY_10:
+    case SCSI_VERIFY_16:
+        break;
+
+    case SCSI_READ_CAPACITY_10:
+        STORE_FW( buf, disk->nblks > 0xFFFFFFFFULL ? 0xFFFFFFFF : (U32)(disk->nblks - 1) );
+        STORE_FW( buf + 4, disk->blksize );
+        len = 8;
+        goto xfer_in;
+
+    case SCSI_SERVICE_ACTION_IN_16:
+        if ((cdb[1] & 0x1F) != 0x10)        /* READ CAPACITY (16)    */
+        {
+            zfcp_check_condition( rsp, SCSI_SENSE_ILLEGAL_REQUEST, 0x24, 0x00 );
+            goto done;
+        }
+        memset( buf, 0, 32 );
+        STORE_DW( buf, disk->nblks - 1 );
+        STORE_FW( buf + 8, disk->blksize );
+        if (!disk->rdonly)
+            buf[14] = 0x80 | (disk->unmap ? 0x40 : 0x00);  /* LBPME, LBPRZ */
+        len = 32;
+        if (len > (int) fetch_fw( cdb + 10 ))
+            len = fetch_fw( cdb + 10 );
+        goto xfer_in;
+
+    case SCSI_MODE_SENSE_6:
+    case SCSI_MODE_SENSE_10:
+        len = zfcp_mode_sense( disk, cdb, buf );
+        if (len < 0)
+        {
+            zfcp_check_condition( rsp, SCSI_SENSE_ILLEGAL_REQUEST, 0x24, 0x00 );
+            goto done;
+        }
+        if (cdb[0] == SCSI_MODE_SENSE_6 ? len > cdb[4] : len > (int) fetch_hw( cdb + 7 ))
+            len = (cdb[0] == SCSI_MODE_SENSE_6) ? cdb[4] : fetch_hw( cdb + 7 );
+        goto xfer_in;
+
+    case SCSI_SYNCHRONIZE_CACHE_10:
+    case SCSI_SYNCHRONIZE_CACHE_16:
+        obtain_lock( &disk->lock );
+        rc = fdatasync( disk->fd );
+        release_lock( &disk->lock );
+        if (rc < 0)
+            zfcp_check_condition( rsp, SCSI_SENSE_MEDIUM_ERROR, 0x0C, 0x00 );
+        break;
+
+    case SCSI_UNMAP:
+    {
+        U32 plen, i;
+
+        if (disk->rdonly)
+        {
+            zfcp_check_condition( rsp, SCSI_SENSE_DATA_PROTECT, 0x27, 0x00 );
+            goto done;
+        }
+
+        plen = zfcp_copy_data( dev, req, 0, buf, dl < sizeof( buf ) ? dl : sizeof( buf ), FALSE );
+        xfer = plen;
+
+        for (i = 8; i + 16 <= plen && i < 8 + (U32) fetch_hw( buf + 2 ); i += 16)
+        {
+            FETCH_DW( lba,   buf + i );
+            FETCH_FW( nblks, buf + i + 8 );
+
+            if (lba + nblks > disk->nblks)
+            {
+                zfcp_check_condition( rsp, SCSI_SENSE_ILLEGAL_REQUEST, 0x21, 0x00 );
+                goto done;
+            }
+            if (nblks && zfcp_disk_unmap( disk, lba, nblks ) < 0)
+            {
+                zfcp_check_condition( rsp, SCSI_SENSE_MEDIUM_ERROR, 0x0C, 0x00 );
+                goto done;
+            }
+        }
+        break;
+    }
+
+    case SCSI_READ_6:
+    case SCSI_WRITE_6:
+        lba   = ((cdb[1] & 0x1F) << 16) | (cdb[2] << 8) | cdb[3];
+        nblks = cdb[4] ? cdb[4] : 256;
+        goto rw;
+
+    case SCSI_READ_10:
+    case SCSI_WRITE_10:
+        lba   = fetch_fw( cdb + 2 );
+        nblks = fetch_hw( cdb + 7 );
+        goto rw;
+
+    case SCSI_READ_16:
+    case SCSI_WRITE_16:
+        FETCH_DW( lba, cdb + 2 );
+        nblks = fetch_fw( cdb + 10 );
+    rw:
+    {
+        int wr = (cdb[0] == SCSI_WRITE_6 || cdb[0] == SCSI_WRITE_10 || cdb[0] == SCSI_WRITE_16);
+        U64 want  = (U64) nblks * disk->blksize;
+
+        if (lba > disk->nblks || nblks > disk->nblks - lba)
+        {
+            zfcp_check_condition( rsp, SCSI_SENSE_ILLEGAL_REQUEST, 0x21, 0x00 );
+            goto done;
+        }
+        if (wr && disk->rdonly)
+        {
+            zfcp_check_condition( rsp, SCSI_SENSE_DATA_PROTECT, 0x27, 0x00 );
+            goto done;
+        }
+
+        rc = zfcp_disk_io( dev, req, disk, lba, (U32)(want < dl ? want : dl), wr );
+
+        if (rc < 0)
+        {
+            // "%1d:%04X %s: I/O error on LUN %16.16"PRIX64": %s"
+            WRMSG( HHC03854, "E", LCSS_DEVNUM, dev->typname, disk->lun, strerror( errno ));
+            zfcp_check_condition( rsp, SCSI_SENSE_MEDIUM_ERROR, wr ? 0x0C : 0x11, 0x00 );
+            goto done;
+        }
+
+        xfer = (U32) rc;
+
+        obtain_lock( &grp->wlock );
+        if (wr)
+        {
+            grp->output_reqs++;
+            grp->output_bytes += xfer;
+        }
+        else
+        {
+            grp->input_reqs++;
+            grp->input_bytes += xfer;
+        }
+        release_lock( &grp->wlock );
+        break;
+    }
+
+    default:
+        zfcp_check_condition( rsp, SCSI_SENSE_ILLEGAL_REQUEST, 0x20, 0x00 );
+        goto done;
+    }
+
+    goto done;
+
+xfer_in:
+
+    if (len > (int) dl)
+        len = dl;
+    xfer = zfcp_copy_data( dev, req, 0, buf, len, TRUE );
+
+done:
+
+    if (rsp->fr_status == SCSI_STATUS_GOOD && xfer < dl)
+    {
+        rsp->fr_flags |= FCP_RESID_UNDER;
+        STORE_FW( rsp->fr_resid, dl - xfer );
+    }
+
+    if (cdb[0] != SCSI_READ_6  && cdb[0] != SCSI_READ_10  && cdb[0] != SCSI_READ_16
+     && cdb[0] != SCSI_WRITE_6 && cdb[0] != SCSI_WRITE_10 && cdb[0] != SCSI_WRITE_16)
+    {
+        obtain_lock( &grp->wlock );
+        grp->control_reqs++;
+        release_lock( &grp->wlock );
+    }
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Build PLOGI/FLOGI service parameters for a port                   */
+/*-------------------------------------------------------------------*/
+static void zfcp_build_plogi( BYTE* buf, BYTE cmd, U64 wwpn, U64 wwnn )
+{
+    memset( buf, 0, FC_PLOGI_LEN );
+
+    buf[0]  = cmd;                          /* ELS command code      */
+    buf[4]  = 0x20;                         /* FC-PH highest version */
+    buf[5]  = 0x20;                         /* FC-PH lowest version  */
+    STORE_HW( buf +  6, 0x0010 );           /* BB credit             */
+    STORE_HW( buf +  8, 0x8800 );           /* Common features       */
+    STORE_HW( buf + 10, 2112 );             /* Receive data field    */
+    STORE_FW( buf + 16, 2000 );             /* E_D_TOV               */
+    STORE_DW( buf + 20, wwpn );             /* Port name             */
+    STORE_DW( buf + 28, wwnn );             /* Node name             */
+    buf[68] = FC_CPC_VALID;                 /* Class 3 valid         */
+    STORE_HW( buf + 74, 2112 );             /* Class 3 data field    */
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Locate a remote port by port handle                               */
+/*-------------------------------------------------------------------*/
+static ZFCP_PORT* zfcp_find_port_handle( ZFCP_GRP* grp, U32 handle )
+{
+    if (handle && grp->dirserv.handle == handle)
+        return &grp->dirserv;
+
+    if (handle >= ZFCP_PORT_HANDLE_BASE
+     && handle <  ZFCP_PORT_HANDLE_BASE + (U32) grp->nports
+     && grp->port[ handle - ZFCP_PORT_HANDLE_BASE ].handle == handle)
+        return &grp->port[ handle - ZFCP_PORT_HANDLE_BASE ];
+
+    return NULL;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Locate an open LUN by LUN handle                                  */
+/*-------------------------------------------------------------------*/
+static ZFCP_LUNH* zfcp_find_lun_handle( ZFCP_GRP* grp, U32 port_handle, U32 handle )
+{
+    ZFCP_LUNH* lh;
+
+    if (handle < ZFCP_LUN_HANDLE_BASE
+     || handle >= ZFCP_LUN_HANDLE_BASE + ZFCP_MAX_OPEN_LUNS)
+        return NULL;
+
+    lh = &grp->lunh[ handle - ZFCP_LUN_HANDLE_BASE ];
+
+    return (lh->port_handle && lh->port_handle == port_handle) ? lh : NULL;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Directory server: process a Common Transport (CT) request         */
+/*-------------------------------------------------------------------*/
+static U32 zfcp_name_server( ZFCP_GRP* grp, BYTE* ct, U32 ctlen, BYTE* rsp, U32 rsplen )
+{
+    FC_CT_HDR* req = (FC_CT_HDR*) ct;
+    FC_CT_HDR* hdr = (FC_CT_HDR*) rsp;
+    U32        len = sizeof( FC_CT_HDR );
+    U64        wwpn;
+    int        i;
+
+    memset( rsp, 0, rsplen );
+    memcpy( hdr, req, 8 );
+    STORE_HW( hdr->ct_cmd, FC_FS_RJT );
+    hdr->ct_reason = FC_FS_RJT_UNSUP;
+
+    if (ctlen < sizeof( FC_CT_HDR ) || req->ct_fs_type != FC_FST_DIR
+     || req->ct_fs_subtype != FC_NS_SUBTYPE)
+        return len;
+
+    switch (fetch_hw( req->ct_cmd ))
+    {
+    case FC_NS_GID_PN:
+        if (ctlen < sizeof( FC_CT_HDR ) + 8 || rsplen < len + 4)
+            break;
+        FETCH_DW( wwpn, ct + sizeof( FC_CT_HDR ));
+        for (i = 0; i < grp->nports; i++)
+            if (grp->port[i].wwpn == wwpn)
+            {
+                STORE_HW( hdr->ct_cmd, FC_FS_ACC );
+                hdr->ct_reason = 0;
+                STORE_FW( rsp + len, grp->port[i].d_id );
+                return len + 4;
+            }
+        hdr->ct_explan = FC_FS_EXP_PID_NOT_REG;
+        break;
+
+    case FC_NS_GPN_FT:
+        if (ctlen < sizeof( FC_CT_HDR ) + 4 || ct[ sizeof( FC_CT_HDR ) + 3 ] != FC_TYPE_FCP
+         || !grp->nports)
+        {
+            hdr->ct_explan = FC_FS_EXP_FC4_NOT_REG;
+            break;
+        }
+        STORE_HW( hdr->ct_cmd, FC_FS_ACC );
+        hdr->ct_reason = 0;
+        for (i = 0; i < grp->nports && len + 16 <= rsplen; i++, len += 16)
+        {
+            STORE_FW( rsp + len, grp->port[i].d_id );
+            STORE_DW( rsp + len + 8, grp->port[i].wwpn );
+        }
+        rsp[ len - 16 ] |= FC_NS_FID_LAST;
+        return len;
+    }
+
+    return len;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Execute one FSF request                                           */
+/*-------------------------------------------------------------------*/
+static void zfcp_execute_fsf( DEVBLK* dev, ZFCP_REQ* req )
+{
+ZFCP_GRP*  grp  = (ZFCP_GRP*)dev->group->grp_data;
+FSF_QTCB*  qtcb = (FSF_QTCB*)(dev->mainstor + req->qtcb);
+ZFCP_PORT* port;
+ZFCP_LUNH* lh;
+U32        cmd, status = FSF_GOOD, qual = 0;
+U32        port_handle, lun_handle, d_id;
+int        i;
+
+    FETCH_FW( cmd,         qtcb->header.fsf_command );
+    FETCH_FW( port_handle, qtcb->header.port_handle );
+    FETCH_FW( lun_handle,  qtcb->header.lun_handle  );
+
+    DBGTRC( dev, "FSF command(%8.8x) req_id(%16.16"PRIx64")\n", cmd, req->req_id );
+
+    if (fetch_fw( qtcb->prefix.qtcb_version ) != FSF_QTCB_CURRENT_VERSION)
+    {
+        STORE_FW( qtcb->prefix.prot_status, FSF_PROT_QTCB_VERSION_ERROR );
+        STORE_FW( qtcb->prefix.prot_status_qual, FSF_QTCB_CURRENT_VERSION );
+        return;
+    }
+
+    switch (cmd)
+    {
+    case FSF_QTCB_EXCHANGE_CONFIG_DATA:
+    {
+        FSF_QTCB_BOTTOM_CONFIG* cfg = &qtcb->bottom.config;
+        char ser[ 33 ];
+
+        memset( cfg, 0, sizeof( *cfg ));
+        STORE_FW( cfg->lic_version,            0x00000001 );
+        STORE_FW( cfg->high_qtcb_version,      FSF_QTCB_CURRENT_VERSION );
+        STORE_FW( cfg->low_qtcb_version,       FSF_QTCB_CURRENT_VERSION );
+        STORE_FW( cfg->max_qtcb_size,          sizeof( FSF_QTCB ));
+        STORE_FW( cfg->max_data_transfer_size, ZFCP_MAX_XFER );
+        STORE_FW( cfg->fc_link_speed,          FSF_PORTSPEED_8GBIT );
+        STORE_FW( cfg->adapter_ports,          1 );
+        STORE_FW( cfg->hardware_version,       0x00000001 );
+        STORE_F3( cfg->s_id,                   ZFCP_S_ID );
+        zfcp_build_plogi( cfg->nport_serv_param, 0, grp->own_wwpn, grp->own_wwpn ^ 0x0100000000000000ULL );
+
+        MSGBUF( ser, "%-32.4X", dev->devnum );
+        str_host_to_guest( (BYTE*) ser, cfg->serial_number, 32 );
+
+        if (grp->nports == 1)
+        {
+            /* Single target port: point-to-point connection */
+            STORE_FW( cfg->fc_topology, FSF_TOPO_P2P );
+            STORE_F3( cfg->peer_d_id, grp->port[0].d_id );
+            zfcp_build_plogi( cfg->plogi_payload, ELS_PLOGI, grp->port[0].wwpn, grp->port[0].wwnn );
+        }
+        else
+            STORE_FW( cfg->fc_topology, FSF_TOPO_FABRIC );
+        break;
+    }
+
+    case FSF_QTCB_EXCHANGE_PORT_DATA:
+    {
+        FSF_QTCB_BOTTOM_PORT* bp = &qtcb->bottom.port;
+
+        memset( bp, 0, sizeof( *bp ));
+        STORE_DW( bp->wwpn,               grp->own_wwpn );
+        STORE_FW( bp->fc_port_id,         ZFCP_S_ID );
+        STORE_FW( bp->class_of_service,   0x00000008 );
+        bp->supported_fc4_types[2] = 0x01;          /* FCP           */
+        bp->active_fc4_types[2]    = 0x01;
+        STORE_FW( bp->supported_speed,    FSF_PORTSPEED_8GBIT );
+        STORE_FW( bp->maximum_frame_size, 2112 );
+        obtain_lock( &grp->wlock );
+        STORE_DW( bp->input_requests,     grp->input_reqs   );
+        STORE_DW( bp->output_requests,    grp->output_reqs  );
+        STORE_DW( bp->control_requests,   grp->control_reqs );
+        STORE_DW( bp->input_mb,           grp->input_bytes  / 1000000 );
+        STORE_DW( bp->output_mb,          grp->output_bytes / 1000000 );
+        release_lock( &grp->wlock );
+        break;
+    }
+
+    case FSF_QTCB_OPEN_PORT_WITH_DID:
+    {
+        FSF_QTCB_BOTTOM_SUPPORT* sup = &qtcb->bottom.support;
+
+        FETCH_F3( d_id, sup->d_id );
+        port = NULL;
+
+        if (d_id == ZFCP_D_ID_DIRSERV && grp->nports != 1)
+            port = &grp->dirserv;
+        else
+            for (i = 0; i < grp->nports; i++)
+                if (grp->port[i].d_id == d_id)
+                    port = &grp->port[i];
+
+        if (!port)
+        {
+            status = FSF_ADAPTER_STATUS_AVAILABLE;
+            qual   = FSF_SQ_NO_RETRY_POSSIBLE;
+            break;
+        }
+
+        port->handle = (port == &grp->dirserv) ? ZFCP_PORT_HANDLE_BASE - 1
+                     : ZFCP_PORT_HANDLE_BASE + (U32)(port - grp->port);
+        STORE_FW( qtcb->header.port_handle, port->handle );
+
+        zfcp_build_plogi( sup->els, ELS_LS_ACC, port->wwpn, port->wwnn );
+        STORE_FW( sup->els1_length, FC_PLOGI_LEN );
+        break;
+    }
+
+    case FSF_QTCB_CLOSE_PORT:
+    case FSF_QTCB_CLOSE_PHYSICAL_PORT:
+        if (!(port = zfcp_find_port_handle( grp, port_handle )))
+        {
+            status = FSF_PORT_HANDLE_NOT_VALID;
+            break;
+        }
+        for (i = 0; i < ZFCP_MAX_OPEN_LUNS; i++)
+            if (grp->lunh[i].port_handle == port_handle)
+                grp->lunh[i].port_handle = 0;
+        port->handle = 0;
+        break;
+
+    case FSF_QTCB_OPEN_LUN:
+    {
+        U64 lun;
+        ZFCP_LUN* disk;
+
+        if (!(port = zfcp_find_port_handle( grp, port_handle )) || port == &grp->dirserv)
+        {
+            status = FSF_PORT_HANDLE_NOT_VALID;
+            break;
+        }
+
+        FETCH_DW( lun, qtcb->bottom.support.fcp_lun );
+
+        obtain_lock( &grp->wlock );
+        for (i = 0; i < ZFCP_MAX_OPEN_LUNS; i++)
+            if (grp->lunh[i].port_handle == port_handle && grp->lunh[i].lun == lun)
+                break;
+        if (i >= ZFCP_MAX_OPEN_LUNS)
+            for (i = 0; i < ZFCP_MAX_OPEN_LUNS && grp->lunh[i].port_handle; i++);
+        if (i < ZFCP_MAX_OPEN_LUNS)
+        {
+            for (disk = grp->luns; disk; disk = disk->next)
+                if (disk->wwpn == port->wwpn && disk->lun == lun)
+                    break;
+            grp->lunh[i].port_handle = port_handle;
+            grp->lunh[i].lun         = lun;
+            grp->lunh[i].disk        = disk;
+        }
+        release_lock( &grp->wlock );
+
+        if (i >= ZFCP_MAX_OPEN_LUNS)
+        {
+            status = FSF_MAXIMUM_NUMBER_OF_LUNS_EXCEEDED;
+            break;
+        }
+
+        STORE_FW( qtcb->header.lun_handle, ZFCP_LUN_HANDLE_BASE + i );
+        break;
+    }
+
+    case FSF_QTCB_CLOSE_LUN:
+        if (!zfcp_find_port_handle( grp, port_handle ))
+            status = FSF_PORT_HANDLE_NOT_VALID;
+        else if (!(lh = zfcp_find_lun_handle( grp, port_handle, lun_handle )))
+            status = FSF_LUN_HANDLE_NOT_VALID;
+        else
+            lh->port_handle = 0;
+        break;
+
+    case FSF_QTCB_FCP_CMND:
+    {
+        U32 dir;
+
+        if (!zfcp_find_port_handle( grp, port_handle ))
+        {
+            status = FSF_PORT_HANDLE_NOT_VALID;
+            break;
+        }
+        if (!(lh = zfcp_find_lun_handle( grp, port_handle, lun_handle )))
+        {
+            status = FSF_LUN_HANDLE_NOT_VALID;
+            break;
+        }
+
+        FETCH_FW( dir, qtcb->bottom.io.data_direction );
+        if (dir != FSF_DATADIR_READ && dir != FSF_DATADIR_WRITE && dir != FSF_DATADIR_CMND)
+        {
+            status = FSF_DIRECTION_INDICATOR_NOT_VALID;
+            break;
+        }
+        if (fetch_fw( qtcb->bottom.io.fcp_cmnd_length ) < sizeof( FCP_CMND ))
+        {
+            status = FSF_CMND_LENGTH_NOT_VALID;
+            break;
+        }
+        if (dir == FSF_DATADIR_CMND)
+            req->nseg = 0;
+
+        zfcp_scsi_command( dev, req, lh, qtcb );
+        break;
+    }
+
+    case FSF_QTCB_ABORT_FCP_CMND:
+        /* Commands are never left outstanding by the target */
+        status = FSF_FCP_COMMAND_DOES_NOT_EXIST;
+        break;
+
+    case FSF_QTCB_SEND_GENERIC:
+    {
+        FSF_QTCB_BOTTOM_SUPPORT* sup = &qtcb->bottom.support;
+        BYTE ct[ 256 ], rsp[ 4096 ];
+        U32  ctlen, rsplen;
+
+        if (!(port = zfcp_find_port_handle( grp, port_handle )) || port != &grp->dirserv
+         || req->nseg < 2)
+        {
+            status = FSF_GENERIC_COMMAND_REJECTED;
+            break;
+        }
+
+        ctlen  = req->seg[0].len < sizeof( ct )  ? req->seg[0].len : sizeof( ct );
+        rsplen = req->seg[1].len < sizeof( rsp ) ? req->seg[1].len : sizeof( rsp );
+        ctlen  = zfcp_copy_data( dev, req, 0, ct, ctlen, FALSE );
+
+        rsplen = zfcp_name_server( grp, ct, ctlen, rsp, rsplen );
+        zfcp_copy_data( dev, req, req->seg[0].len, rsp, rsplen, TRUE );
+        STORE_FW( sup->resp_buf_length, rsplen );
+        break;
+    }
+
+    case FSF_QTCB_SEND_ELS:
+    {
+        FSF_QTCB_BOTTOM_SUPPORT* sup = &qtcb->bottom.support;
+        BYTE els[ 4 ], rsp[ FC_PLOGI_LEN ];
+        U32  rsplen = 4;
+
+        FETCH_F3( d_id, sup->d_id );
+        port = NULL;
+        for (i = 0; i < grp->nports; i++)
+            if (grp->port[i].d_id == d_id)
+                port = &grp->port[i];
+
+        if (!port || req->nseg < 2 || zfcp_copy_data( dev, req, 0, els, 4, FALSE ) < 4)
+        {
+            status = FSF_ELS_COMMAND_REJECTED;
+            break;
+        }
+
+        memset( rsp, 0, sizeof( rsp ));
+        switch (els[0])
+        {
+        case ELS_ADISC:
+            rsp[0] = ELS_LS_ACC;
+            STORE_FW( rsp +  4, port->d_id );
+            STORE_DW( rsp +  8, port->wwpn );
+            STORE_DW( rsp + 16, port->wwnn );
+            STORE_FW( rsp + 24, port->d_id );
+            rsplen = 28;
+            break;
+
+        case ELS_PLOGI:
+            zfcp_build_plogi( rsp, ELS_LS_ACC, port->wwpn, port->wwnn );
+            rsplen = FC_PLOGI_LEN;
+            break;
+
+        default:
+            rsp[0] = ELS_LS_RJT;
+            rsp[5] = 0x0B;                  /* Command not supported */
+            rsplen = 8;
+        }
+
+        if (rsplen > req->seg[1].len)
+            rsplen = req->seg[1].len;
+        zfcp_copy_data( dev, req, req->seg[0].len, rsp, rsplen, TRUE );
+        STORE_FW( sup->resp_buf_length, rsplen );
+        break;
+    }
+
+    default:
+        status = FSF_UNKNOWN_COMMAND;
+    }
+
+    STORE_FW( qtcb->header.fsf_status, status );
+    STORE_FW( qtcb->header.fsf_status_qual[0], qual );
+    STORE_FW( qtcb->prefix.prot_status, FSF_PROT_GOOD );
+}
 
 
 /*-------------------------------------------------------------------*/
-/*   STORCHK  --  check storage access & update ref & change bits    */
+/* Remove the first request from a work or completion queue          */
 /*-------------------------------------------------------------------*/
-/*  Returns 0 if successful or CSW_PROGC or CSW_PROTC if error.      */
-/*  Storage key ref & change bits are only updated if successful.    */
+static ZFCP_REQ* zfcp_dequeue( LIST_ENTRY* head )
+{
+    LIST_ENTRY* link = head->Flink;
+
+    RemoveListEntry( link );
+    return CONTAINING_RECORD( link, ZFCP_REQ, link );
+}
+
+
 /*-------------------------------------------------------------------*/
-BYTE STORCHK
-(
-    U64      addr,              /* Storage address being accessed    */
-    size_t   len,               /* Length of storage being accessed  */
-    BYTE     key,               /* Storage access key                */
-    BYTE     acc,               /* Access type (STORKEY_REF/_CHANGE) */
-    DEVBLK*  dev                /* Pointer to device block           */
-)
+/* FSF request worker thread                                         */
+/*-------------------------------------------------------------------*/
+static void* zfcp_worker_thread( void* arg )
 {
-    /* Validate address limits */
-    if (0
-        || (addr + len) > dev->mainlim   // (outside main storage)
-        || (dev->orb.flag5 & ORB5_A      // (or outside address limits)
-            && ((dev->pmcw.flag5 & PMCW5_LM_LOW  && (addr +  0 ) < sysblk.addrlimval) ||
-                (dev->pmcw.flag5 & PMCW5_LM_HIGH && (addr + len) > sysblk.addrlimval)))
-    )
-        return CSW_PROGC;
+DEVBLK*   dev = (DEVBLK*) arg;
+ZFCP_GRP* grp = (ZFCP_GRP*) dev->group->grp_data;
+ZFCP_REQ* req;
+int       signal;
 
-    /* Validate keyed access */
-    if (key && key != (ARCH_DEP( get_dev_4K_storage_key )( dev, addr ) & STORKEY_KEY) // (key doesn't match)
-        && (0
-            || ARCH_DEP( get_dev_4K_storage_key )( dev, addr ) & STORKEY_FETCH        // (and fetch protected)
-            || acc == STORKEY_CHANGE                                                  // (or trying to update)
-           )
-    )
-        return CSW_PROTC;
+    obtain_lock( &grp->wlock );
 
-    if (STORKEY_CHANGE == acc)
-        ARCH_DEP( or_dev_4K_storage_key )( dev, addr, (STORKEY_REF | STORKEY_CHANGE) );
-    else
-        ARCH_DEP( or_dev_4K_storage_key )( dev, addr, STORKEY_REF );
+    for (;;)
+    {
+        while (!grp->wstop && IsListEmpty( &grp->workq ))
+            wait_condition( &grp->wcond, &grp->wlock );
 
-    return 0;  // (0 == success)
-}
+        if (grp->wstop)
+            break;
 
+        req = zfcp_dequeue( &grp->workq );
+        release_lock( &grp->wlock );
 
-#if defined( ZFCP_DEBUG )
-#define DBGTRC( _dev, ... )                             \
-do {                                                    \
-  if (((ZFCP_GRP*)((_dev)->group->grp_data))->debug)    \
-        TRACE( __VA_ARGS__ );                           \
-} while(0)
-#else
- #define DBGTRC( _dev, ... )
-#endif
+        zfcp_execute_fsf( dev, req );
+
+        obtain_lock( &grp->wlock );
+
+        /* Discard completions for queues that were since halted */
+        if (req->qgen != grp->qgen)
+        {
+            free( req );
+            continue;
+        }
+
+        signal = IsListEmpty( &grp->compq );
+        InsertListTail( &grp->compq, &req->link );
+
+        /* Wake the QDIO thread to post the response */
+        if (signal)
+            VERIFY( 1 == write_pipe( grp->ppfd[1], "R", 1 ));
+    }
+
+    release_lock( &grp->wlock );
+    return NULL;
+}
 
 
-#if defined(_FEATURE_QDIO_THININT)
 /*-------------------------------------------------------------------*/
-/* Set Adapter Local Summary Indicator bits                          */
+/* Start the FSF request worker threads                              */
 /*-------------------------------------------------------------------*/
-static inline void set_alsi(DEVBLK *dev, BYTE bits)
+static void zfcp_start_workers( DEVBLK* dev, int nworkers )
 {
-    if(dev->qdio.alsi)
-    {
-    BYTE *alsi = dev->mainstor + dev->qdio.alsi;
+ZFCP_GRP* grp = (ZFCP_GRP*) dev->group->grp_data;
+char      thread_name[ 32 ];
+int       rc;
 
-        obtain_lock(&sysblk.mainlock);
-        *alsi |= bits;
-        ARCH_DEP( or_dev_4K_storage_key )( dev, dev->qdio.alsi, (STORKEY_REF | STORKEY_CHANGE) );
-        release_lock(&sysblk.mainlock);
+    for (; grp->nworkers < nworkers; grp->nworkers++)
+    {
+        MSGBUF( thread_name, "zfcp worker %1d:%04X", LCSS_DEVNUM );
+        if ((rc = create_thread( &grp->wtid[ grp->nworkers ], JOINABLE,
+                                 zfcp_worker_thread, dev, thread_name )))
+        {
+            // "Error in function create_thread(): %s"
+            WRMSG( HHC00102, "E", strerror( rc ));
+            break;
+        }
     }
 }
 
 
 /*-------------------------------------------------------------------*/
-/* Set Device State Change Indicator bits                            */
+/* Stop the FSF request worker threads and discard queued requests   */
 /*-------------------------------------------------------------------*/
-static inline void set_dsci(DEVBLK *dev, BYTE bits)
+static void zfcp_stop_workers( ZFCP_GRP* grp )
 {
-    if(dev->qdio.dsci)
+int   i;
+void* rc;
+
+    obtain_lock( &grp->wlock );
+    grp->wstop = TRUE;
+    broadcast_condition( &grp->wcond );
+    release_lock( &grp->wlock );
+
+    for (i = 0; i < grp->nworkers; i++)
+        join_thread( grp->wtid[i], &rc );
+    grp->nworkers = 0;
+
+    while (!IsListEmpty( &grp->workq ))
+        free( zfcp_dequeue( &grp->workq ));
+    while (!IsListEmpty( &grp->compq ))
+        free( zfcp_dequeue( &grp->compq ));
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Add an emulated SCSI logical unit backed by a host image file     */
+/*-------------------------------------------------------------------*/
+static int zfcp_add_lun( DEVBLK* dev, char* wwpn, char* lun, char* fname, int rdonly )
+{
+ZFCP_GRP* grp = (ZFCP_GRP*) dev->group->grp_data;
+ZFCP_LUN* disk;
+char      pathname[ MAX_PATH ];
+struct stat st;
+U64       w, l;
+char      c;
+int       i;
+
+    if (sscanf( wwpn, "%"SCNx64"%c", &w, &c ) != 1
+     || sscanf( lun,  "%"SCNx64"%c", &l, &c ) != 1)
     {
-    BYTE *dsci = dev->mainstor + dev->qdio.dsci;
-    BYTE *alsi = dev->mainstor + dev->qdio.alsi;
+        // "%1d:%04X %s: Invalid %s"
+        WRMSG( HHC03852, "E", LCSS_DEVNUM, dev->typname, "WWPN or LUN" );
+        return -1;
+    }
 
-        obtain_lock(&sysblk.mainlock);
-        *dsci |= bits;
-        ARCH_DEP( or_dev_4K_storage_key )( dev, dev->qdio.dsci, (STORKEY_REF | STORKEY_CHANGE) );
-        *alsi |= bits;
-        ARCH_DEP( or_dev_4K_storage_key )( dev, dev->qdio.alsi, (STORKEY_REF | STORKEY_CHANGE) );
-        release_lock(&sysblk.mainlock);
+    /* Register the target port if it is a new one */
+    for (i = 0; i < grp->nports && grp->port[i].wwpn != w; i++);
+    if (i >= grp->nports)
+    {
+        if (grp->nports >= ZFCP_MAX_PORTS)
+        {
+            // "%1d:%04X %s: Too many target ports; WWPN %16.16"PRIX64" ignored"
+            WRMSG( HHC03853, "E", LCSS_DEVNUM, dev->typname, w );
+            return -1;
+        }
+        grp->port[i].wwpn = w;
+        grp->port[i].wwnn = w ^ 0x0100000000000000ULL;
+        grp->port[i].d_id = ZFCP_D_ID_BASE + i;
+        grp->nports++;
+    }
+
+    /* Replace any previous definition of the same LUN */
+    for (disk = grp->luns; disk && !(disk->wwpn == w && disk->lun == l); disk = disk->next);
+    if (!disk)
+    {
+        disk = calloc( 1, sizeof( ZFCP_LUN ));
+        initialize_lock( &disk->lock );
+        disk->wwpn = w;
+        disk->lun  = l;
+        disk->fd   = -1;
+        disk->next = grp->luns;
+        grp->luns  = disk;
+    }
+    else if (disk->fd >= 0)
+        close( disk->fd );
+
+    free( disk->filename );
+    disk->filename = strdup( fname );
+    disk->rdonly   = rdonly;
+    disk->blksize  = grp->blksize;
+
+    hostpath( pathname, fname, sizeof( pathname ));
+    disk->fd = HOPEN( pathname, (rdonly ? O_RDONLY : O_RDWR) | O_BINARY );
+    if (disk->fd < 0 || fstat( disk->fd, &st ) < 0)
+    {
+        // "%1d:%04X %s: Error in function %s for file %s: %s"
+        WRMSG( HHC03851, "E", LCSS_DEVNUM, dev->typname, "open()", fname, strerror( errno ));
+        if (disk->fd >= 0)
+            close( disk->fd );
+        disk->fd    = -1;
+        disk->nblks = 0;
+        return -1;
     }
+
+    disk->nblks = (U64) st.st_size / disk->blksize;
+#if defined( FALLOC_FL_PUNCH_HOLE ) && defined( FALLOC_FL_KEEP_SIZE )
+    disk->unmap = !rdonly;
+#endif
+
+    // "%1d:%04X %s: LUN %16.16"PRIX64" on WWPN %16.16"PRIX64": %s%s, %"PRIu64" blocks of %u bytes"
+    WRMSG( HHC03850, "I", LCSS_DEVNUM, dev->typname, l, w, fname,
+        rdonly ? " (read-only)" : "", disk->nblks, disk->blksize );
+
+    return 0;
 }
-#endif /*defined(_FEATURE_QDIO_THININT)*/
 
 
 /*-------------------------------------------------------------------*/
-/* Raise Adapter Interrupt                                           */
+/* Check that all SBALs of a chained FSF request have been primed    */
 /*-------------------------------------------------------------------*/
-static void raise_adapter_interrupt(DEVBLK *dev)
+static int zfcp_chain_primed( DEVBLK* dev, int oq, int ob )
 {
-    DBGTRC( dev, "Adapter Interrupt dev(%4.4x)\n", dev->devnum );
+QDIO_SLSB *slsb = (QDIO_SLSB*)(dev->mainstor + dev->qdio.o_slsbla[oq]);
+QDIO_SL   *sl   = (QDIO_SL*)  (dev->mainstor + dev->qdio.o_sla[oq]);
+QDIO_SBAL *sbal;
+U64        sa;
+int        n;
 
-    obtain_lock(&dev->lock);
-    dev->pciscsw.flag2 |= SCSW2_Q | SCSW2_FC_START;
-    dev->pciscsw.flag3 |= SCSW3_SC_INTER | SCSW3_SC_PEND;
-    dev->pciscsw.chanstat = CSW_PCI;
-    QUEUE_IO_INTERRUPT(&dev->pciioint,FALSE);
-    release_lock (&dev->lock);
+    for (n = 0; n < ZFCP_MAX_SBALS_PER_REQ; n++, ob = (ob + 1) & 127)
+    {
+        if (slsb->slsbe[ob] != SLSBE_OUTPUT_PRIMED)
+            return FALSE;
 
-    /* Update interrupt status */
-    OBTAIN_INTLOCK( NULL );
-    UPDATE_IC_IOPENDING();
-    RELEASE_INTLOCK( NULL );
+        /* Addressing errors are reported by the caller */
+        FETCH_DW( sa, sl->sbala[ob] );
+        if (STORCHK( sa, sizeof( QDIO_SBAL ) - 1, dev->qdio.o_slk[oq], STORKEY_REF, dev ))
+            return TRUE;
+
+        sbal = (QDIO_SBAL*)(dev->mainstor + sa);
+        if (!(sbal->sbale[0].flags[3] & SBALE_FLAG3_MORE_SBALS))
+            return TRUE;
+    }
+
+    return TRUE;
 }
 
 
@@ -248,6 +1505,10 @@ static void raise_adapter_interrupt(DEVBLK *dev)
 /*-------------------------------------------------------------------*/
 /* Process Input Queue                                               */
 /*-------------------------------------------------------------------*/
+/* Each response queue SBAL is filled with up to 16 request ids of   */
+/* completed FSF requests. The QTCB of each request was updated in   */
+/* place by the worker that executed it.                             */
+/*-------------------------------------------------------------------*/
 static void process_input_queue(DEVBLK *dev)
 {
 ZFCP_GRP *grp = (ZFCP_GRP*)dev->group->grp_data;
@@ -265,19 +1526,22 @@ int mq = dev->qdio.i_qcnt;
             slsb = (QDIO_SLSB*)(dev->mainstor + dev->qdio.i_slsbla[iq]);
 
             while(mb--)
+            {
+                if(IsListEmpty(&grp->compq))
+                    return;
+
                 if(slsb->slsbe[ib] == SLSBE_INPUT_EMPTY)
                 {
                 QDIO_SL *sl = (QDIO_SL*)(dev->mainstor + dev->qdio.i_sla[iq]);
-                U64 sa; U32 len; BYTE *buf;
-                U64 la;
+                U64 sa;
                 QDIO_SBAL *sbal;
-                int tlen = 0;
+                ZFCP_REQ *req;
                 int ns;
 
                     DBGTRC( dev, "Input Queue(%d) Buffer(%d)\n", iq, ib );
 
                     FETCH_DW(sa,sl->sbala[ib]);
-                    if(STORCHK(sa,sizeof(QDIO_SBAL)-1,dev->qdio.i_slk[iq],STORKEY_REF,dev))
+                    if(STORCHK(sa,sizeof(QDIO_SBAL)-1,dev->qdio.i_slk[iq],STORKEY_CHANGE,dev))
                     {
                         slsb->slsbe[ib] = SLSBE_ERROR;
                         ARCH_DEP( or_dev_4K_storage_key )( dev, dev->qdio.i_slsbla[iq], (STORKEY_REF | STORKEY_CHANGE) );
@@ -290,61 +1554,24 @@ int mq = dev->qdio.i_qcnt;
                     }
                     sbal = (QDIO_SBAL*)(dev->mainstor + sa);
 
-                    for(ns = 0; ns < 16; ns++)
+                    /* Post up to 16 request ids into this SBAL */
+                    obtain_lock(&grp->wlock);
+                    for(ns = 0; ns < QMAXSTBK && !IsListEmpty(&grp->compq); ns++)
                     {
-                        FETCH_DW(la,sbal->sbale[ns].addr);
-                        FETCH_FW(len,sbal->sbale[ns].length);
-                        if(!len)
-                            break;  // Or should this be continue - ie a discontiguous sbal???
-                        if(STORCHK(la,len-1,dev->qdio.i_sbalk[iq],STORKEY_CHANGE,dev))
-                        {
-                            slsb->slsbe[ib] = SLSBE_ERROR;
-                            ARCH_DEP( or_dev_4K_storage_key )( dev, dev->qdio.i_slsbla[iq], (STORKEY_REF | STORKEY_CHANGE) );
-#if defined(_FEATURE_QDIO_THININT)
-                            set_alsi(dev,ALSI_ERROR);
-#endif /*defined(_FEATURE_QDIO_THININT)*/
-                            grp->reqpci = TRUE;
-                            DBGTRC( dev, "STORCHK ERROR la(%16.16"PRIx64"), len(%d), key(%2.2x)\n", la, len, dev->qdio.i_sbalk[ iq ]);
-                            return;
-                        }
-                        buf = (BYTE*)(dev->mainstor + la);
-
-#if 0
-                        // ADD CODE TO READ BLOCKS AND SAVE TO THE QUEUES
-#endif
+                        req = zfcp_dequeue( &grp->compq );
+                        memset(&sbal->sbale[ns], 0, sizeof(QDIO_SBALE));
+                        STORE_DW(sbal->sbale[ns].addr, req->req_id);
+                        free(req);
                     }
+                    release_lock(&grp->wlock);
+                    sbal->sbale[ns-1].flags[0] = SBALE_FLAG0_LAST_ENTRY;
 
-                    if(tlen > 0)
-                    {
 #if defined(_FEATURE_QDIO_THININT)
-                        set_dsci(dev,DSCI_IOCOMP);
+                    set_dsci(dev,DSCI_IOCOMP);
 #endif /*defined(_FEATURE_QDIO_THININT)*/
-                        grp->reqpci = TRUE;
-                        slsb->slsbe[ib] = SLSBE_INPUT_COMPLETED;
-                        ARCH_DEP( or_dev_4K_storage_key )( dev, dev->qdio.i_slsbla[iq], (STORKEY_REF | STORKEY_CHANGE) );
-                        if(++ib >= 128)
-                        {
-                            ib = 0;
-                            dev->qdio.i_bpos[iq] = ib;
-                            if(++iq >= dev->qdio.i_qcnt)
-                                iq = 0;
-                            dev->qdio.i_qpos = iq;
-                            mq = dev->qdio.o_qcnt;
-                        }
-                        dev->qdio.i_bpos[iq] = ib;
-                        mb = 128;
-                    }
-                    else
-                    {
-                        if(ns)
-                            sbal->sbale[ns-1].flags[0] = SBALE_FLAG0_LAST_ENTRY;
-                        return;
-                    }
-                    if(ns)
-                        sbal->sbale[ns-1].flags[0] = SBALE_FLAG0_LAST_ENTRY;
-                }
-                else /* Buffer not empty */
-                {
+                    grp->reqpci = TRUE;
+                    slsb->slsbe[ib] = SLSBE_INPUT_COMPLETED;
+                    ARCH_DEP( or_dev_4K_storage_key )( dev, dev->qdio.i_slsbla[iq], (STORKEY_REF | STORKEY_CHANGE) );
                     if(++ib >= 128)
                     {
                         ib = 0;
@@ -352,9 +1579,14 @@ int mq = dev->qdio.i_qcnt;
                         if(++iq >= dev->qdio.i_qcnt)
                             iq = 0;
                         dev->qdio.i_qpos = iq;
+                        mq = dev->qdio.i_qcnt;
                     }
                     dev->qdio.i_bpos[iq] = ib;
+                    mb = 128;
                 }
+                else /* Buffer not empty */
+                    return;
+            }
         }
         else
             if(++iq >= dev->qdio.i_qcnt)
@@ -366,6 +1598,12 @@ int mq = dev->qdio.i_qcnt;
 /*-------------------------------------------------------------------*/
 /* Process Output Queue                                              */
 /*-------------------------------------------------------------------*/
+/* Each request queue SBAL chain carries one FSF request: SBALE 0    */
+/* holds the request id, SBALE 1 the QTCB and the remaining SBALEs   */
+/* (continuing into chained SBALs) describe the data buffers. The    */
+/* SBALs are returned to the program as soon as they have been       */
+/* parsed; the request itself is handed to the worker pool.          */
+/*-------------------------------------------------------------------*/
 static void process_output_queue(DEVBLK *dev)
 {
 ZFCP_GRP *grp = (ZFCP_GRP*)dev->group->grp_data;
@@ -378,16 +1616,20 @@ int mq = dev->qdio.o_qcnt;
         int ob = dev->qdio.o_bpos[oq];
         QDIO_SLSB *slsb;
         int mb = 128;
+        ZFCP_REQ *req = NULL;
+        int maxseg = 0;
+        int nsbal = 0;
             slsb = (QDIO_SLSB*)(dev->mainstor + dev->qdio.o_slsbla[oq]);
 
             while(mb--)
                 if(slsb->slsbe[ob] == SLSBE_OUTPUT_PRIMED)
                 {
                 QDIO_SL *sl = (QDIO_SL*)(dev->mainstor + dev->qdio.o_sla[oq]);
-                U64 sa; U32 len; BYTE *buf;
+                U64 sa; U32 len;
                 U64 la;
                 QDIO_SBAL *sbal;
-                int ns;
+                int ns, first;
+                int more;
 
                     DBGTRC( dev, "Output Queue(%d) Buffer(%d)\n", oq, ob );
 
@@ -401,44 +1643,88 @@ int mq = dev->qdio.o_qcnt;
 #endif /*defined(_FEATURE_QDIO_THININT)*/
                         grp->reqpci = TRUE;
                         DBGTRC( dev, "STORCHK ERROR sa(%16.16"PRIx64"), key(%2.2x)\n", sa, dev->qdio.o_slk[ oq ]);
+                        free(req);
                         return;
                     }
                     sbal = (QDIO_SBAL*)(dev->mainstor + sa);
 
-                    for(ns = 0; ns < 16; ns++)
+                    /* First SBAL of a request: SBALE 0 holds the
+                       request id and SBALE 1 the QTCB (except for
+                       unsolicited status read requests) */
+                    if(!req)
                     {
-                        FETCH_DW(la,sbal->sbale[ns].addr);
-                        FETCH_FW(len,sbal->sbale[ns].length);
-                        if(!len)
-                            break;  // Or should this be continue - ie a discontiguous sbal???
-                        if(STORCHK(la,len-1,dev->qdio.o_sbalk[oq],STORKEY_REF,dev))
-                        {
-                            slsb->slsbe[ob] = SLSBE_ERROR;
-                            ARCH_DEP( or_dev_4K_storage_key )( dev, dev->qdio.o_slsbla[oq], (STORKEY_REF | STORKEY_CHANGE) );
-#if defined(_FEATURE_QDIO_THININT)
-                            set_alsi(dev,ALSI_ERROR);
-#endif /*defined(_FEATURE_QDIO_THININT)*/
-                            grp->reqpci = TRUE;
-                            DBGTRC( dev, "STORCHK ERROR la(%16.16"PRIx64"), len(%d), key(%2.2x)\n", la, len, dev->qdio.o_sbalk[ oq ]);
+                        /* Leave a partially primed chain for later */
+                        if(!zfcp_chain_primed(dev,oq,ob))
                             return;
+
+                        maxseg = ZFCP_MAX_SBALS_PER_REQ * QMAXSTBK;
+                        req = calloc(1, sizeof(ZFCP_REQ) + maxseg * sizeof(ZFCP_SEG));
+                        FETCH_DW(req->req_id,sbal->sbale[0].addr);
+                        req->sbtype = sbal->sbale[0].flags[3] & SBALE_FLAG3_TYPE_MASK;
+                        req->key = dev->qdio.o_sbalk[oq];
+                        req->qgen = grp->qgen;
+                        if(req->sbtype != SBALE_FLAG3_TYPE_STATUS)
+                        {
+                            FETCH_DW(req->qtcb,sbal->sbale[1].addr);
+                            FETCH_FW(len,sbal->sbale[1].length);
+                            if(len < offsetof(FSF_QTCB,log)
+                              || STORCHK(req->qtcb,offsetof(FSF_QTCB,log)-1,dev->qdio.o_sbalk[oq],STORKEY_CHANGE,dev))
+                                req->qtcb = 0;
                         }
-                        buf = (BYTE*)(dev->mainstor + la);
+                        first = 2;
+                    }
+                    else
+                        first = 0;
 
-#if 0
-                        // ADD CODE TO TAKE BLOCKS OF THE QUEUE AND WRITE
-#endif
+                    more = sbal->sbale[0].flags[3] & SBALE_FLAG3_MORE_SBALS;
 
-                        if((sbal->sbale[ns].flags[3] & SBALE_FLAG3_PCI_REQ))
+                    for(ns = first; ns < QMAXSTBK; ns++)
+                    {
+                        FETCH_DW(la,sbal->sbale[ns].addr);
+                        FETCH_FW(len,sbal->sbale[ns].length);
+                        if(len && req->nseg < maxseg)
                         {
+                            req->seg[req->nseg].addr = la;
+                            req->seg[req->nseg].len  = len;
+                            req->nseg++;
+                        }
+                        if(sbal->sbale[ns].flags[0] & SBALE_FLAG0_LAST_ENTRY)
+                            break;
+                    }
+
+                    if((sbal->sbale[0].flags[3] & SBALE_FLAG3_PCI_REQ))
+                    {
 #if defined(_FEATURE_QDIO_THININT)
-                            set_dsci(dev,DSCI_IOCOMP);
+                        set_dsci(dev,DSCI_IOCOMP);
 #endif /*defined(_FEATURE_QDIO_THININT)*/
-                            grp->reqpci = TRUE;
-                        }
+                        grp->reqpci = TRUE;
                     }
 
                     slsb->slsbe[ob] = SLSBE_OUTPUT_COMPLETED;
                     ARCH_DEP( or_dev_4K_storage_key )( dev, dev->qdio.o_slsbla[oq], (STORKEY_REF | STORKEY_CHANGE) );
+
+                    /* Request complete: hand it over to the workers */
+                    if(!more || ++nsbal >= ZFCP_MAX_SBALS_PER_REQ)
+                    {
+                        if(req->sbtype == SBALE_FLAG3_TYPE_STATUS || !req->qtcb)
+                        {
+                            /* Unsolicited status buffers are kept by
+                               the program until an event occurs; we
+                               never report any so just release it */
+                            DBGTRC( dev, "Status read req_id(%16.16"PRIx64")\n", req->req_id );
+                            free(req);
+                        }
+                        else
+                        {
+                            obtain_lock(&grp->wlock);
+                            InsertListTail(&grp->workq, &req->link);
+                            signal_condition(&grp->wcond);
+                            release_lock(&grp->wlock);
+                        }
+                        req = NULL;
+                        nsbal = 0;
+                    }
+
                     if(++ob >= 128)
                     {
                         ob = 0;
@@ -452,12 +1738,20 @@ int mq = dev->qdio.o_qcnt;
                     mb = 128;
                 }
                 else
+                {
+                    /* An incomplete SBAL chain is left for later */
+                    if(req)
+                    {
+                        free(req);
+                        return;
+                    }
                     if(++ob >= 128)
                     {
                         ob = 0;
                         if(++oq >= dev->qdio.o_qcnt)
                             oq = 0;
                     }
+                }
 
         }
         else
@@ -533,6 +1827,7 @@ static int zfcp_init_handler ( DEVBLK *dev, int argc, char *argv[] )
 {
 ZFCP_GRP *grp;
 int grouped;
+int nworkers;
 int i;
 
     LOGMSG( "ZFCP Experimental Driver - Incomplete - Work In Progress\n" );
@@ -569,6 +1864,15 @@ int i;
             grp->rspsz = 0;
 
             /* Set defaults */
+            grp->own_wwpn = 0x5005076400000000ULL | dev->devnum;
+            grp->blksize  = ZFCP_DEF_BLKSIZE;
+            initialize_lock(&grp->wlock);
+            initialize_condition(&grp->wcond);
+            InitializeListHead(&grp->workq);
+            InitializeListHead(&grp->compq);
+            grp->dirserv.wwpn = 0x20FFFC0000000000ULL | ZFCP_D_ID_DIRSERV;
+            grp->dirserv.wwnn = 0x10FFFC0000000000ULL | ZFCP_D_ID_DIRSERV;
+            grp->dirserv.d_id = ZFCP_D_ID_DIRSERV;
         }
         else
             grp = dev->group->grp_data;
@@ -576,14 +1880,52 @@ int i;
     else
         grp = dev->group->grp_data;
 
+    nworkers = grp->nworkers ? grp->nworkers : ZFCP_DEF_WORKERS;
+
     // process all command line options here
     for(i = 0; i < argc; i++)
     {
         if(!strcasecmp("portname",argv[i]) && (i+1) < argc)
         {
+            U64 wwpn;
+            char c;
             if(grp->wwpn)
                 free(grp->wwpn);
             grp->wwpn = strdup(argv[++i]);
+            if(sscanf(grp->wwpn, "%"SCNx64"%c", &wwpn, &c) == 1)
+                grp->own_wwpn = wwpn;
+            else
+                // "%1d:%04X %s: Invalid %s"
+                WRMSG( HHC03852, "E", LCSS_DEVNUM, dev->typname, "portname" );
+            continue;
+        }
+        else if((!strcasecmp("disk",argv[i]) || !strcasecmp("rodisk",argv[i])) && (i+3) < argc)
+        {
+            zfcp_add_lun(dev, argv[i+1], argv[i+2], argv[i+3], !strcasecmp("rodisk",argv[i]));
+            i += 3;
+            continue;
+        }
+        else if(!strcasecmp("blksize",argv[i]) && (i+1) < argc)
+        {
+            int blksize;
+            char c;
+            if(sscanf(argv[++i], "%d%c", &blksize, &c) != 1
+              || blksize < 512 || blksize > 4096 || (blksize & (blksize - 1)))
+                // "%1d:%04X %s: Invalid %s"
+                WRMSG( HHC03852, "E", LCSS_DEVNUM, dev->typname, "blksize" );
+            else
+                grp->blksize = blksize;
+            continue;
+        }
+        else if(!strcasecmp("workers",argv[i]) && (i+1) < argc)
+        {
+            int n;
+            char c;
+            if(sscanf(argv[++i], "%d%c", &n, &c) != 1 || n < 1 || n > ZFCP_MAX_WORKERS)
+                // "%1d:%04X %s: Invalid %s"
+                WRMSG( HHC03852, "E", LCSS_DEVNUM, dev->typname, "workers" );
+            else
+                nworkers = n;
             continue;
         }
         else if(!strcasecmp("lun",argv[i]) && (i+1) < argc)
@@ -636,6 +1978,10 @@ int i;
         for(i = 0; i < ZFCP_GROUP_SIZE; i++)
             dev->group->memdev[i]->fla[0] = dev->group->memdev[0]->devnum;
 
+    /* Start the FSF request workers once the group is complete */
+    if(dev->group->acount == ZFCP_GROUP_SIZE)
+        zfcp_start_workers(dev, nworkers);
+
     return 0;
 } /* end function zfcp_init_handler */
 
@@ -650,10 +1996,26 @@ static void zfcp_query_device (DEVBLK *dev, char **devclass,
 
     BEGIN_DEVICE_CLASS_QUERY( "FCP", dev, devclass, buflen, buffer );
 
-    snprintf( buffer, buflen, "%s%s"
-        , (dev->group->acount == ZFCP_GROUP_SIZE) ? "" : "*Incomplete "
-        , (dev->scsw.flag2 & SCSW2_Q) ? "QDIO" : ""
-        );
+    if (dev->group->acount == ZFCP_GROUP_SIZE)
+    {
+        ZFCP_GRP* grp = (ZFCP_GRP*) dev->group->grp_data;
+        ZFCP_LUN* disk;
+        int       ndisks = 0;
+
+        for (disk = grp->luns; disk; disk = disk->next)
+            ndisks++;
+
+        snprintf( buffer, buflen, "WWPN %16.16"PRIX64" %d port(s) %d LUN(s)%s"
+            , grp->own_wwpn
+            , grp->nports
+            , ndisks
+            , (dev->scsw.flag2 & SCSW2_Q) ? " QDIO" : ""
+            );
+    }
+    else
+        snprintf( buffer, buflen, "*Incomplete%s"
+            , (dev->scsw.flag2 & SCSW2_Q) ? " QDIO" : ""
+            );
 
 } /* end function zfcp_query_device */
 
@@ -667,6 +2029,23 @@ ZFCP_GRP *grp = (ZFCP_GRP*)dev->group->grp_data;
 
     if(!dev->member && dev->group->grp_data)
     {
+    ZFCP_LUN *disk;
+
+        zfcp_stop_workers(grp);
+
+        while((disk = grp->luns))
+        {
+            grp->luns = disk->next;
+            if(disk->fd >= 0)
+                close(disk->fd);
+            free(disk->filename);
+            destroy_lock(&disk->lock);
+            free(disk);
+        }
+
+        destroy_condition(&grp->wcond);
+        destroy_lock(&grp->wlock);
+
         if(grp->ppfd[0])
             close_pipe(grp->ppfd[0]);
         if(grp->ppfd[1])
@@ -1205,28 +2584,35 @@ U32 num;                                /* Number of bytes to move   */
 
         dev->qdio.i_qmask = dev->qdio.o_qmask = 0;
 
+        /* Completions from any previous activation are stale */
+        obtain_lock(&grp->wlock);
+        grp->qgen++;
+        release_lock(&grp->wlock);
+
         FD_ZERO( &readset );
 
         dev->scsw.flag2 |= SCSW2_Q;
 
 
         do {
-            /* Process the Input Queue if data has been received */
-            if(dev->qdio.i_qmask && FD_ISSET(grp->ttfd,&readset))
-            {
-                process_input_queue(dev);
-            }
-
-            /* Process Output Queue if data needs to be sent */
+            /* The pipe is signalled both by SIGA and by the workers
+               when FSF requests have completed; drain it completely */
             if(FD_ISSET(grp->ppfd[0],&readset))
             {
-            char c;
-                VERIFY(1 == read_pipe(grp->ppfd[0],&c,1));
+            char c[64];
+                while(read_pipe(grp->ppfd[0],c,sizeof(c)) > 0);
 
+                /* Hand new requests over to the workers */
                 if(dev->qdio.o_qmask)
                 {
                     process_output_queue(dev);
                 }
+
+                /* Post the responses of completed requests */
+                if(dev->qdio.i_qmask && !IsListEmpty(&grp->compq))
+                {
+                    process_input_queue(dev);
+                }
             }
 
             if(dev->qdio.i_qmask)
@@ -1254,6 +2640,15 @@ U32 num;                                /* Number of bytes to move   */
 #endif
 
 
+        /* Discard requests not yet executed or posted */
+        obtain_lock(&grp->wlock);
+        grp->qgen++;
+        while(!IsListEmpty(&grp->workq))
+            free(zfcp_dequeue(&grp->workq));
+        while(!IsListEmpty(&grp->compq))
+            free(zfcp_dequeue(&grp->compq));
+        release_lock(&grp->wlock);
+
         /* Return unit status */
         *unitstat = CSW_CE | CSW_DE;
     }
@@ -1308,8 +2703,9 @@ int noselrd;
         dev->qdio.i_qmask = qmask;
     }
 
-    /* Send signal to QDIO thread */
-    if(noselrd && dev->qdio.i_qmask)
+    /* Send signal to QDIO thread; responses may be waiting for
+       the input buffers that have just been made available */
+    if((noselrd || !IsListEmpty(&grp->compq)) && dev->qdio.i_qmask)
         VERIFY(1 == write_pipe(grp->ppfd[1],"*",1));
 
     return 0;
@@ -78,6 +78,89 @@
 #define  ZFCP_NQ                NULL_MODEP_NQ
 
 
+/*-------------------------------------------------------------------*/
+/* Emulated FCP target limits and defaults                           */
+/*-------------------------------------------------------------------*/
+#define ZFCP_MAX_PORTS          32      /* Max remote target ports   */
+#define ZFCP_MAX_OPEN_LUNS      256     /* Max concurrently open LUNs*/
+#define ZFCP_DEF_WORKERS        4       /* Default I/O worker threads*/
+#define ZFCP_MAX_WORKERS        64      /* Maximum I/O worker threads*/
+#define ZFCP_DEF_BLKSIZE        512     /* Default SCSI block size   */
+#define ZFCP_MAX_XFER           (1024*1024) /* Max data transfer size*/
+#define ZFCP_MAX_SBALS_PER_REQ  36      /* Max chained SBALs/request */
+
+#define ZFCP_S_ID               0x010000    /* Our own N_Port ID     */
+#define ZFCP_D_ID_BASE          0x010100    /* First target N_Port ID*/
+#define ZFCP_D_ID_DIRSERV       0xFFFFFC    /* Directory server WKA  */
+
+#define ZFCP_PORT_HANDLE_BASE   0x00000100  /* First port handle     */
+#define ZFCP_LUN_HANDLE_BASE    0x00010000  /* First LUN handle      */
+
+
+/*-------------------------------------------------------------------*/
+/* Emulated SCSI logical unit backed by a host image file            */
+/*-------------------------------------------------------------------*/
+typedef struct _ZFCP_LUN {
+    struct _ZFCP_LUN *next;     /* Next LUN on the adapter           */
+    LOCK    lock;               /* Serializes seek/read/write        */
+    U64     wwpn;               /* Target port WWPN                  */
+    U64     lun;                /* FCP LUN (8 byte SAM format)       */
+    char   *filename;           /* Host image file name              */
+    int     fd;                 /* Host image file descriptor        */
+    U64     nblks;              /* Capacity in logical blocks        */
+    U32     blksize;            /* Logical block size                */
+    BYTE    rdonly;             /* LUN is write protected            */
+    BYTE    unmap;              /* Host file supports hole punching  */
+    U64     reads;              /* Read commands executed            */
+    U64     writes;             /* Write commands executed           */
+    } ZFCP_LUN;
+
+
+/*-------------------------------------------------------------------*/
+/* Remote port (emulated storage controller target port)             */
+/*-------------------------------------------------------------------*/
+typedef struct _ZFCP_PORT {
+    U64     wwpn;               /* World Wide Port Name              */
+    U64     wwnn;               /* World Wide Node Name              */
+    U32     d_id;               /* N_Port ID                         */
+    U32     handle;             /* Port handle, 0 when closed        */
+    } ZFCP_PORT;
+
+
+/*-------------------------------------------------------------------*/
+/* Open LUN handle                                                   */
+/*-------------------------------------------------------------------*/
+typedef struct _ZFCP_LUNH {
+    U32       port_handle;      /* Owning port handle, 0 if unused   */
+    U64       lun;              /* FCP LUN                           */
+    ZFCP_LUN *disk;             /* Backing LUN or NULL if none       */
+    } ZFCP_LUNH;
+
+
+/*-------------------------------------------------------------------*/
+/* Data segment of an FSF request (copied from the request SBALs)    */
+/*-------------------------------------------------------------------*/
+typedef struct _ZFCP_SEG {
+    U64     addr;               /* Guest absolute address            */
+    U32     len;                /* Segment length                    */
+    } ZFCP_SEG;
+
+
+/*-------------------------------------------------------------------*/
+/* FSF request queued for execution by the worker pool               */
+/*-------------------------------------------------------------------*/
+typedef struct _ZFCP_REQ {
+    LIST_ENTRY  link;           /* Work / completion queue link      */
+    U64         req_id;         /* Request identifier from SBALE 0   */
+    U64         qtcb;           /* QTCB guest absolute address       */
+    int         qgen;           /* Queue activation generation       */
+    BYTE        key;            /* Storage key for data buffers      */
+    BYTE        sbtype;         /* Storage block type                */
+    int         nseg;           /* Number of data segments           */
+    ZFCP_SEG    seg[FLEXIBLE_ARRAY]; /* Data segments                */
+    } ZFCP_REQ;
+
+
 /*-------------------------------------------------------------------*/
 /* ZFCP Group Structure                                              */
 /*-------------------------------------------------------------------*/
@@ -101,9 +184,361 @@ typedef struct _ZFCP_GRP {
 
     int   debug;                /* Adapter in IFF_DEBUG mode         */
 
+    U64   own_wwpn;             /* Adapter WWPN                      */
+
+    ZFCP_LUN  *luns;            /* Configured logical units          */
+    ZFCP_PORT  port[ ZFCP_MAX_PORTS ];      /* Remote target ports   */
+    int        nports;          /* Number of remote target ports     */
+    ZFCP_PORT  dirserv;         /* Directory (name) server port      */
+    ZFCP_LUNH  lunh[ ZFCP_MAX_OPEN_LUNS ];  /* Open LUN handles      */
+    U32        blksize;         /* Default logical block size        */
+
+    LOCK        wlock;          /* Lock for work/completion queues   */
+    COND        wcond;          /* Work available condition          */
+    LIST_ENTRY  workq;          /* Requests waiting for a worker     */
+    LIST_ENTRY  compq;          /* Completed requests to be posted   */
+    TID         wtid[ ZFCP_MAX_WORKERS ];   /* Worker thread ids     */
+    int         nworkers;       /* Number of worker threads          */
+    int         wstop;          /* Worker threads should terminate   */
+    int         qgen;           /* Queue activation generation       */
+
+    U64   input_reqs;           /* FCP read commands                 */
+    U64   output_reqs;          /* FCP write commands                */
+    U64   control_reqs;         /* FCP commands without data         */
+    U64   input_bytes;          /* Bytes read from images            */
+    U64   output_bytes;         /* Bytes written to images           */
+
     } ZFCP_GRP;
 
 
+/*-------------------------------------------------------------------*/
+/* Storage Block Address List Entry flags used by the FSF protocol   */
+/*-------------------------------------------------------------------*/
+#define SBALE_FLAG3_MORE_SBALS  0x04    /* SBAL chained to next SBAL */
+#define SBALE_FLAG3_TYPE_MASK   0x18    /* Storage block type mask   */
+#define SBALE_FLAG3_TYPE_STATUS 0x00    /* Unsolicited status read   */
+#define SBALE_FLAG3_TYPE_WRITE  0x08    /* Write data                */
+#define SBALE_FLAG3_TYPE_READ   0x10    /* Read data                 */
+#define SBALE_FLAG3_TYPE_WR_RD  0x18    /* Write then read (CT/ELS)  */
+
+
+/*-------------------------------------------------------------------*/
+/* FSF Queue Transfer Control Block (QTCB) Prefix                    */
+/*-------------------------------------------------------------------*/
+typedef struct _FSF_QTCB_PREFIX {
+/*000*/ DBLWRD  req_id;         /* Request identifier                */
+/*008*/ FWORD   qtcb_version;   /* QTCB version                      */
+#define FSF_QTCB_CURRENT_VERSION        0x00000001
+/*00C*/ FWORD   ulp_info;       /* Upper layer protocol info         */
+/*010*/ FWORD   qtcb_type;      /* QTCB type                         */
+#define FSF_IO_COMMAND                  0x00000001
+#define FSF_SUPPORT_COMMAND             0x00000002
+#define FSF_CONFIG_COMMAND              0x00000003
+#define FSF_PORT_COMMAND                0x00000004
+/*014*/ FWORD   req_seq_no;     /* Request sequence number           */
+/*018*/ FWORD   prot_status;    /* Protocol status                   */
+#define FSF_PROT_GOOD                   0x00000001
+#define FSF_PROT_QTCB_VERSION_ERROR     0x00000010
+#define FSF_PROT_SEQ_NUMB_ERROR         0x00000020
+#define FSF_PROT_UNSUPP_QTCB_TYPE       0x00000040
+#define FSF_PROT_HOST_CONNECTION_INITIALIZING 0x00000080
+#define FSF_PROT_FSF_STATUS_PRESENTED   0x00000100
+#define FSF_PROT_DUPLICATE_REQUEST_ID   0x00000200
+#define FSF_PROT_LINK_DOWN              0x00000400
+#define FSF_PROT_REEST_QUEUE            0x00000800
+#define FSF_PROT_ERROR_STATE            0x01000000
+/*01C*/ BYTE    prot_status_qual[16]; /* Protocol status qualifier   */
+/*02C*/ BYTE    resv02c[20];
+    } FSF_QTCB_PREFIX;                                    /* (64)    */
+
+
+/*-------------------------------------------------------------------*/
+/* FSF QTCB Header                                                   */
+/*-------------------------------------------------------------------*/
+typedef struct _FSF_QTCB_HEADER {
+/*000*/ DBLWRD  req_handle;     /* Request handle                    */
+/*008*/ FWORD   fsf_command;    /* FSF command code                  */
+#define FSF_QTCB_FCP_CMND               0x00000001
+#define FSF_QTCB_ABORT_FCP_CMND         0x00000002
+#define FSF_QTCB_OPEN_PORT_WITH_DID     0x00000005
+#define FSF_QTCB_OPEN_LUN               0x00000006
+#define FSF_QTCB_CLOSE_LUN              0x00000007
+#define FSF_QTCB_CLOSE_PORT             0x00000008
+#define FSF_QTCB_CLOSE_PHYSICAL_PORT    0x00000009
+#define FSF_QTCB_SEND_ELS               0x0000000B
+#define FSF_QTCB_SEND_GENERIC           0x0000000C
+#define FSF_QTCB_EXCHANGE_CONFIG_DATA   0x0000000D
+#define FSF_QTCB_EXCHANGE_PORT_DATA     0x0000000E
+#define FSF_QTCB_DOWNLOAD_CONTROL_FILE  0x00000012
+#define FSF_QTCB_UPLOAD_CONTROL_FILE    0x00000013
+/*00C*/ FWORD   resv00c;
+/*010*/ FWORD   port_handle;    /* Port handle                       */
+/*014*/ FWORD   lun_handle;     /* LUN handle                        */
+/*018*/ FWORD   resv018;
+/*01C*/ FWORD   fsf_status;     /* FSF status                        */
+#define FSF_GOOD                        0x00000000
+#define FSF_PORT_ALREADY_OPEN           0x00000001
+#define FSF_LUN_ALREADY_OPEN            0x00000002
+#define FSF_PORT_HANDLE_NOT_VALID       0x00000003
+#define FSF_LUN_HANDLE_NOT_VALID        0x00000004
+#define FSF_FCP_COMMAND_DOES_NOT_EXIST  0x00000022
+#define FSF_DIRECTION_INDICATOR_NOT_VALID 0x00000030
+#define FSF_CMND_LENGTH_NOT_VALID       0x00000033
+#define FSF_MAXIMUM_NUMBER_OF_PORTS_EXCEEDED 0x00000040
+#define FSF_MAXIMUM_NUMBER_OF_LUNS_EXCEEDED  0x00000041
+#define FSF_ELS_COMMAND_REJECTED        0x00000050
+#define FSF_GENERIC_COMMAND_REJECTED    0x00000051
+#define FSF_REQUEST_SIZE_TOO_LARGE      0x00000061
+#define FSF_RESPONSE_SIZE_TOO_LARGE     0x00000062
+#define FSF_SBAL_MISMATCH               0x00000063
+#define FSF_ADAPTER_STATUS_AVAILABLE    0x000000AD
+#define FSF_FCP_RSP_AVAILABLE           0x000000AF
+#define FSF_UNKNOWN_COMMAND             0x000000E2
+#define FSF_UNKNOWN_OP_SUBTYPE          0x000000E3
+#define FSF_INVALID_COMMAND_OPTION      0x000000E5
+/*020*/ FWORD   fsf_status_qual[4]; /* FSF status qualifier          */
+#define FSF_SQ_INVOKE_LINK_TEST_PROCEDURE 0x00000001
+#define FSF_SQ_ULP_DEPENDENT_ERP_REQUIRED 0x00000002
+#define FSF_SQ_NO_RETRY_POSSIBLE        0x00000007
+/*030*/ BYTE    resv030[28];
+/*04C*/ HWORD   log_start;      /* Log area start                    */
+/*04E*/ HWORD   log_length;     /* Log area length                   */
+/*050*/ BYTE    resv050[16];
+    } FSF_QTCB_HEADER;                                    /* (96)    */
+
+
+/*-------------------------------------------------------------------*/
+/* FSF QTCB Bottom for I/O commands                                  */
+/*-------------------------------------------------------------------*/
+typedef struct _FSF_QTCB_BOTTOM_IO {
+/*000*/ FWORD   data_direction; /* Data direction                    */
+#define FSF_DATADIR_WRITE               0x00000001
+#define FSF_DATADIR_READ                0x00000002
+#define FSF_DATADIR_CMND                0x00000004
+/*004*/ FWORD   service_class;  /* FC service class                  */
+/*008*/ BYTE    resv008;
+/*009*/ BYTE    data_prot_flags;/* Data protection flags             */
+/*00A*/ HWORD   app_tag_value;  /* Application tag                   */
+/*00C*/ FWORD   ref_tag_value;  /* Reference tag                     */
+/*010*/ FWORD   fcp_cmnd_length;/* Length of FCP_CMND IU             */
+/*014*/ FWORD   data_block_length; /* Data block length              */
+/*018*/ FWORD   prot_data_length;  /* Protection data length         */
+/*01C*/ FWORD   resv01c;
+/*020*/ BYTE    fcp_cmnd[288];  /* FCP_CMND information unit         */
+/*140*/ BYTE    fcp_rsp[128];   /* FCP_RSP information unit          */
+/*1C0*/ BYTE    resv1c0[64];
+    } FSF_QTCB_BOTTOM_IO;                                 /* (512)   */
+
+
+/*-------------------------------------------------------------------*/
+/* FSF QTCB Bottom for support commands (open/close, ELS, CT)        */
+/*-------------------------------------------------------------------*/
+typedef struct _FSF_QTCB_BOTTOM_SUPPORT {
+/*000*/ FWORD   operation_subtype; /* Operation subtype              */
+/*004*/ BYTE    resv004[13];
+/*011*/ BYTE    d_id[3];        /* Destination N_Port ID             */
+/*014*/ FWORD   option;         /* Command option                    */
+/*018*/ DBLWRD  fcp_lun;        /* FCP LUN                           */
+/*020*/ DBLWRD  resv020;
+/*028*/ DBLWRD  req_handle;     /* Request handle                    */
+/*030*/ FWORD   service_class;  /* FC service class                  */
+/*034*/ BYTE    resv034[3];
+/*037*/ BYTE    timeout;        /* CT/ELS timeout                    */
+/*038*/ FWORD   lun_access_info;/* LUN access information            */
+/*03C*/ FWORD   connection_info;/* Connection information            */
+/*040*/ BYTE    resv040[176];
+/*0F0*/ FWORD   els1_length;    /* ELS payload length                */
+/*0F4*/ FWORD   els2_length;    /* ELS response length               */
+/*0F8*/ FWORD   req_buf_length; /* CT/ELS request buffer length      */
+/*0FC*/ FWORD   resp_buf_length;/* CT/ELS response buffer length     */
+/*100*/ BYTE    els[256];       /* ELS payload (PLOGI parameters)    */
+    } FSF_QTCB_BOTTOM_SUPPORT;                            /* (512)   */
+
+
+/*-------------------------------------------------------------------*/
+/* FSF QTCB Bottom for Exchange Config Data                          */
+/*-------------------------------------------------------------------*/
+typedef struct _FSF_QTCB_BOTTOM_CONFIG {
+/*000*/ FWORD   lic_version;    /* Licensed internal code version    */
+/*004*/ FWORD   feature_selection; /* Requested features             */
+/*008*/ FWORD   high_qtcb_version; /* Highest supported QTCB version */
+/*00C*/ FWORD   low_qtcb_version;  /* Lowest supported QTCB version  */
+/*010*/ FWORD   max_qtcb_size;  /* Maximum QTCB size                 */
+/*014*/ FWORD   max_data_transfer_size; /* Maximum transfer size     */
+/*018*/ FWORD   adapter_features; /* Adapter features                */
+/*01C*/ FWORD   connection_features; /* Connection features          */
+/*020*/ FWORD   fc_topology;    /* Fibre Channel topology            */
+#define FSF_TOPO_P2P                    0x00000001
+#define FSF_TOPO_FABRIC                 0x00000002
+#define FSF_TOPO_AL                     0x00000003
+/*024*/ FWORD   fc_link_speed;  /* Link speed                        */
+#define FSF_PORTSPEED_8GBIT             0x00000010
+/*028*/ FWORD   adapter_type;   /* Adapter type                      */
+/*02C*/ BYTE    resv02c;
+/*02D*/ BYTE    peer_d_id[3];   /* Peer N_Port ID (P2P topology)     */
+/*030*/ BYTE    resv030[2];
+/*032*/ HWORD   timer_interval; /* Statistics timer interval         */
+/*034*/ BYTE    resv034[9];
+/*03D*/ BYTE    s_id[3];        /* Our N_Port ID                     */
+/*040*/ BYTE    nport_serv_param[128]; /* Our FLOGI parameters       */
+/*0C0*/ BYTE    resv0c0[8];
+/*0C8*/ FWORD   adapter_ports;  /* Number of adapter ports           */
+/*0CC*/ FWORD   hardware_version; /* Hardware version                */
+/*0D0*/ BYTE    resv0d0[4];
+/*0D4*/ BYTE    serial_number[32]; /* Adapter serial number          */
+/*0F4*/ BYTE    plogi_payload[112]; /* Peer PLOGI (P2P topology)     */
+/*164*/ BYTE    resv164[156];
+    } FSF_QTCB_BOTTOM_CONFIG;                             /* (512)   */
+
+
+/*-------------------------------------------------------------------*/
+/* FSF QTCB Bottom for Exchange Port Data                            */
+/*-------------------------------------------------------------------*/
+typedef struct _FSF_QTCB_BOTTOM_PORT {
+/*000*/ DBLWRD  wwpn;           /* Adapter WWPN                      */
+/*008*/ FWORD   fc_port_id;     /* Adapter N_Port ID                 */
+/*00C*/ FWORD   port_type;      /* Port type                         */
+/*010*/ FWORD   port_state;     /* Port state                        */
+/*014*/ FWORD   class_of_service; /* Supported classes of service    */
+/*018*/ BYTE    supported_fc4_types[32]; /* Supported FC-4 types     */
+/*038*/ BYTE    active_fc4_types[32];    /* Active FC-4 types        */
+/*058*/ FWORD   supported_speed;/* Supported link speeds             */
+/*05C*/ FWORD   maximum_frame_size; /* Maximum frame size            */
+/*060*/ DBLWRD  seconds_since_last_reset; /* Statistics interval     */
+/*068*/ DBLWRD  resv068[13];
+/*0D0*/ DBLWRD  input_requests; /* FCP read commands                 */
+/*0D8*/ DBLWRD  output_requests;/* FCP write commands                */
+/*0E0*/ DBLWRD  control_requests; /* FCP non-data commands           */
+/*0E8*/ DBLWRD  input_mb;       /* Megabytes read                    */
+/*0F0*/ DBLWRD  output_mb;      /* Megabytes written                 */
+/*0F8*/ BYTE    resv0f8[264];
+    } FSF_QTCB_BOTTOM_PORT;                               /* (512)   */
+
+
+/*-------------------------------------------------------------------*/
+/* FSF Queue Transfer Control Block (QTCB)                           */
+/*-------------------------------------------------------------------*/
+typedef struct _FSF_QTCB {
+/*000*/ FSF_QTCB_PREFIX  prefix;
+/*040*/ FSF_QTCB_HEADER  header;
+/*0A0*/ union {
+            FSF_QTCB_BOTTOM_IO      io;
+            FSF_QTCB_BOTTOM_SUPPORT support;
+            FSF_QTCB_BOTTOM_CONFIG  config;
+            FSF_QTCB_BOTTOM_PORT    port;
+        } bottom;
+/*2A0*/ BYTE    log[1024];      /* Log area                          */
+    } FSF_QTCB;
+
+
+/*-------------------------------------------------------------------*/
+/* FCP_CMND and FCP_RSP Information Units                            */
+/*-------------------------------------------------------------------*/
+typedef struct _FCP_CMND {
+/*000*/ DBLWRD  fc_lun;         /* Logical unit number               */
+/*008*/ BYTE    fc_cmdref;      /* Command reference number          */
+/*009*/ BYTE    fc_pri_ta;      /* Priority and task attribute       */
+/*00A*/ BYTE    fc_tm_flags;    /* Task management flags             */
+/*00B*/ BYTE    fc_flags;       /* Additional length and direction   */
+#define FCP_CFL_WRDATA          0x01
+#define FCP_CFL_RDDATA          0x02
+#define FCP_CFL_LEN_MASK        0xFC
+/*00C*/ BYTE    fc_cdb[16];     /* SCSI command descriptor block     */
+/*01C*/ FWORD   fc_dl;          /* Data length                       */
+    } FCP_CMND;
+
+typedef struct _FCP_RSP {
+/*000*/ BYTE    resv000[8];
+/*008*/ HWORD   fr_retry_delay; /* Retry delay timer                 */
+/*00A*/ BYTE    fr_flags;       /* Response flags                    */
+#define FCP_RSP_LEN_VAL         0x01
+#define FCP_SNS_LEN_VAL         0x02
+#define FCP_RESID_OVER          0x04
+#define FCP_RESID_UNDER         0x08
+/*00B*/ BYTE    fr_status;      /* SCSI status byte                  */
+/*00C*/ FWORD   fr_resid;       /* Residual count                    */
+/*010*/ FWORD   fr_sns_len;     /* Sense data length                 */
+/*014*/ FWORD   fr_rsp_len;     /* Response info length              */
+/*018*/ BYTE    fr_sense[104];  /* Sense data                        */
+    } FCP_RSP;
+
+
+/*-------------------------------------------------------------------*/
+/* FC Common Transport (CT) IU header and Extended Link Services     */
+/*-------------------------------------------------------------------*/
+typedef struct _FC_CT_HDR {
+/*000*/ BYTE    ct_rev;         /* Revision                          */
+/*001*/ BYTE    ct_in_id[3];    /* IN_ID                             */
+/*004*/ BYTE    ct_fs_type;     /* Generic service type              */
+#define FC_FST_DIR              0xFC    /* Directory service         */
+/*005*/ BYTE    ct_fs_subtype;  /* Generic service subtype           */
+#define FC_NS_SUBTYPE           0x02    /* Name server               */
+/*006*/ BYTE    ct_options;     /* Options                           */
+/*007*/ BYTE    resv007;
+/*008*/ HWORD   ct_cmd;         /* Command / response code           */
+#define FC_NS_GID_PN            0x0121  /* Get port id by port name  */
+#define FC_NS_GPN_FT            0x0172  /* Get port names by FC-4    */
+#define FC_FS_RJT               0x8001  /* Reject                    */
+#define FC_FS_ACC               0x8002  /* Accept                    */
+/*00A*/ HWORD   ct_mr_size;     /* Maximum/residual size             */
+/*00C*/ BYTE    resv00c;
+/*00D*/ BYTE    ct_reason;      /* Reject reason code                */
+#define FC_FS_RJT_UNSUP         0x0B    /* Command not supported     */
+/*00E*/ BYTE    ct_explan;      /* Reason code explanation           */
+#define FC_FS_EXP_PID_NOT_REG   0x01    /* Port ID not registered    */
+#define FC_FS_EXP_FC4_NOT_REG   0x07    /* FC-4 types not registered */
+/*00F*/ BYTE    ct_vendor;      /* Vendor unique                     */
+    } FC_CT_HDR;
+
+#define FC_NS_FID_LAST          0x80    /* Last GPN_FT entry flag    */
+#define FC_TYPE_FCP             0x08    /* FC-4 type: SCSI FCP       */
+
+#define ELS_LS_RJT              0x01    /* ELS reject                */
+#define ELS_LS_ACC              0x02    /* ELS accept                */
+#define ELS_PLOGI               0x03    /* Port login                */
+#define ELS_RSCN                0x61    /* Registered state change   */
+#define ELS_ADISC               0x52    /* Discover address          */
+#define ELS_RTV                 0x0E    /* Read timeout value        */
+
+#define FC_PLOGI_LEN            116     /* PLOGI/FLOGI payload length*/
+#define FC_CPC_VALID            0x80    /* Class parameters valid    */
+
+
+/*-------------------------------------------------------------------*/
+/* SCSI command operation codes, status and sense keys               */
+/*-------------------------------------------------------------------*/
+#define SCSI_TEST_UNIT_READY        0x00
+#define SCSI_REQUEST_SENSE          0x03
+#define SCSI_READ_6                 0x08
+#define SCSI_WRITE_6                0x0A
+#define SCSI_INQUIRY                0x12
+#define SCSI_MODE_SENSE_6           0x1A
+#define SCSI_START_STOP_UNIT        0x1B
+#define SCSI_READ_CAPACITY_10       0x25
+#define SCSI_READ_10                0x28
+#define SCSI_WRITE_10               0x2A
+#define SCSI_VERIFY_10              0x2F
+#define SCSI_SYNCHRONIZE_CACHE_10   0x35
+#define SCSI_UNMAP                  0x42
+#define SCSI_MODE_SENSE_10          0x5A
+#define SCSI_READ_16                0x88
+#define SCSI_WRITE_16               0x8A
+#define SCSI_VERIFY_16              0x8F
+#define SCSI_SYNCHRONIZE_CACHE_16   0x91
+#define SCSI_SERVICE_ACTION_IN_16   0x9E
+#define SCSI_REPORT_LUNS            0xA0
+
+#define SCSI_STATUS_GOOD            0x00
+#define SCSI_STATUS_CHECK_CONDITION 0x02
+
+#define SCSI_SENSE_NO_SENSE         0x00
+#define SCSI_SENSE_MEDIUM_ERROR     0x03
+#define SCSI_SENSE_ILLEGAL_REQUEST  0x05
+#define SCSI_SENSE_DATA_PROTECT     0x07
+
+#define SCSI_SENSE_LEN              18  /* Fixed format sense length */
+
+
 /*-------------------------------------------------------------------*/
 /* OSA Layer 2 Header                                                */
 /*-------------------------------------------------------------------*/